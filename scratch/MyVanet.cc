@@ -19,6 +19,7 @@
 #include "ns3/myserver-helper.h"
 #include "ns3/olsr-helper.h"
 #include "ns3/digitalMap.h"
+#include "ns3/node-address-index.h"
 #include "ns3/wimax-module.h"
 #include "ns3/csma-module.h"
 #include "ns3/node-list.h"
@@ -266,11 +267,10 @@ void SendSpecificPacket (int srcID, int sinkID)
 	ltime = Simulator::Now();
 }
 
-//将IPv4地址转换为对应的ID编号
+//将IPv4地址转换为对应的ID编号，使用grp和myserver共同维护的地址索引
 int AddrToID(Ipv4Address addr)
 {
-	int tnum = addr.Get();
-	return tnum / 256 % 256 * 256 + tnum % 256 - 1;
+	return NodeAddressIndex::GetNodeId(addr);
 }
 
 //接收到数据包的处理过程
@@ -357,12 +357,13 @@ StorePacket (Ptr<OutputStreamWrapper> stream, std::string context, const Ipv4Hea
 }
 
 int idx = -1;
-int hops = 0;
-double CarryTimeThreshold = 0;
-double range = -1;
-void ReadConfiguration()
+int hops = 2;
+double CarryTimeThreshold = 20;
+double range = 250;
+//读取旧格式的配置文件(如scratch/conf.txt)，文件中的参数覆盖命令行参数
+void ReadConfiguration(std::string confile)
 {
-    std::ifstream file("scratch/conf.txt");
+    std::ifstream file(confile);
 	std::string line;
     while(!file.eof())
 	{
@@ -419,13 +420,47 @@ void ReadConfiguration()
 
 int main (int argc, char *argv[])
 {
+    //网络实验参数通过命令行传入，每次运行的随机数由--RngRun决定，
+    //utils/vanet-sweep.py据此并行运行参数网格中的多次独立重复实验
+    nNodes = 100;
+    DistanceRange = 2000;
+    std::string confile = "";
+    std::string output = "scratch/data.csv";
+    std::string traceFile = "scratch/grp-trace.tr";
+    std::string animFile = "scratch/myvanet.xml";
+    bool enableAnim = true;
+    bool animCompress = false;
+    double animMoveThreshold = 0;
+    uint32_t animPacketSampling = 1;
+
 	CommandLine cmd;
+    cmd.AddValue ("vnum", "Number of vehicles", nNodes);
+    cmd.AddValue ("range", "Transmission range (m), 250 or 500", range);
+    cmd.AddValue ("seghop", "Segment hops", hops);
+    cmd.AddValue ("CarryTimeThreshold", "Longest carry time of a data packet (s)", CarryTimeThreshold);
+    cmd.AddValue ("DistanceRange", "Largest distance between the sources and the sink (m)", DistanceRange);
+    cmd.AddValue ("conf", "Read the parameters from this configuration file instead", confile);
+    cmd.AddValue ("output", "Append the results to this CSV file", output);
+    cmd.AddValue ("traceFile", "Store and drop trace file", traceFile);
+    cmd.AddValue ("animFile", "NetAnim trace file", animFile);
+    cmd.AddValue ("anim", "Write the NetAnim trace file", enableAnim);
+    cmd.AddValue ("animCompress", "Compress the NetAnim trace file with gzip", animCompress);
+    cmd.AddValue ("animMoveThreshold", "Distance (m) a vehicle moves before its position is written again to the NetAnim trace file", animMoveThreshold);
+    cmd.AddValue ("animPacketSampling", "Write one packet out of this number to the NetAnim trace file", animPacketSampling);
 	cmd.Parse (argc, argv);
 
-    //从配置文件中读取网络实验参数
-    ReadConfiguration();
+    if(confile.empty() == false)
+    {
+        ReadConfiguration(confile);
+        if(idx >= 0)
+            RngSeedManager::SetRun(idx);
+    }
     //配置随机参数种子
-    srand((unsigned int)(idx*10));
+    srand((unsigned int)(RngSeedManager::GetRun()*10));
+
+    Config::SetDefault ("ns3::grp::RoutingProtocol::VehicleNumber", IntegerValue (nNodes));
+    Config::SetDefault ("ns3::grp::RoutingProtocol::TransmissionRange", DoubleValue (range));
+    Config::SetDefault ("ns3::grp::RoutingProtocol::CarryTimeThreshold", DoubleValue (CarryTimeThreshold));
 	
 /* ------------------------------------ 节点配置，包括：物理层、MAC层、网络层、运输层和应用层-----------------------------*/
 
@@ -540,12 +575,19 @@ int main (int argc, char *argv[])
 
     //记录网络运行数据到tr文件并实时打印在屏幕上
     AsciiTraceHelper ascii;
-    Ptr<OutputStreamWrapper> stream = ascii.CreateFileStream ("scratch/grp-trace.tr");
+    Ptr<OutputStreamWrapper> stream = ascii.CreateFileStream (traceFile);
     Config::Connect("/NodeList/*/$ns3::grp::RoutingProtocol/DropPacket", MakeBoundCallback(&DropPacket, stream));
     Config::Connect("/NodeList/*/$ns3::grp::RoutingProtocol/StorePacket", MakeBoundCallback(&StorePacket, stream));
 
     // 记录网络运行数据，可以使用NetAnim查看这些数据 
-    AnimationInterface anim ("scratch/myvanet.xml");
+    AnimationInterface *anim = 0;
+    if(enableAnim)
+    {
+        anim = new AnimationInterface (animFile);
+        anim->EnableCompression (animCompress);
+        anim->SetMobilityUpdateThreshold (animMoveThreshold);
+        anim->SetPacketSamplingInterval (animPacketSampling);
+    }
 
 /* ----------------------------------------------仿真的启动与关闭---------------------------------------------------*/
     NS_LOG_UNCOND("Simulation start");
@@ -554,6 +596,7 @@ int main (int argc, char *argv[])
     Simulator::Stop(Seconds (SimulationStopTime));
     Simulator::Run ();
     Simulator::Destroy ();
+    delete anim;
 
 /* ------------------------------------仿真结束后统计和打印网络运行数据--------------------------------------------*/
 
@@ -573,7 +616,7 @@ int main (int argc, char *argv[])
     NS_LOG_UNCOND("Store Error: " << lc - DropCount);
 
     //将统计数据输出到文件中
-    std::ofstream fout("scratch/data.csv", std::ios::app);
+    std::ofstream fout(output, std::ios::app);
 	fout << nNodes << "," << DistanceRange << "," << hops << "," << CarryTimeThreshold << ",";
     fout << (recount * 1.0 / SendCount) << "," << (double)allTime/recount/1000000;
 
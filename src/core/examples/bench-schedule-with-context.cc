@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ptr.h"
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-examples
+ * \ingroup scheduler
+ * Benchmark of the injection of events from other threads.
+ *
+ * 1 to 16 producer threads schedule events with
+ * Simulator::ScheduleWithContext while the main thread runs the
+ * simulation and executes them.  The throughput is the number of events
+ * injected and executed per second of wall clock time.  The order of the
+ * events of each producer is checked on the way.
+ *
+ * See \ref ns3::SimulatorImpl::ScheduleWithContext
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** Number of events executed in the current run. */
+uint64_t g_received = 0;
+/** Number of events to execute in the current run. */
+uint64_t g_total = 0;
+/** Next sequence number expected from each producer. */
+std::vector<uint32_t> g_expected;
+/** Number of events received out of order. */
+uint64_t g_outOfOrder = 0;
+
+/**
+ * An event injected by a producer.
+ * \param producer the index of the producer
+ * \param seq the sequence number of the event for this producer
+ */
+void
+Receive (uint32_t producer, uint32_t seq)
+{
+  if (seq != g_expected[producer])
+    {
+      g_outOfOrder++;
+    }
+  g_expected[producer] = seq + 1;
+  g_received++;
+}
+
+/**
+ * Keep the simulation alive until all the events are received.
+ */
+void
+Poll (void)
+{
+  if (g_received < g_total)
+    {
+      Simulator::Schedule (TimeStep (1), &Poll);
+    }
+}
+
+/**
+ * Body of a producer thread.
+ * \param producer the index of the producer
+ * \param nEvents the number of events to inject
+ */
+void
+Produce (uint32_t producer, uint32_t nEvents)
+{
+  for (uint32_t seq = 0; seq < nEvents; seq++)
+    {
+      Simulator::ScheduleWithContext (producer, TimeStep (0), &Receive, producer, seq);
+    }
+}
+
+/**
+ * Run the benchmark with some producers.
+ * \param nThreads the number of producer threads
+ * \param nEvents the number of events injected by each producer
+ */
+void
+Bench (uint32_t nThreads, uint32_t nEvents)
+{
+  g_received = 0;
+  g_total = (uint64_t) nThreads * nEvents;
+  g_expected.assign (nThreads, 0);
+  g_outOfOrder = 0;
+
+  Simulator::Schedule (TimeStep (0), &Poll);
+  SystemWallClockMs clock;
+  clock.Start ();
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&Produce, i, nEvents)));
+      threads.back ()->Start ();
+    }
+  Simulator::Run ();
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads[i]->Join ();
+    }
+  int64_t ms = clock.End ();
+  Simulator::Destroy ();
+
+  std::cout << std::setw (8) << nThreads
+            << std::setw (12) << g_total
+            << std::setw (10) << ms
+            << std::setw (14) << (ms > 0 ? g_total * 1000 / ms : 0)
+            << std::setw (12) << g_outOfOrder
+            << std::endl;
+}
+
+}  // unnamed namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nEvents = 200000;
+  uint32_t maxThreads = 16;
+
+  CommandLine cmd;
+  cmd.AddValue ("events", "Number of events injected by each producer", nEvents);
+  cmd.AddValue ("maxThreads", "Largest number of producer threads", maxThreads);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (8) << "threads"
+            << std::setw (12) << "events"
+            << std::setw (10) << "ms"
+            << std::setw (14) << "events/s"
+            << std::setw (12) << "misordered"
+            << std::endl;
+  for (uint32_t nThreads = 1; nThreads <= maxThreads; nThreads *= 2)
+    {
+      Bench (nThreads, nEvents);
+    }
+  return 0;
+}
@@ -25,10 +25,13 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "double.h"
+#include "string.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <fstream>
 
 
 /**
@@ -53,6 +56,21 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("CancelledCompaction",
+                   "Fraction of the pending events cancelled from which "
+                   "they are removed from the scheduler, 0 to leave them "
+                   "until their time.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&DefaultSimulatorImpl::m_cancelledCompaction),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("EventProfile",
+                   "The file where the time spent in each type of event "
+                   "is written at Simulator::Destroy, with the folded "
+                   "stacks in the same file with a .folded extension; "
+                   "empty not to profile the events.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetEventProfile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -72,13 +90,32 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventsWithContext.store (0);
+  m_cancelledCompaction = 0;
+  m_profiler = 0;
   m_main = SystemThread::Self();
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
+}
+
+void
+DefaultSimulatorImpl::SetEventProfile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_eventProfile = filename;
+  if (filename == "")
+    {
+      delete m_profiler;
+      m_profiler = 0;
+    }
+  else if (m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
 }
 
 void
@@ -87,6 +124,12 @@ DefaultSimulatorImpl::DoDispose (void)
   NS_LOG_FUNCTION (this);
   ProcessEventsWithContext ();
 
+  for (std::vector<Scheduler::Event>::iterator i = m_cancelledEvents.begin ();
+       i != m_cancelledEvents.end (); i++)
+    {
+      i->impl->Unref ();
+    }
+  m_cancelledEvents.clear ();
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -109,6 +152,18 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      std::ofstream report (m_eventProfile.c_str ());
+      m_profiler->Print (report);
+      std::string folded = m_eventProfile + ".folded";
+      std::ofstream stacks (folded.c_str ());
+      m_profiler->PrintFolded (stacks);
+      if (!report || !stacks)
+        {
+          NS_LOG_WARN ("Could not write the event profile " << m_eventProfile);
+        }
+    }
 }
 
 void
@@ -148,7 +203,14 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      m_profiler->Invoke (next.impl, next.key.m_context);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -163,30 +225,34 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.load (std::memory_order_relaxed) == 0)
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  // take all the events, most recent first
+  EventWithContext *event = m_eventsWithContext.exchange (0, std::memory_order_acquire);
+  EventWithContext *eventsWithContext = 0;
+  while (event != 0)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
+      EventWithContext *next = event->next;
+      event->next = eventsWithContext;
+      eventsWithContext = event;
+      event = next;
+    }
+  while (eventsWithContext != 0)
+    {
+       event = eventsWithContext;
+       eventsWithContext = event->next;
        Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
+       ev.impl = event->event;
+       ev.key.m_ts = m_currentTs + event->timestamp;
+       ev.key.m_context = event->context;
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
        m_events->Insert (ev);
+       delete event;
     }
 }
 
@@ -265,16 +331,18 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
+      EventWithContext *ev = new EventWithContext;
+      ev->context = context;
       // Current time added in ProcessEventsWithContext()
-      ev.timestamp = delay.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      ev->timestamp = delay.GetTimeStep ();
+      ev->event = event;
+      ev->next = m_eventsWithContext.load (std::memory_order_relaxed);
+      while (!m_eventsWithContext.compare_exchange_weak (ev->next, ev,
+                                                         std::memory_order_release,
+                                                         std::memory_order_relaxed))
+        {
+          // ev->next was updated to the current head, try again
+        }
     }
 }
 
@@ -361,10 +429,50 @@ DefaultSimulatorImpl::Remove (const EventId &id)
 void
 DefaultSimulatorImpl::Cancel (const EventId &id)
 {
-  if (!IsExpired (id))
+  if (IsExpired (id))
+    {
+      return;
+    }
+  id.PeekEventImpl ()->Cancel ();
+  if (m_cancelledCompaction <= 0 || id.GetUid () == 2)
     {
-      id.PeekEventImpl ()->Cancel ();
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  event.impl->Ref ();
+  m_cancelledEvents.push_back (event);
+  // some of the events recorded may have been dropped since, so that
+  // this is an upper bound of the cancelled events pending
+  if (m_cancelledEvents.size () >= 64
+      && m_cancelledEvents.size () >= m_cancelledCompaction * m_unscheduledEvents)
+    {
+      RemoveCancelledEvents ();
+    }
+}
+
+void
+DefaultSimulatorImpl::RemoveCancelledEvents (void)
+{
+  NS_LOG_FUNCTION (this << m_cancelledEvents.size ());
+  for (std::vector<Scheduler::Event>::iterator i = m_cancelledEvents.begin ();
+       i != m_cancelledEvents.end (); i++)
+    {
+      // skip the events already dropped by ProcessOneEvent
+      if (i->key.m_ts > m_currentTs
+          || (i->key.m_ts == m_currentTs && i->key.m_uid > m_currentUid))
+        {
+          m_events->Remove (*i);
+          // the reference of the scheduler
+          i->impl->Unref ();
+          m_unscheduledEvents--;
+        }
+      i->impl->Unref ();
     }
+  m_cancelledEvents.clear ();
 }
 
 bool
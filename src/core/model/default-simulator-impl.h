@@ -24,12 +24,15 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "system-thread.h"
-#include "system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
+#include <vector>
+#include <atomic>
 
 /**
  * \file
@@ -43,6 +46,16 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * A cancelled event normally stays in the scheduler until its time
+ * comes, and is then dropped.  When the CancelledCompaction attribute is
+ * set, the cancelled events are recorded, and removed from the scheduler
+ * at once when they reach that fraction of the pending events, so that
+ * the scheduler holds mostly live events.  They are then neither counted
+ * by GetEventCount() nor advance the time when the simulation ends.
+ *
+ * When the EventProfile attribute names a file, the events are invoked
+ * through an EventProfiler, whose report is written at Destroy().
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -86,6 +99,13 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /** Remove the cancelled events still pending from the scheduler. */
+  void RemoveCancelledEvents (void);
+  /**
+   * Profile the events, or stop.
+   * \param [in] filename The file of the report, empty to stop profiling.
+   */
+  void SetEventProfile (std::string filename);
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -95,18 +115,18 @@ private:
     uint64_t timestamp;
     /** The event implementation. */
     EventImpl *event;
+    /** The event with context scheduled before this one. */
+    EventWithContext *next;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events from a different context, most recent first.
+   *
+   * This is a lock-free stack: any thread pushes an event with a
+   * compare-and-swap of the head, and the main thread takes all the
+   * events at once by exchanging the head with a null pointer, then
+   * reverses them to insert them in the order they were scheduled.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  std::atomic<EventWithContext *> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -133,6 +153,19 @@ private:
    */
   int m_unscheduledEvents;
 
+  /**
+   * Fraction of the pending events cancelled from which they are removed
+   * from the scheduler, 0 to never remove them.
+   */
+  double m_cancelledCompaction;
+  /** The events cancelled since the last compaction, with a reference. */
+  std::vector<Scheduler::Event> m_cancelledEvents;
+
+  /** The file of the event profile, empty if not profiling. */
+  std::string m_eventProfile;
+  /** The event profiler, if profiling. */
+  EventProfiler *m_profiler;
+
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
 };
@@ -20,6 +20,7 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <new>
 
 /**
  * \file
@@ -31,13 +32,126 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the size classes of the pool, and alignment of the events. */
+const std::size_t POOL_GRANULARITY = 16;
+/** Number of size classes; larger events are allocated with new. */
+const std::size_t POOL_CLASSES = 16;
+/** Size of the chunks carved into events. */
+const std::size_t POOL_CHUNK_SIZE = 64 * 1024;
+
+/** A released event, in a free list. */
+struct FreeBlock
+{
+  FreeBlock *next;  //!< next released event of the same size class
+};
+
+/**
+ * The pool of a thread.
+ *
+ * It is a POD, zero-initialized, so that accessing the thread-local
+ * instance needs no initialization guard.
+ */
+struct EventImplPool
+{
+  FreeBlock *freeLists[POOL_CLASSES];  //!< released events, by size class
+  FreeBlock *chunks;                   //!< chunks allocated, kept reachable
+  EventImpl::PoolStats stats;          //!< allocation statistics
+};
+
+/** The pool of the current thread. */
+thread_local EventImplPool g_eventImplPool;
+
+/**
+ * Refill a free list with a new chunk.
+ * \param pool the pool
+ * \param sizeClass the size class of the free list
+ */
+void
+RefillEventImplPool (EventImplPool &pool, std::size_t sizeClass)
+{
+  std::size_t blockSize = (sizeClass + 1) * POOL_GRANULARITY;
+  char *chunk = static_cast<char *> (::operator new (POOL_CHUNK_SIZE));
+  // the first block links the chunks of the thread
+  FreeBlock *header = reinterpret_cast<FreeBlock *> (chunk);
+  header->next = pool.chunks;
+  pool.chunks = header;
+  // the blocks are linked so that they are allocated in address order
+  FreeBlock *head = pool.freeLists[sizeClass];
+  std::size_t nBlocks = (POOL_CHUNK_SIZE - POOL_GRANULARITY) / blockSize;
+  for (std::size_t i = nBlocks; i > 0; i--)
+    {
+      FreeBlock *block = reinterpret_cast<FreeBlock *> (chunk + POOL_GRANULARITY + (i - 1) * blockSize);
+      block->next = head;
+      head = block;
+    }
+  pool.freeLists[sizeClass] = head;
+  pool.stats.chunks++;
+  pool.stats.chunkBytes += POOL_CHUNK_SIZE;
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  EventImplPool &pool = g_eventImplPool;
+  pool.stats.allocations++;
+  std::size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (sizeClass >= POOL_CLASSES)
+    {
+      pool.stats.large++;
+      return ::operator new (size);
+    }
+  FreeBlock *block = pool.freeLists[sizeClass];
+  if (block == 0)
+    {
+      RefillEventImplPool (pool, sizeClass);
+      block = pool.freeLists[sizeClass];
+    }
+  else
+    {
+      pool.stats.reuses++;
+    }
+  pool.freeLists[sizeClass] = block->next;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  EventImplPool &pool = g_eventImplPool;
+  pool.stats.releases++;
+  std::size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (sizeClass >= POOL_CLASSES)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = pool.freeLists[sizeClass];
+  pool.freeLists[sizeClass] = block;
+}
+
+EventImpl::PoolStats
+EventImpl::GetPoolStats (void)
+{
+  return g_eventImplPool.stats;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_schedulerHandle (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,10 +41,47 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The events are allocated from a pool with one free list per size
+ * class, which avoids a call to malloc and free per event.  The free
+ * lists are thread-local, so that the events created by the realtime and
+ * distributed simulators, or by the threads scheduling events with
+ * context, need no lock: an event goes to the free list of the thread
+ * which releases it.  The memory of the pool is never returned to the
+ * system, and the blocks still in the free lists of a thread when it
+ * exits are lost.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
 public:
+  /** Allocation statistics of the pool of a thread. */
+  struct PoolStats
+  {
+    uint64_t allocations;   //!< number of events allocated
+    uint64_t reuses;        //!< number of events allocated from a free list
+    uint64_t releases;      //!< number of events released
+    uint64_t chunks;        //!< number of chunks allocated to refill the free lists
+    uint64_t chunkBytes;    //!< total size of these chunks
+    uint64_t large;         //!< number of events too large for the pool, allocated with new
+  };
+
+  /**
+   * Allocate an event from the pool of the calling thread.
+   * \param size the size of the event
+   * \returns the memory of the event
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release an event to the pool of the calling thread.
+   * \param p the memory of the event
+   * \param size the size of the event
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * \returns the allocation statistics of the pool of the calling thread
+   */
+  static PoolStats GetPoolStats (void);
+
   /** Default constructor. */
   EventImpl ();
   /** Destructor. */
@@ -65,6 +103,16 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Record where the scheduler holding the event keeps it, like its
+   * index in a heap, to find it again without a search.
+   * \param handle the position of the event in the scheduler
+   */
+  void SetSchedulerHandle (uint32_t handle);
+  /**
+   * \returns the handle set by the scheduler holding the event
+   */
+  uint32_t GetSchedulerHandle (void) const;
 
 protected:
   /**
@@ -77,8 +125,29 @@ protected:
 
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
+  uint32_t m_schedulerHandle;  /**< Position in the scheduler. */
 };
 
 } // namespace ns3
 
+/********************************************************************
+ *  Implementation of the inline methods.
+ ********************************************************************/
+
+namespace ns3 {
+
+inline void
+EventImpl::SetSchedulerHandle (uint32_t handle)
+{
+  m_schedulerHandle = handle;
+}
+
+inline uint32_t
+EventImpl::GetSchedulerHandle (void) const
+{
+  return m_schedulerHandle;
+}
+
+} // namespace ns3
+
 #endif /* EVENT_IMPL_H */
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "simulator.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/** A line of the report: a name, its time and its number of events. */
+struct ReportLine
+{
+  std::string name;     //!< the type or the context
+  int64_t ns;           //!< the total time, in nanoseconds
+  uint64_t count;       //!< the number of events
+};
+
+/**
+ * Order the lines by decreasing time.
+ * \param [in] a A line.
+ * \param [in] b Another line.
+ * \returns \c true if \p a took more time than \p b.
+ */
+bool
+MoreTime (const ReportLine &a, const ReportLine &b)
+{
+  return a.ns > b.ns;
+}
+
+/**
+ * Add a line to a report, or add to the line with the same name.
+ * \param [in,out] lines The lines, by name.
+ * \param [in] name The name.
+ * \param [in] ns The time, in nanoseconds.
+ * \param [in] count The number of events.
+ */
+void
+AddLine (std::map<std::string, ReportLine> &lines, const std::string &name,
+         int64_t ns, uint64_t count)
+{
+  ReportLine &line = lines[name];
+  line.name = name;
+  line.ns += ns;
+  line.count += count;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler ()
+  : m_count (0),
+    m_ns (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::Invoke (EventImpl *event, uint32_t context)
+{
+  if (event->IsCancelled ())
+    {
+      return;
+    }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  event->Invoke ();
+  int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now () - start).count ();
+
+  Key key (std::type_index (typeid (*event)), context);
+  Entries::iterator i = m_entries.find (key);
+  if (i == m_entries.end ())
+    {
+      Entry entry = { 0, 0 };
+      i = m_entries.insert (std::make_pair (key, entry)).first;
+    }
+  i->second.count++;
+  i->second.ns += ns;
+  m_count++;
+  m_ns += ns;
+}
+
+std::string
+EventProfiler::GetName (std::type_index type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // the events of MakeEvent are local classes of the function, whose
+  // first parameter is the function or member function bound
+  std::string::size_type start = name.find ("MakeEvent");
+  if (start == std::string::npos)
+    {
+      return name;
+    }
+  // skip the template arguments, if any
+  std::string::size_type i = start + 9;
+  int depth = 0;
+  while (i < name.size () && (depth > 0 || name[i] == '<'))
+    {
+      if (name[i] == '<')
+        {
+          depth++;
+        }
+      else if (name[i] == '>')
+        {
+          depth--;
+        }
+      i++;
+    }
+  if (i == name.size () || name[i] != '(')
+    {
+      return name;
+    }
+  start = i + 1;
+  for (i = start; i < name.size (); i++)
+    {
+      char c = name[i];
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if ((c == '>' || c == ')') && depth > 0)
+        {
+          depth--;
+        }
+      else if ((c == ',' || c == ')') && depth == 0)
+        {
+          return name.substr (start, i - start);
+        }
+    }
+  return name;
+}
+
+std::string
+EventProfiler::GetContextName (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return "no context";
+    }
+  std::ostringstream oss;
+  oss << "context " << context;
+  return oss.str ();
+}
+
+void
+EventProfiler::Print (std::ostream &os) const
+{
+  std::map<std::string, ReportLine> types;
+  std::map<std::string, ReportLine> contexts;
+  for (Entries::const_iterator i = m_entries.begin (); i != m_entries.end (); i++)
+    {
+      AddLine (types, GetName (i->first.first), i->second.ns, i->second.count);
+      AddLine (contexts, GetContextName (i->first.second), i->second.ns, i->second.count);
+    }
+
+  os << "# " << m_count << " events, " << m_ns / 1e9 << " s" << std::endl;
+  const std::map<std::string, ReportLine> *reports[] = { &types, &contexts };
+  const char *titles[] = { "event type", "context" };
+  for (uint32_t r = 0; r < 2; r++)
+    {
+      std::vector<ReportLine> lines;
+      for (std::map<std::string, ReportLine>::const_iterator i = reports[r]->begin ();
+           i != reports[r]->end (); i++)
+        {
+          lines.push_back (i->second);
+        }
+      std::stable_sort (lines.begin (), lines.end (), MoreTime);
+
+      os << std::endl
+         << std::setw (12) << "time (s)"
+         << std::setw (8) << "%"
+         << std::setw (12) << "events"
+         << std::setw (12) << "mean (us)"
+         << "  " << titles[r] << std::endl;
+      for (std::vector<ReportLine>::const_iterator i = lines.begin (); i != lines.end (); i++)
+        {
+          os << std::fixed
+             << std::setw (12) << std::setprecision (6) << i->ns / 1e9
+             << std::setw (8) << std::setprecision (2) << (m_ns > 0 ? 100.0 * i->ns / m_ns : 0)
+             << std::setw (12) << i->count
+             << std::setw (12) << std::setprecision (3) << i->ns / 1e3 / i->count
+             << "  " << i->name << std::endl;
+        }
+      os.unsetf (std::ios::floatfield);
+    }
+}
+
+void
+EventProfiler::PrintFolded (std::ostream &os) const
+{
+  std::map<std::string, ReportLine> stacks;
+  for (Entries::const_iterator i = m_entries.begin (); i != m_entries.end (); i++)
+    {
+      std::string name = GetContextName (i->first.second) + ";" + GetName (i->first.first);
+      AddLine (stacks, name, i->second.ns, i->second.count);
+    }
+  for (std::map<std::string, ReportLine>::const_iterator i = stacks.begin (); i != stacks.end (); i++)
+    {
+      os << i->first << " " << (i->second.ns + 500) / 1000 << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <utility>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Wall clock time spent in each type of event.
+ *
+ * The simulator invokes the events through the profiler, which
+ * attributes the time and the number of the events to the type of the
+ * event and to its context, normally the node id.  The type of the
+ * event is the type of the function or member function bound by
+ * MakeEvent(), like <tt>void (ns3::WifiMac::*)(ns3::Ptr<ns3::Packet>)</tt>:
+ * the name of the function itself is not known at run time.
+ *
+ * The report lists the types by decreasing time, then the contexts.
+ * The folded stacks, one line <tt>context;type microseconds</tt> per
+ * pair, are the input of flame graph tools like flamegraph.pl.
+ *
+ * DefaultSimulatorImpl creates a profiler when its EventProfile
+ * attribute names a file, and writes the report there, and the folded
+ * stacks in the same file with a \c .folded extension, at
+ * Simulator::Destroy().
+ */
+class EventProfiler
+{
+public:
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Invoke an event and record the time it took.
+   *
+   * Cancelled events are not recorded.
+   *
+   * \param [in] event The event.
+   * \param [in] context The context of the event.
+   */
+  void Invoke (EventImpl *event, uint32_t context);
+
+  /**
+   * Write the report.
+   * \param [in,out] os The output stream.
+   */
+  void Print (std::ostream &os) const;
+  /**
+   * Write the folded stacks.
+   * \param [in,out] os The output stream.
+   */
+  void PrintFolded (std::ostream &os) const;
+
+private:
+  /** The time and the number of some events. */
+  struct Entry
+  {
+    uint64_t count;     //!< the number of events
+    int64_t ns;         //!< the total time, in nanoseconds
+  };
+  /** The events of a type in a context. */
+  typedef std::pair<std::type_index, uint32_t> Key;
+  /** The entries of each type in each context. */
+  typedef std::map<Key, Entry> Entries;
+
+  /**
+   * \param [in] type The type of an event.
+   * \returns The name of the function bound by the event.
+   */
+  static std::string GetName (std::type_index type);
+  /**
+   * \param [in] context A context.
+   * \returns The printable form of \p context.
+   */
+  static std::string GetContextName (uint32_t context);
+
+  Entries m_entries;    //!< the entries
+  uint64_t m_count;     //!< the number of events recorded
+  int64_t m_ns;         //!< the time of the events recorded, in nanoseconds
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
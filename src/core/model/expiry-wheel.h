@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef EXPIRY_WHEEL_H
+#define EXPIRY_WHEEL_H
+
+#include "nstime.h"
+#include "event-id.h"
+#include "simulator.h"
+#include "callback.h"
+#include "assert.h"
+#include <stdint.h>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::ExpiryWheel declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup timer
+ * \brief A hashed timer wheel tracking the expiry time of many keys.
+ *
+ * Soft-state tables refreshed by periodic beacons (neighbor tables of
+ * HELLO based routing protocols, for instance) used to schedule one
+ * simulator event per received beacon to check whether the entry has
+ * expired.  With n neighbors beaconing every interval this is n
+ * scheduler insertions per interval and per node, nearly all of them
+ * useless because the entry has been refreshed in the meantime.
+ *
+ * An ExpiryWheel instead records the expiry time of every key and
+ * buckets the keys in a circular array of slots, one slot per
+ * resolution step.  Re-arming a key is an O(1) append to a slot, and a
+ * single simulator event, scheduled for the next non empty slot, scans
+ * the slot and invokes the expire function for the keys whose expiry
+ * time has passed.  Entries made stale by a later Schedule or by Cancel
+ * are dropped when their slot is visited.
+ *
+ * The expire function is invoked at the first multiple of the
+ * resolution not earlier than the expiry time of the key.  It may
+ * re-arm or cancel any key.
+ *
+ * \tparam Key \explicit The type of the keys, for instance Ipv4Address.
+ * \tparam Hash \explicit The hash function of the keys.
+ */
+template <typename Key, typename Hash = std::hash<Key> >
+class ExpiryWheel
+{
+public:
+  /** Constructor. */
+  ExpiryWheel ();
+  /** Destructor, cancels the pending sweep. */
+  ~ExpiryWheel ();
+
+  /**
+   * \param [in] resolution The time between two slots.
+   * \param [in] nSlots The number of slots of the wheel.
+   *
+   * Keys expiring further than resolution * nSlots in the future are
+   * kept in their slot for several turns.  The wheel must be empty.
+   */
+  void SetResolution (Time resolution, uint32_t nSlots);
+  /**
+   * \param [in] expire The function to invoke with every expired key.
+   */
+  void SetFunction (Callback<void, Key> expire);
+
+  /**
+   * Set or replace the expiry time of a key.
+   *
+   * \param [in] key The key.
+   * \param [in] expiry The absolute expiry time.
+   */
+  void Schedule (Key key, Time expiry);
+  /**
+   * \param [in] key The key to forget.
+   */
+  void Cancel (Key key);
+  /**
+   * \param [in] key The key.
+   * \return true if the key is waiting for its expiry.
+   */
+  bool IsPending (Key key) const;
+  /** \return The number of pending keys. */
+  uint32_t GetNPending (void) const;
+  /** Forget every key and cancel the pending sweep. */
+  void Clear (void);
+
+private:
+  /** A key in a slot. */
+  struct Entry
+  {
+    Key key;       //!< The key.
+    int64_t tick;  //!< The tick the key was scheduled for.
+  };
+
+  /**
+   * \param [in] t A time.
+   * \return The first tick not earlier than \p t.
+   */
+  int64_t GetTick (Time t) const;
+  /** Schedule the sweep of the first non empty slot after m_lastTick. */
+  void ScheduleSweep (void);
+  /**
+   * Expire the due keys of a slot.
+   * \param [in] tick The tick of the slot.
+   */
+  void Sweep (int64_t tick);
+
+  int64_t m_resolution;                           //!< Time steps between two ticks.
+  std::vector<std::vector<Entry> > m_slots;       //!< The wheel.
+  std::unordered_map<Key, int64_t, Hash> m_ticks; //!< Expiry tick of the pending keys.
+  int64_t m_lastTick;                             //!< The last tick swept.
+  int64_t m_sweepTick;                            //!< The tick of m_sweep.
+  EventId m_sweep;                                //!< The next sweep.
+  Callback<void, Key> m_expire;                   //!< The expire function.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename Key, typename Hash>
+ExpiryWheel<Key, Hash>::ExpiryWheel ()
+  : m_resolution (MilliSeconds (100).GetTimeStep ()),
+    m_slots (64),
+    m_lastTick (-1),
+    m_sweepTick (0)
+{
+}
+
+template <typename Key, typename Hash>
+ExpiryWheel<Key, Hash>::~ExpiryWheel ()
+{
+  m_sweep.Cancel ();
+}
+
+template <typename Key, typename Hash>
+void
+ExpiryWheel<Key, Hash>::SetResolution (Time resolution, uint32_t nSlots)
+{
+  NS_ASSERT (resolution.IsStrictlyPositive () && nSlots > 0);
+  NS_ASSERT_MSG (m_ticks.empty (), "The resolution of a non empty wheel cannot change");
+  m_resolution = resolution.GetTimeStep ();
+  m_slots.assign (nSlots, std::vector<Entry> ());
+  m_lastTick = -1;
+}
+
+template <typename Key, typename Hash>
+void
+ExpiryWheel<Key, Hash>::SetFunction (Callback<void, Key> expire)
+{
+  m_expire = expire;
+}
+
+template <typename Key, typename Hash>
+int64_t
+ExpiryWheel<Key, Hash>::GetTick (Time t) const
+{
+  int64_t ts = t.GetTimeStep ();
+  if (ts <= 0)
+    {
+      return 0;
+    }
+  return (ts + m_resolution - 1) / m_resolution;
+}
+
+template <typename Key, typename Hash>
+void
+ExpiryWheel<Key, Hash>::Schedule (Key key, Time expiry)
+{
+  int64_t tick = GetTick (expiry);
+  int64_t now = GetTick (Simulator::Now ());
+  if (tick < now)
+    {
+      tick = now;
+    }
+  if (tick <= m_lastTick)
+    {
+      // that slot has already been swept at this time
+      tick = m_lastTick + 1;
+    }
+  m_ticks[key] = tick;
+  Entry entry;
+  entry.key = key;
+  entry.tick = tick;
+  m_slots[tick % m_slots.size ()].push_back (entry);
+  if (!m_sweep.IsRunning () || tick < m_sweepTick)
+    {
+      m_sweep.Cancel ();
+      m_sweepTick = tick;
+      m_sweep = Simulator::Schedule (TimeStep (tick * m_resolution) - Simulator::Now (),
+                                     &ExpiryWheel<Key, Hash>::Sweep, this, tick);
+    }
+}
+
+template <typename Key, typename Hash>
+void
+ExpiryWheel<Key, Hash>::Cancel (Key key)
+{
+  m_ticks.erase (key);
+}
+
+template <typename Key, typename Hash>
+bool
+ExpiryWheel<Key, Hash>::IsPending (Key key) const
+{
+  return m_ticks.find (key) != m_ticks.end ();
+}
+
+template <typename Key, typename Hash>
+uint32_t
+ExpiryWheel<Key, Hash>::GetNPending (void) const
+{
+  return m_ticks.size ();
+}
+
+template <typename Key, typename Hash>
+void
+ExpiryWheel<Key, Hash>::Clear (void)
+{
+  m_sweep.Cancel ();
+  m_ticks.clear ();
+  m_lastTick = -1;
+  for (typename std::vector<std::vector<Entry> >::iterator i = m_slots.begin (); i != m_slots.end (); i++)
+    {
+      i->clear ();
+    }
+}
+
+template <typename Key, typename Hash>
+void
+ExpiryWheel<Key, Hash>::ScheduleSweep (void)
+{
+  if (m_ticks.empty ())
+    {
+      return;
+    }
+  uint32_t nSlots = m_slots.size ();
+  for (uint32_t k = 1; k <= nSlots; k++)
+    {
+      int64_t tick = m_lastTick + k;
+      if (!m_slots[tick % nSlots].empty ())
+        {
+          if (m_sweep.IsRunning ())
+            {
+              // the expire function already re-armed an earlier sweep
+              if (m_sweepTick <= tick)
+                {
+                  return;
+                }
+              m_sweep.Cancel ();
+            }
+          m_sweepTick = tick;
+          m_sweep = Simulator::Schedule (TimeStep (tick * m_resolution) - Simulator::Now (),
+                                         &ExpiryWheel<Key, Hash>::Sweep, this, tick);
+          return;
+        }
+    }
+}
+
+template <typename Key, typename Hash>
+void
+ExpiryWheel<Key, Hash>::Sweep (int64_t tick)
+{
+  m_lastTick = tick;
+  std::vector<Entry> entries;
+  entries.swap (m_slots[tick % m_slots.size ()]);
+  std::vector<Entry> &slot = m_slots[tick % m_slots.size ()];
+  for (typename std::vector<Entry>::const_iterator i = entries.begin (); i != entries.end (); i++)
+    {
+      typename std::unordered_map<Key, int64_t, Hash>::iterator pending = m_ticks.find (i->key);
+      if (pending == m_ticks.end () || pending->second != i->tick)
+        {
+          // cancelled, or re-armed into another entry
+          continue;
+        }
+      if (i->tick > tick)
+        {
+          // due in a later turn of the wheel
+          slot.push_back (*i);
+          continue;
+        }
+      m_ticks.erase (pending);
+      if (!m_expire.IsNull ())
+        {
+          m_expire (i->key);
+        }
+    }
+  ScheduleSweep ();
+}
+
+} // namespace ns3
+
+#endif /* EXPIRY_WHEEL_H */
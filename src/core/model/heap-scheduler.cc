@@ -126,6 +126,8 @@ HeapScheduler::Exch (std::size_t a, std::size_t b)
   Event tmp (m_heap[a]);
   m_heap[a] = m_heap[b];
   m_heap[b] = tmp;
+  m_heap[a].impl->SetSchedulerHandle (a);
+  m_heap[b].impl->SetSchedulerHandle (b);
 }
 
 bool
@@ -202,6 +204,7 @@ void
 HeapScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
+  ev.impl->SetSchedulerHandle (m_heap.size ());
   m_heap.push_back (ev);
   BottomUp ();
 }
@@ -228,19 +231,23 @@ void
 HeapScheduler::Remove (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
-  std::size_t uid = ev.key.m_uid;
-  for (std::size_t i = 1; i < m_heap.size (); i++)
+  // the event knows its index: no need to search the heap for it
+  std::size_t i = ev.impl->GetSchedulerHandle ();
+  NS_ASSERT (i >= Root () && i <= Last ());
+  NS_ASSERT (m_heap[i].key.m_uid == ev.key.m_uid && m_heap[i].impl == ev.impl);
+  Exch (i, Last ());
+  m_heap.pop_back ();
+  if (i == m_heap.size ())
     {
-      if (uid == m_heap[i].key.m_uid)
-        {
-          NS_ASSERT (m_heap[i].impl == ev.impl);
-          Exch (i, Last ());
-          m_heap.pop_back ();
-          TopDown (i);
-          return;
-        }
+      return;
+    }
+  // the last event moved to i may belong above or below it
+  while (!IsRoot (i) && IsLessStrictly (i, Parent (i)))
+    {
+      Exch (i, Parent (i));
+      i = Parent (i);
     }
-  NS_ASSERT (false);
+  TopDown (i);
 }
 
 } // namespace ns3
@@ -42,6 +42,10 @@ namespace ns3 {
  * straightforward implementation of the classic data structure. Not much to say
  * about it.
  *
+ * Each event records its index in the heap in its scheduler handle
+ * (EventImpl::SetSchedulerHandle), which is updated on every exchange,
+ * so that an event is removed in O(log n) without a search.
+ *
  * What is smart about this code ?
  *  - it does not use the index 0 in the array to avoid having to convert
  *    C-style array indexes (which start at zero) and heap-style indexes
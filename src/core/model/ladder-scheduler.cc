@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/** A bucket with more events than this is spread over a finer rung. */
+const std::size_t LADDER_BUCKET_THRESHOLD = 50;
+/** Bottom with more events than this is spread over a new rung. */
+const std::size_t LADDER_BOTTOM_THRESHOLD = 256;
+/** Maximum number of rungs. */
+const std::size_t LADDER_MAX_RUNGS = 8;
+/** Number of consumed events from which Bottom is compacted. */
+const std::size_t LADDER_BOTTOM_COMPACT = 1024;
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMax (0),
+    m_bottomHead (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::BucketIndex (const Rung &rung, uint64_t ts) const
+{
+  uint64_t index = (ts - rung.start) / rung.width;
+  if (index >= rung.buckets.size ())
+    {
+      // the last bucket extends to the end of the rung
+      index = rung.buckets.size () - 1;
+    }
+  return index;
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  if (rung.current >= rung.buckets.size ())
+    {
+      return rung.end;
+    }
+  return rung.start + rung.current * rung.width;
+}
+
+std::size_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  for (std::size_t r = 0; r < m_rungs.size (); r++)
+    {
+      if (ts >= CurrentStart (m_rungs[r]))
+        {
+          return r;
+        }
+    }
+  return m_rungs.size ();
+}
+
+void
+LadderScheduler::SpawnRung (Bucket &events, uint64_t end, bool coarsest)
+{
+  NS_LOG_FUNCTION (this << events.size () << end << coarsest);
+  NS_ASSERT (!events.empty ());
+  uint64_t min = events.front ().key.m_ts;
+  uint64_t max = min;
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      min = std::min (min, i->key.m_ts);
+      max = std::max (max, i->key.m_ts);
+    }
+  // about one event per bucket over the span of the events; the last
+  // bucket also takes the events inserted later up to the end
+  uint64_t n = events.size ();
+  std::vector<Rung>::iterator position = coarsest ? m_rungs.begin () : m_rungs.end ();
+  Rung &rung = *m_rungs.insert (position, Rung ());
+  rung.start = min;
+  rung.width = (max - min) / n + 1;
+  rung.end = end;
+  rung.buckets.resize ((max - min) / rung.width + 1);
+  rung.current = 0;
+  rung.count = n;
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      rung.buckets[BucketIndex (rung, i->key.m_ts)].push_back (*i);
+    }
+  events.clear ();
+  NS_LOG_LOGIC ("rung start=" << rung.start << " width=" << rung.width <<
+                " buckets=" << rung.buckets.size ());
+}
+
+void
+LadderScheduler::SpreadTop (void)
+{
+  Bucket events;
+  events.swap (m_top);
+  m_topStart = m_topMax + 1;
+  SpawnRung (events, m_topStart, true);
+}
+
+void
+LadderScheduler::InsertBottom (const Scheduler::Event &ev)
+{
+  m_bottom.insert (std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev), ev);
+  std::size_t size = m_bottom.size () - m_bottomHead;
+  if (size > LADDER_BOTTOM_THRESHOLD && m_rungs.size () < LADDER_MAX_RUNGS
+      && m_bottom[m_bottomHead].key.m_ts < m_bottom.back ().key.m_ts)
+    {
+      // too many events to keep sorted: spread them over a new rung
+      uint64_t end = m_rungs.empty () ? m_topStart : CurrentStart (m_rungs.back ());
+      Bucket events (m_bottom.begin () + m_bottomHead, m_bottom.end ());
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      SpawnRung (events, end);
+    }
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  if (m_bottomHead < m_bottom.size ())
+    {
+      return;
+    }
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  while (m_size > 0)
+    {
+      if (m_rungs.empty ())
+        {
+          // all the events are in Top
+          SpreadTop ();
+          continue;
+        }
+      Rung &rung = m_rungs.back ();
+      if (rung.count == 0)
+        {
+          m_rungs.pop_back ();
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      rung.count -= bucket.size ();
+      rung.current++;
+      if (bucket.size () > LADDER_BUCKET_THRESHOLD && m_rungs.size () < LADDER_MAX_RUNGS)
+        {
+          uint64_t min = bucket.front ().key.m_ts;
+          uint64_t max = min;
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); i++)
+            {
+              min = std::min (min, i->key.m_ts);
+              max = std::max (max, i->key.m_ts);
+            }
+          if (min < max)
+            {
+              // the bucket now consumed is refined by a new rung
+              Bucket events;
+              events.swap (bucket);
+              SpawnRung (events, CurrentStart (m_rungs.back ()));
+              continue;
+            }
+        }
+      m_bottom.swap (bucket);
+      std::sort (m_bottom.begin (), m_bottom.end ());
+      return;
+    }
+}
+
+void
+LadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_size++;
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_topMax = m_top.empty () ? ts : std::max (m_topMax, ts);
+      m_top.push_back (ev);
+      return;
+    }
+  std::size_t r = FindRung (ts);
+  if (r < m_rungs.size ())
+    {
+      Rung &rung = m_rungs[r];
+      rung.buckets[BucketIndex (rung, ts)].push_back (ev);
+      rung.count++;
+      return;
+    }
+  InsertBottom (ev);
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // filling Bottom moves events between tiers without changing them
+  const_cast<LadderScheduler *> (this)->FillBottom ();
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  FillBottom ();
+  Scheduler::Event next = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_size--;
+  if (m_bottomHead >= LADDER_BOTTOM_COMPACT && 2 * m_bottomHead >= m_bottom.size ())
+    {
+      m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+      m_bottomHead = 0;
+    }
+  return next;
+}
+
+void
+LadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = 0;
+  uint32_t *count = 0;
+  if (ts >= m_topStart && m_top.size () > LADDER_BOTTOM_THRESHOLD
+      && m_rungs.size () < LADDER_MAX_RUNGS)
+    {
+      // cancelling a timer would scan the whole of Top: sort it out first
+      SpreadTop ();
+    }
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      std::size_t r = FindRung (ts);
+      if (r < m_rungs.size ())
+        {
+          bucket = &m_rungs[r].buckets[BucketIndex (m_rungs[r], ts)];
+          count = &m_rungs[r].count;
+        }
+    }
+  if (bucket == 0)
+    {
+      Bucket::iterator i = std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+      NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+      m_bottom.erase (i);
+    }
+  else
+    {
+      Bucket::iterator i = bucket->begin ();
+      while (i != bucket->end () && i->key.m_uid != ev.key.m_uid)
+        {
+          i++;
+        }
+      NS_ASSERT (i != bucket->end ());
+      *i = bucket->back ();
+      bucket->pop_back ();
+      if (count != 0)
+        {
+          (*count)--;
+        }
+    }
+  m_size--;
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue of "Ladder Queue: An
+ * O(1) Priority Queue Structure for Large-Scale Discrete Event
+ * Simulation" by Tang, Goh and Thng (2005).  The events are kept in
+ * three tiers:
+ *
+ * - Top: an unsorted vector of the events later than all the others,
+ *   where the far future events, like expiry timers, are inserted in
+ *   constant time;
+ * - the rungs of the ladder: arrays of unsorted buckets of equal width.
+ *   When the next events are needed, the whole Top is spread over a
+ *   first rung whose width is chosen from the number and the span of the
+ *   events.  A bucket holding too many events is itself spread over a
+ *   finer rung, which adapts the width of the buckets to clusters of
+ *   events, like the beacons sent at the same period;
+ * - Bottom: a small sorted vector of the next events, filled from the
+ *   first non empty bucket of the finest rung.
+ *
+ * Unlike the calendar queue, no bucket is ever resized by a global
+ * heuristic: each set of events is spread once for every level of
+ * refinement it needs.  Events at a single timestamp cannot be split
+ * and are sorted by uid in Bottom.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A set of events, unsorted except in Bottom. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               //!< timestamp of the start of the first bucket
+    uint64_t width;               //!< width of the buckets
+    uint64_t end;                 //!< end of the last bucket, which extends to it
+    std::vector<Bucket> buckets;  //!< the buckets
+    uint32_t current;             //!< the first bucket not yet consumed
+    uint32_t count;               //!< the number of events in the rung
+  };
+
+  /**
+   * \param [in] rung A rung.
+   * \param [in] ts A timestamp in the rung.
+   * \returns The index of the bucket of \p ts.
+   */
+  uint32_t BucketIndex (const Rung &rung, uint64_t ts) const;
+  /**
+   * \param [in] rung A rung.
+   * \returns The start of the buckets not yet consumed.
+   */
+  uint64_t CurrentStart (const Rung &rung) const;
+  /**
+   * \param [in] ts A timestamp earlier than the start of Top.
+   * \returns The index of the rung where \p ts belongs, or the number of
+   * rungs if it belongs to Bottom.
+   */
+  std::size_t FindRung (uint64_t ts) const;
+  /**
+   * Spread events over a new rung.
+   *
+   * \param [in,out] events The events, emptied.
+   * \param [in] end The end of the range of the rung.
+   * \param [in] coarsest Whether the rung is the new coarsest rung,
+   * rather than the new finest one.
+   */
+  void SpawnRung (Bucket &events, uint64_t end, bool coarsest = false);
+  /** Spread Top over a new coarsest rung. */
+  void SpreadTop (void);
+  /**
+   * Insert an event in Bottom.
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /** Fill Bottom with the next events, if it is empty. */
+  void FillBottom (void);
+
+  Bucket m_top;                 //!< the events later than the rungs
+  uint64_t m_topStart;          //!< the start of the range of Top
+  uint64_t m_topMax;            //!< the latest timestamp in Top
+  std::vector<Rung> m_rungs;    //!< the rungs, the finest last
+  Bucket m_bottom;              //!< the next events, sorted, from m_bottomHead
+  std::size_t m_bottomHead;     //!< the index of the next event in m_bottom
+  uint32_t m_size;              //!< the number of events
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/expiry-wheel.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <map>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup timer
+ * \ingroup timer-tests
+ * ExpiryWheel test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup timer-tests
+ *  ExpiryWheel test
+ */
+class ExpiryWheelTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ExpiryWheelTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Function to invoke when a key expires.
+   * \param key The expired key.
+   */
+  void Expire (int key);
+
+  ExpiryWheel<int> m_wheel;          //!< The wheel under test
+  std::map<int, Time> m_expiredTime; //!< Time when every key expired
+  uint32_t m_nExpired;               //!< Number of expire calls
+};
+
+ExpiryWheelTestCase::ExpiryWheelTestCase ()
+  : TestCase ("Check that keys expire once, at their last expiry time")
+{
+}
+
+void
+ExpiryWheelTestCase::Expire (int key)
+{
+  m_nExpired++;
+  m_expiredTime[key] = Simulator::Now ();
+  if (key == 4 && m_expiredTime.count (5) == 0)
+    {
+      // re-arm another key from the expire function
+      m_wheel.Schedule (5, Simulator::Now () + MilliSeconds (30));
+    }
+}
+
+void
+ExpiryWheelTestCase::DoRun (void)
+{
+  m_nExpired = 0;
+  m_wheel.SetResolution (MilliSeconds (10), 8);
+  m_wheel.SetFunction (MakeCallback (&ExpiryWheelTestCase::Expire, this));
+
+  // expires at the resolution step following its expiry time
+  m_wheel.Schedule (1, MilliSeconds (25));
+  // refreshed twice, only the last expiry counts
+  m_wheel.Schedule (2, MilliSeconds (20));
+  Simulator::Schedule (MilliSeconds (15), &ExpiryWheel<int>::Schedule, &m_wheel, 2, MilliSeconds (50));
+  Simulator::Schedule (MilliSeconds (45), &ExpiryWheel<int>::Schedule, &m_wheel, 2, MilliSeconds (70));
+  // several turns of the wheel away
+  m_wheel.Schedule (3, MilliSeconds (250));
+  // re-arms key 5 when it expires
+  m_wheel.Schedule (4, MilliSeconds (40));
+  // cancelled
+  m_wheel.Schedule (6, MilliSeconds (30));
+  Simulator::Schedule (MilliSeconds (5), &ExpiryWheel<int>::Cancel, &m_wheel, 6);
+
+  NS_TEST_ASSERT_MSG_EQ (m_wheel.GetNPending (), 5, "Wrong number of pending keys");
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nExpired, 5, "Wrong number of expired keys");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime[1], MilliSeconds (30), "Key 1 expired at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime[2], MilliSeconds (70), "Key 2 expired at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime[3], MilliSeconds (250), "Key 3 expired at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime[4], MilliSeconds (40), "Key 4 expired at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime[5], MilliSeconds (70), "Key 5 expired at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime.count (6), 0, "Key 6 was cancelled");
+  NS_TEST_ASSERT_MSG_EQ (m_wheel.GetNPending (), 0, "Keys are still pending");
+}
+
+
+/**
+ * \ingroup timer-tests
+ *  ExpiryWheel test suite
+ */
+class ExpiryWheelTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  ExpiryWheelTestSuite ()
+    : TestSuite ("expiry-wheel")
+  {
+    AddTestCase (new ExpiryWheelTestCase ());
+  }
+};
+
+/**
+ * \ingroup timer-tests
+ * ExpiryWheelTestSuite instance variable.
+ */
+static ExpiryWheelTestSuite g_expiryWheelTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
@@ -23,6 +23,14 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/make-event.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include <fstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -461,6 +469,333 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+struct LargeArgument
+{
+  char data[512];
+};
+
+static void largeFunction (LargeArgument argument)
+{}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+private:
+  virtual void DoRun (void);
+  void Count (uint32_t value);
+  uint32_t m_sum;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check the pool of events")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Count (uint32_t value)
+{
+  m_sum += value;
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  m_sum = 0;
+  EventImpl::PoolStats before = EventImpl::GetPoolStats ();
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorEventPoolTestCase::Count, this, i);
+    }
+  LargeArgument argument;
+  Simulator::Schedule (Seconds (1), &largeFunction, argument);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventImpl::PoolStats first = EventImpl::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 999 * 1000 / 2, "Events did not run with their arguments");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (first.allocations - before.allocations, 1001, "Events not counted");
+  NS_TEST_EXPECT_MSG_EQ (first.releases - before.releases, first.allocations - before.allocations, "Events not released");
+  NS_TEST_EXPECT_MSG_EQ (first.large - before.large, 1, "Large event not counted");
+
+  // the events released are reused
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorEventPoolTestCase::Count, this, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventImpl::PoolStats second = EventImpl::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 999 * 1000, "Events did not run with their arguments");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (second.reuses - first.reuses, 1000, "Events not reused");
+  NS_TEST_EXPECT_MSG_EQ (second.chunks, first.chunks, "Pool grown while events were free");
+}
+
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  /**
+   * Insert an event in both schedulers.
+   * \param ts the timestamp of the event
+   */
+  void Insert (uint64_t ts);
+  /**
+   * Remove the next event from both schedulers and compare them.
+   * \returns true if the schedulers agree
+   */
+  bool RemoveNext (void);
+  /** The event inserted. */
+  static void Nothing (void);
+  ObjectFactory m_schedulerFactory;
+  Ptr<Scheduler> m_scheduler;
+  Ptr<Scheduler> m_reference;
+  std::vector<Scheduler::Event> m_pending;
+  Scheduler::EventKey m_last;
+  uint64_t m_now;
+  uint32_t m_uid;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of clustered events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::Nothing (void)
+{
+}
+
+void
+SchedulerOrderTestCase::Insert (uint64_t ts)
+{
+  Scheduler::Event ev;
+  ev.impl = MakeEvent (&SchedulerOrderTestCase::Nothing);
+  ev.key.m_ts = ts;
+  ev.key.m_uid = m_uid++;
+  ev.key.m_context = 0;
+  m_scheduler->Insert (ev);
+  m_reference->Insert (ev);
+  m_pending.push_back (ev);
+}
+
+bool
+SchedulerOrderTestCase::RemoveNext (void)
+{
+  Scheduler::Event expected = m_reference->RemoveNext ();
+  Scheduler::Event peeked = m_scheduler->PeekNext ();
+  Scheduler::Event next = m_scheduler->RemoveNext ();
+  m_last = next.key;
+  m_now = next.key.m_ts;
+  next.impl->Unref ();
+  return peeked.key.m_uid == expected.key.m_uid
+         && next.key.m_uid == expected.key.m_uid
+         && next.key.m_ts == expected.key.m_ts;
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  m_scheduler = m_schedulerFactory.Create<Scheduler> ();
+  m_reference = CreateObject<MapScheduler> ();
+  m_last.m_ts = 0;
+  m_last.m_uid = 0;
+  m_last.m_context = 0;
+  m_now = 0;
+  m_uid = 1;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // beacons at a common period, with a small jitter, and far future
+  // timers; some of them are cancelled
+  uint32_t errors = 0;
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      for (uint32_t i = 0; i < 2000; i++)
+        {
+          uint64_t period = 100000000;
+          double kind = rng->GetValue ();
+          if (kind < 0.7)
+            {
+              uint64_t beacon = (m_now / period + 1 + rng->GetInteger (0, 2)) * period;
+              Insert (beacon + rng->GetInteger (0, 1000));
+            }
+          else if (kind < 0.9)
+            {
+              Insert (m_now + rng->GetInteger (0, 10000));
+            }
+          else
+            {
+              Insert (m_now + 1000 * period + rng->GetInteger (0, 1000000));
+            }
+        }
+      for (uint32_t i = 0; i < 100; i++)
+        {
+          std::size_t index = rng->GetInteger (0, m_pending.size () - 1);
+          Scheduler::Event ev = m_pending[index];
+          m_pending[index] = m_pending.back ();
+          m_pending.pop_back ();
+          if (ev.key < m_last || ev.key.m_uid == m_last.m_uid)
+            {
+              // already removed by RemoveNext
+              continue;
+            }
+          m_scheduler->Remove (ev);
+          m_reference->Remove (ev);
+          ev.impl->Unref ();
+        }
+      for (uint32_t i = 0; i < 1500 && !m_reference->IsEmpty (); i++)
+        {
+          errors += RemoveNext () ? 0 : 1;
+        }
+    }
+  while (!m_reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), false, "Events lost");
+      errors += RemoveNext () ? 0 : 1;
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_scheduler->IsEmpty (), true, "Events left");
+  NS_TEST_EXPECT_MSG_EQ (errors, 0, "Events out of order");
+  m_scheduler = 0;
+  m_reference = 0;
+}
+
+class SimulatorCancelledCompactionTestCase : public TestCase
+{
+public:
+  SimulatorCancelledCompactionTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  void Timer (uint32_t value);
+  ObjectFactory m_schedulerFactory;
+  uint32_t m_sum;
+};
+
+SimulatorCancelledCompactionTestCase::SimulatorCancelledCompactionTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the removal of cancelled events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorCancelledCompactionTestCase::Timer (uint32_t value)
+{
+  m_sum += value;
+}
+
+void
+SimulatorCancelledCompactionTestCase::DoRun (void)
+{
+  m_sum = 0;
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::CancelledCompaction", DoubleValue (0.5));
+  Simulator::SetScheduler (m_schedulerFactory);
+
+  // timers rescheduled ten times each: only the last ones are live
+  std::vector<EventId> timers;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      timers.push_back (Simulator::Schedule (Seconds (1 + i), &SimulatorCancelledCompactionTestCase::Timer, this, 0));
+    }
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      timers[i].Cancel ();
+      if (i % 10 == 9)
+        {
+          Simulator::Schedule (Seconds (1 + i), &SimulatorCancelledCompactionTestCase::Timer, this, i);
+        }
+    }
+  // removing an event already cancelled does nothing
+  Simulator::Remove (timers[0]);
+  Simulator::Run ();
+  uint64_t executed = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::CancelledCompaction", DoubleValue (0));
+
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 100 * 504, "Live events not executed");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (executed, 100, "Live events not counted");
+  NS_TEST_EXPECT_MSG_LT (executed, 400, "Cancelled events not removed");
+}
+
+class SimulatorEventProfileTestCase : public TestCase
+{
+public:
+  SimulatorEventProfileTestCase ();
+private:
+  virtual void DoRun (void);
+  void Work (uint32_t n);
+  uint32_t m_sum;
+};
+
+SimulatorEventProfileTestCase::SimulatorEventProfileTestCase ()
+  : TestCase ("Check the profile of the events")
+{
+}
+
+void
+SimulatorEventProfileTestCase::Work (uint32_t n)
+{
+  m_sum += n;
+}
+
+void
+SimulatorEventProfileTestCase::DoRun (void)
+{
+  m_sum = 0;
+  std::string filename = CreateTempDirFilename ("event-profile.txt");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfile", StringValue (filename));
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::ScheduleWithContext (i % 2, MicroSeconds (i), &SimulatorEventProfileTestCase::Work, this, i);
+    }
+  EventId cancelled = Simulator::Schedule (Seconds (1), &SimulatorEventProfileTestCase::Work, this, 1000);
+  cancelled.Cancel ();
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfile", StringValue (""));
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 99 * 100 / 2, "Events not executed");
+
+  std::ifstream report (filename.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (report.is_open (), true, "No report");
+  std::string line;
+  std::getline (report, line);
+  NS_TEST_EXPECT_MSG_EQ (line.substr (0, 13), "# 100 events,", "Wrong number of events");
+  bool type = false;
+  uint32_t contexts = 0;
+  while (std::getline (report, line))
+    {
+      if (line.find ("void (SimulatorEventProfileTestCase::*)(unsigned int)") != std::string::npos)
+        {
+          type = true;
+          NS_TEST_EXPECT_MSG_NE (line.find (" 100  "), std::string::npos, "Events of the type not counted");
+        }
+      if (line.find ("  context ") != std::string::npos)
+        {
+          contexts++;
+          NS_TEST_EXPECT_MSG_NE (line.find (" 50  "), std::string::npos, "Events of the context not counted");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (type, true, "Type of the events not reported");
+  NS_TEST_EXPECT_MSG_EQ (contexts, 2, "Contexts not reported");
+
+  std::string folded = filename + ".folded";
+  std::ifstream stacks (folded.c_str ());
+  uint32_t nStacks = 0;
+  while (std::getline (stacks, line))
+    {
+      NS_TEST_EXPECT_MSG_EQ (line.substr (0, 8), "context ", "Stack not starting with the context");
+      NS_TEST_EXPECT_MSG_NE (line.find (";void (SimulatorEventProfileTestCase::*)(unsigned int) "), std::string::npos,
+                             "Wrong stack");
+      nStacks++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nStacks, 2, "Wrong number of stacks");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +812,18 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelledCompactionTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelledCompactionTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorEventProfileTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -228,11 +228,12 @@ CsmaChannel::TransmitEnd ()
     {
       if (it->IsActive ())
         {
-          // schedule reception events
+          // schedule reception events, the devices share m_currentPkt
+          // and copy it when they pass it up
           Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
                                           m_delay,
                                           &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+                                          m_currentPkt, m_deviceList[m_currentSrc].devicePtr);
         }
       devId++;
     }
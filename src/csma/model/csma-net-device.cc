@@ -684,10 +684,10 @@ CsmaNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
 }
 
 void
-CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
+CsmaNetDevice::Receive (Ptr<const Packet> originalPacket, Ptr<CsmaNetDevice> senderDevice)
 {
-  NS_LOG_FUNCTION (packet << senderDevice);
-  NS_LOG_LOGIC ("UID is " << packet->GetUid ());
+  NS_LOG_FUNCTION (originalPacket << senderDevice);
+  NS_LOG_LOGIC ("UID is " << originalPacket->GetUid ());
 
   //
   // We never forward up packets that we sent.  Real devices don't do this since
@@ -702,17 +702,24 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   // Hit the trace hook.  This trace will fire on all packets received from the
   // channel except those originated by this device.
   //
-  m_phyRxEndTrace (packet);
+  m_phyRxEndTrace (originalPacket);
 
   // 
   // Only receive if the send side of net device is enabled
   //
   if (IsReceiveEnabled () == false)
     {
-      m_phyRxDropTrace (packet);
+      m_phyRxDropTrace (originalPacket);
       return;
     }
 
+  //
+  // Trace sinks will expect complete packets, not packets without some of the
+  // headers, so they get the packet shared by the channel and we strip the
+  // headers from our own copy.
+  //
+  Ptr<Packet> packet = originalPacket->Copy ();
+
   if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
     {
       NS_LOG_LOGIC ("Dropping pkt due to error model ");
@@ -720,12 +727,6 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
       return;
     }
 
-  //
-  // Trace sinks will expect complete packets, not packets without some of the
-  // headers.
-  //
-  Ptr<Packet> originalPacket = packet->Copy ();
-
   EthernetTrailer trailer;
   packet->RemoveTrailer (trailer);
   if (Node::ChecksumEnabled ())
@@ -162,11 +162,14 @@ public:
    * used by the channel to indicate that the last bit of a packet has 
    * arrived at the device.
    *
+   * The packet is shared with the other devices of the channel, the
+   * device copies it only if it is not dropped.
+   *
    * \see CsmaChannel
    * \param p a reference to the received packet
    * \param sender the CsmaNetDevice that transmitted the packet in the first place
    */
-  void Receive (Ptr<Packet> p, Ptr<CsmaNetDevice> sender);
+  void Receive (Ptr<const Packet> p, Ptr<CsmaNetDevice> sender);
 
   /**
    * Is the send side of the network device enabled?
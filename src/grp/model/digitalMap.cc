@@ -22,9 +22,10 @@ void DigitalMap::readMapFromCsv(std::vector<DigitalMapEntry>& m_map)
 	std::ifstream file(m_path);
 	std::string line;
 
-	while(!file.eof())
+	while(std::getline(file, line))
 	{
-		std::getline(file, line);
+		if(line.empty() || line == "\r")
+			continue;
 
 		std::istringstream iss(line);
 		std::string temp;
@@ -84,9 +85,10 @@ DigitalMap::readTraceCsv(std::string path, std::vector<VTrace>& tracelist)
 	std::ifstream file(path);
 	std::string line;
 
-	while(!file.eof())
+	while(std::getline(file, line))
 	{
-		std::getline(file, line);
+		if(line.empty() || line == "\r")
+			continue;
 		std::istringstream iss(line);
 		std::string temp;
 
@@ -1,6 +1,7 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
 #include <cmath>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "grp-header.h"
@@ -10,6 +11,10 @@
 #define GRP_BLOCK_PKT_HEADER_SIZE 24
 #define GRP_MSG_HEADER_SIZE 12
 #define IPV4_ADDRESS_SIZE 4
+#define GRP_COMPACT_HELLO_SIZE 14
+#define GRP_NEIGHBOR_FILTER_BITS 10
+#define GRP_NEIGHBOR_FILTER_HASHES 7
+#define GRP_NEIGHBOR_FILTER_MAX_WORDS 255
 
 namespace ns3 {
 
@@ -294,6 +299,9 @@ MessageHeader::GetSerializedSize (void) const
       NS_LOG_DEBUG ("Hello Message Size: " << size << " + " << m_message.hello.GetSerializedSize ());
       size += m_message.hello.GetSerializedSize ();
       break;
+    case COMPACT_HELLO_MESSAGE:
+      size += m_message.hello.GetCompactSerializedSize ();
+      break;
     default:
       NS_ASSERT (false);
     }
@@ -323,6 +331,9 @@ MessageHeader::Serialize (Buffer::Iterator start) const
     case HELLO_MESSAGE:
       m_message.hello.Serialize (i);
       break;
+    case COMPACT_HELLO_MESSAGE:
+      m_message.hello.SerializeCompact (i);
+      break;
     default:
       NS_ASSERT (false);
     }
@@ -335,7 +346,7 @@ MessageHeader::Deserialize (Buffer::Iterator start)
   uint32_t size;
   Buffer::Iterator i = start;
   m_messageType  = (MessageType) i.ReadU8 ();
-  NS_ASSERT (m_messageType >= HELLO_MESSAGE && m_messageType <= CPACK_MESSAGE);
+  NS_ASSERT (m_messageType >= HELLO_MESSAGE && m_messageType <= COMPACT_HELLO_MESSAGE);
   m_vTime  = i.ReadU8 ();
   m_messageSize  = i.ReadU16 ();
   m_originatorAddress = Ipv4Address (i.ReadU32 ());
@@ -348,6 +359,9 @@ MessageHeader::Deserialize (Buffer::Iterator start)
     case HELLO_MESSAGE:
       size += m_message.hello.Deserialize (i, m_messageSize - GRP_MSG_HEADER_SIZE);
       break;
+    case COMPACT_HELLO_MESSAGE:
+      size += m_message.hello.DeserializeCompact (i);
+      break;
     default:
       NS_ASSERT (false);
     }
@@ -421,6 +435,7 @@ MessageHeader::Hello::Deserialize (Buffer::Iterator start, uint32_t messageSize)
     int basesize = 28;
 
     this->neighborInterfaceAddresses.clear ();
+    this->neighborFilter.clear ();
     this->locationX = i.ReadU64 ();
     this->locationY = i.ReadU64 ();
     this->speed = i.ReadU32 ();
@@ -458,5 +473,111 @@ MessageHeader::Hello::Deserialize (Buffer::Iterator start, uint32_t messageSize)
     return GetSerializedSize ();
 }
 
+// ---------------- GRP COMPACT HELLO Message -------------------------------
+
+//邻居地址在Bloom filter中对应的位，采用双重哈希生成GRP_NEIGHBOR_FILTER_HASHES个位置
+static uint32_t
+NeighborFilterBit (Ipv4Address addr, int k, uint32_t nbits)
+{
+    uint32_t h = addr.Get () * 0x9e3779b1;
+    h ^= h >> 15;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    uint32_t h1 = h & 0xffff;
+    uint32_t h2 = (h >> 16) | 1;
+    return (h1 + k * h2) % nbits;
+}
+
+void
+MessageHeader::Hello::InitNeighborFilter (uint32_t nNeighbors)
+{
+    //每个邻居约GRP_NEIGHBOR_FILTER_BITS位，误判率约1%，以32位为单位，至少一个单位
+    uint32_t words = (nNeighbors * GRP_NEIGHBOR_FILTER_BITS + 31) / 32;
+    words = std::min (std::max (words, 1u), (uint32_t)GRP_NEIGHBOR_FILTER_MAX_WORDS);
+    this->neighborFilter.assign (words * 4, 0);
+}
+
+void
+MessageHeader::Hello::AddNeighborToFilter (Ipv4Address addr)
+{
+    NS_ASSERT_MSG (this->neighborFilter.empty () == false, "InitNeighborFilter must be called first");
+    uint32_t nbits = this->neighborFilter.size () * 8;
+    for(int k = 0; k < GRP_NEIGHBOR_FILTER_HASHES; k++)
+    {
+        uint32_t bit = NeighborFilterBit (addr, k, nbits);
+        this->neighborFilter[bit / 8] |= (uint8_t)(1 << (bit % 8));
+    }
+}
+
+bool
+MessageHeader::Hello::IsInNeighborFilter (Ipv4Address addr) const
+{
+    if(this->neighborFilter.empty ())
+    {
+        return false;
+    }
+    uint32_t nbits = this->neighborFilter.size () * 8;
+    for(int k = 0; k < GRP_NEIGHBOR_FILTER_HASHES; k++)
+    {
+        uint32_t bit = NeighborFilterBit (addr, k, nbits);
+        if((this->neighborFilter[bit / 8] & (1 << (bit % 8))) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t
+MessageHeader::Hello::GetCompactSerializedSize (void) const
+{
+    return GRP_COMPACT_HELLO_SIZE + this->neighborFilter.size ();
+}
+
+void
+MessageHeader::Hello::SerializeCompact (Buffer::Iterator start) const
+{
+    NS_ASSERT (this->neighborFilter.size () % 4 == 0 && this->neighborFilter.size () / 4 <= 0xff);
+    Buffer::Iterator i = start;
+
+    //位置精度为1cm，速度精度为1cm/s，方向-1编码为0xff
+    i.WriteU32 ((uint32_t)(int32_t)(Uint64ToLoc (this->locationX) / 10));
+    i.WriteU32 ((uint32_t)(int32_t)(Uint64ToLoc (this->locationY) / 10));
+    uint32_t speed = this->speed / 10;
+    i.WriteU16 (speed > 0xffff ? 0xffff : (uint16_t)speed);
+    i.WriteU8 (this->direction > 0xfe ? 0xff : (uint8_t)this->direction);
+    i.WriteU16 (this->turn);
+    i.WriteU8 ((uint8_t)(this->neighborFilter.size () / 4));
+    if(this->neighborFilter.empty () == false)
+    {
+        i.Write (&this->neighborFilter[0], this->neighborFilter.size ());
+    }
+}
+
+uint32_t
+MessageHeader::Hello::DeserializeCompact (Buffer::Iterator start)
+{
+    Buffer::Iterator i = start;
+
+    this->neighborInterfaceAddresses.clear ();
+    this->conlist.clear ();
+    this->locationX = LocToUint64 ((int64_t)(int32_t)i.ReadU32 () * 10);
+    this->locationY = LocToUint64 ((int64_t)(int32_t)i.ReadU32 () * 10);
+    this->speed = (uint32_t)i.ReadU16 () * 10;
+    uint8_t direction = i.ReadU8 ();
+    this->direction = direction == 0xff ? 0xffffffff : direction;
+    this->turn = i.ReadU16 ();
+    this->neighborFilter.assign (i.ReadU8 () * 4, 0);
+    if(this->neighborFilter.empty () == false)
+    {
+        i.Read (&this->neighborFilter[0], this->neighborFilter.size ());
+    }
+
+    this->bsize = GetCompactSerializedSize ();
+    this->asize = 0;
+
+    return GetCompactSerializedSize ();
+}
+
 }
 }
@@ -176,6 +176,7 @@ public:
   {
 	HELLO_MESSAGE = 1,
   CPACK_MESSAGE = 2,
+  COMPACT_HELLO_MESSAGE = 3,
   };
 
   MessageHeader ();
@@ -280,6 +281,22 @@ public:
 //   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //   |                              ...                              |
 //   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//   ----------------------COMPACT HELLO MESSAGE----------------------
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |                        Location X (cm)                        |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |                        Location Y (cm)                        |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |          speed (cm/s)         |   direction   |     turn      |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |     turn      |  Filter Words |     Neighbor Bloom Filter     |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |                              ...                              |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//   位置、速度与方向部分的大小固定；邻居列表被替换为Bloom filter，每个邻居约占
+//   10位而不是4字节，Filter Words为其32位字数，为0时不携带邻居摘要
 
     struct Hello
     {
@@ -351,10 +368,24 @@ public:
 
         std::vector<Ipv4Address> neighborInterfaceAddresses;
 
+        //紧凑格式中的邻居摘要，为空时不携带
+        std::vector<uint8_t> neighborFilter;
+
+        //携带空的邻居摘要，大小按邻居数量确定，使误判率约为1%
+        void InitNeighborFilter (uint32_t nNeighbors);
+        //将邻居地址加入邻居摘要
+        void AddNeighborToFilter (Ipv4Address addr);
+        //邻居摘要中是否可能包含该地址，存在少量误判
+        bool IsInNeighborFilter (Ipv4Address addr) const;
+
         void Print (std::ostream &os) const;
         uint32_t GetSerializedSize (void) const;
         void Serialize (Buffer::Iterator start) const;
         uint32_t Deserialize (Buffer::Iterator start, uint32_t messageSize);
+
+        uint32_t GetCompactSerializedSize (void) const;
+        void SerializeCompact (Buffer::Iterator start) const;
+        uint32_t DeserializeCompact (Buffer::Iterator start);
         
     };
 
@@ -373,14 +404,14 @@ public:
       }
     else
       {
-        NS_ASSERT (m_messageType == HELLO_MESSAGE);
+        NS_ASSERT (m_messageType == HELLO_MESSAGE || m_messageType == COMPACT_HELLO_MESSAGE);
       }
     return m_message.hello;
   }
 
   const Hello& GetHello () const
   {
-    NS_ASSERT (m_messageType == HELLO_MESSAGE);
+    NS_ASSERT (m_messageType == HELLO_MESSAGE || m_messageType == COMPACT_HELLO_MESSAGE);
     return m_message.hello;
   }
 };
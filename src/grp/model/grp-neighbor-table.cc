@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "grp-neighbor-table.h"
+#include "ns3/assert.h"
+#include <cmath>
+
+namespace ns3 {
+namespace grp {
+
+NeighborTable::NeighborTable ()
+  : m_cellSize (100)
+{
+}
+
+void
+NeighborTable::SetCellSize (double size)
+{
+  NS_ASSERT (size > 0);
+  NS_ASSERT (m_entries.empty ());
+  m_cellSize = size;
+}
+
+int64_t
+NeighborTable::GetCellIndex (double v) const
+{
+  return (int64_t) std::floor (v / m_cellSize);
+}
+
+uint64_t
+NeighborTable::GetCellKey (int64_t cx, int64_t cy) const
+{
+  return ((uint64_t)(uint32_t) cx << 32) | (uint32_t) cy;
+}
+
+const NeighborTableEntry *
+NeighborTable::Find (Ipv4Address address) const
+{
+  std::unordered_map<uint32_t, uint32_t>::const_iterator i = m_slots.find (address.Get ());
+  if (i == m_slots.end ())
+    {
+      return 0;
+    }
+  return &m_entries[i->second];
+}
+
+void
+NeighborTable::Insert (const NeighborTableEntry &entry)
+{
+  uint64_t cell = GetCellKey (GetCellIndex (entry.N_location_x), GetCellIndex (entry.N_location_y));
+  std::unordered_map<uint32_t, uint32_t>::const_iterator i = m_slots.find (entry.N_neighbor_address.Get ());
+  uint32_t slot;
+  if (i == m_slots.end ())
+    {
+      slot = m_entries.size ();
+      m_slots[entry.N_neighbor_address.Get ()] = slot;
+      m_x.push_back (entry.N_location_x);
+      m_y.push_back (entry.N_location_y);
+      m_symmetric.push_back (entry.N_status == NeighborTableEntry::STATUS_SYM);
+      m_cell.push_back (cell);
+      m_entries.push_back (entry);
+      m_cells[cell].push_back (slot);
+      return;
+    }
+
+  slot = i->second;
+  m_x[slot] = entry.N_location_x;
+  m_y[slot] = entry.N_location_y;
+  m_symmetric[slot] = (entry.N_status == NeighborTableEntry::STATUS_SYM);
+  m_entries[slot] = entry;
+  if (m_cell[slot] != cell)
+    {
+      RemoveFromCell (slot);
+      m_cell[slot] = cell;
+      m_cells[cell].push_back (slot);
+    }
+}
+
+void
+NeighborTable::RemoveFromCell (uint32_t slot)
+{
+  std::unordered_map<uint64_t, std::vector<uint32_t> >::iterator c = m_cells.find (m_cell[slot]);
+  NS_ASSERT (c != m_cells.end ());
+  std::vector<uint32_t> &slots = c->second;
+  for (std::vector<uint32_t>::iterator s = slots.begin (); s != slots.end (); s++)
+    {
+      if (*s == slot)
+        {
+          *s = slots.back ();
+          slots.pop_back ();
+          break;
+        }
+    }
+  if (slots.empty ())
+    {
+      m_cells.erase (c);
+    }
+}
+
+bool
+NeighborTable::Erase (Ipv4Address address)
+{
+  std::unordered_map<uint32_t, uint32_t>::iterator i = m_slots.find (address.Get ());
+  if (i == m_slots.end ())
+    {
+      return false;
+    }
+  uint32_t slot = i->second;
+  m_slots.erase (i);
+  RemoveFromCell (slot);
+
+  uint32_t last = m_entries.size () - 1;
+  if (slot != last)
+    {
+      // move the last slot into the hole and fix its references
+      std::vector<uint32_t> &cell = m_cells[m_cell[last]];
+      for (std::vector<uint32_t>::iterator s = cell.begin (); s != cell.end (); s++)
+        {
+          if (*s == last)
+            {
+              *s = slot;
+              break;
+            }
+        }
+      m_slots[m_entries[last].N_neighbor_address.Get ()] = slot;
+      m_x[slot] = m_x[last];
+      m_y[slot] = m_y[last];
+      m_symmetric[slot] = m_symmetric[last];
+      m_cell[slot] = m_cell[last];
+      m_entries[slot] = m_entries[last];
+    }
+  m_x.pop_back ();
+  m_y.pop_back ();
+  m_symmetric.pop_back ();
+  m_cell.pop_back ();
+  m_entries.pop_back ();
+  return true;
+}
+
+void
+NeighborTable::Clear (void)
+{
+  m_x.clear ();
+  m_y.clear ();
+  m_symmetric.clear ();
+  m_cell.clear ();
+  m_entries.clear ();
+  m_slots.clear ();
+  m_cells.clear ();
+}
+
+void
+NeighborTable::GetCandidates (double minx, double miny, double maxx, double maxy,
+                              std::vector<uint32_t> &slots) const
+{
+  if (m_entries.empty () || minx > maxx || miny > maxy)
+    {
+      return;
+    }
+  int64_t x0 = GetCellIndex (minx);
+  int64_t x1 = GetCellIndex (maxx);
+  int64_t y0 = GetCellIndex (miny);
+  int64_t y1 = GetCellIndex (maxy);
+  if ((double)(x1 - x0 + 1) * (y1 - y0 + 1) >= m_cells.size ())
+    {
+      // the box covers more cells than are occupied, visit them all
+      for (std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator c = m_cells.begin ();
+           c != m_cells.end (); c++)
+        {
+          slots.insert (slots.end (), c->second.begin (), c->second.end ());
+        }
+      return;
+    }
+  for (int64_t cx = x0; cx <= x1; cx++)
+    {
+      for (int64_t cy = y0; cy <= y1; cy++)
+        {
+          std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator c = m_cells.find (GetCellKey (cx, cy));
+          if (c != m_cells.end ())
+            {
+              slots.insert (slots.end (), c->second.begin (), c->second.end ());
+            }
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef GRP_NEIGHBOR_TABLE_H
+#define GRP_NEIGHBOR_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+namespace grp {
+
+struct NeighborTableEntry
+{
+    int N_turn;
+    int N_direction;
+    Time N_time;
+    double N_speed;
+    double N_location_x;
+    double N_location_y;
+    uint16_t N_sequenceNum;
+    Ipv4Address receiverIfaceAddr;
+    Ipv4Address N_neighbor_address;
+
+    enum Status
+    {
+        STATUS_NOT_SYM = 0,
+        STATUS_SYM = 1,
+    } N_status;
+
+    NeighborTableEntry () :
+        N_turn (-1), N_speed (0), N_location_x (0), N_location_y (0),
+        N_sequenceNum (0),N_neighbor_address (), N_status (STATUS_NOT_SYM)
+    {
+
+    }
+};
+
+/**
+ * \brief The one-hop neighbors of a grp node.
+ *
+ * The entries are stored in slots 0..GetSize()-1 of flat arrays: the
+ * fields read by the greedy next hop selection (position and status) are
+ * kept apart from the rest of the entry so that a scan only touches
+ * contiguous memory.  Every slot is also bucketed in a uniform grid over
+ * the advertised positions, so that the candidates lying in a given area
+ * (the segment towards the next junction, the transmission range) are
+ * found without visiting the whole table.  Removing an entry moves the
+ * last slot into its place, hence slots are only stable until the next
+ * Erase.
+ */
+class NeighborTable
+{
+public:
+  NeighborTable ();
+
+  /**
+   * \param size the side of the grid cells, the table must be empty
+   */
+  void SetCellSize (double size);
+
+  uint32_t GetSize (void) const
+  {
+    return m_entries.size ();
+  }
+  bool IsEmpty (void) const
+  {
+    return m_entries.empty ();
+  }
+
+  /**
+   * \param address the neighbor address
+   * \return the entry of the neighbor, or 0 if it is not in the table
+   */
+  const NeighborTableEntry *Find (Ipv4Address address) const;
+
+  /**
+   * Add an entry or replace the entry of the same neighbor.
+   *
+   * \param entry the entry, keyed by its N_neighbor_address
+   */
+  void Insert (const NeighborTableEntry &entry);
+  /**
+   * \param address the neighbor to remove
+   * \return true if the neighbor was in the table
+   */
+  bool Erase (Ipv4Address address);
+  void Clear (void);
+
+  const NeighborTableEntry &Get (uint32_t slot) const
+  {
+    return m_entries[slot];
+  }
+  double GetX (uint32_t slot) const
+  {
+    return m_x[slot];
+  }
+  double GetY (uint32_t slot) const
+  {
+    return m_y[slot];
+  }
+  bool IsSymmetric (uint32_t slot) const
+  {
+    return m_symmetric[slot];
+  }
+
+  /**
+   * Append to \p slots every slot whose grid cell intersects the given
+   * box.  The caller still has to check the exact position.
+   *
+   * \param minx the minimum x coordinate of the box
+   * \param miny the minimum y coordinate of the box
+   * \param maxx the maximum x coordinate of the box
+   * \param maxy the maximum y coordinate of the box
+   * \param slots the vector to fill
+   */
+  void GetCandidates (double minx, double miny, double maxx, double maxy,
+                      std::vector<uint32_t> &slots) const;
+
+private:
+  int64_t GetCellIndex (double v) const;
+  uint64_t GetCellKey (int64_t cx, int64_t cy) const;
+  void RemoveFromCell (uint32_t slot);
+
+  double m_cellSize;
+
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  std::vector<uint8_t> m_symmetric;
+  std::vector<uint64_t> m_cell;
+  std::vector<NeighborTableEntry> m_entries;
+
+  /// slot of every neighbor
+  std::unordered_map<uint32_t, uint32_t> m_slots;
+  /// slots of the neighbors in every grid cell
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells;
+};
+
+}
+}
+
+#endif /* GRP_NEIGHBOR_TABLE_H */
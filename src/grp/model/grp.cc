@@ -12,13 +12,17 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
+#include "ns3/integer.h"
+#include "ns3/double.h"
 #include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/network-module.h"
 #include "ns3/tag.h"
+#include "ns3/node-address-index.h"
 #include <cmath>
+#include <algorithm>
 
 #define GRP_MAX_MSGS 64
 #define GRP_PORT_NUMBER 12345
@@ -51,6 +55,28 @@ RoutingProtocol::GetTypeId (void)
                    TimeValue (Seconds (1)),
                    MakeTimeAccessor (&RoutingProtocol::m_helloInterval),
                    MakeTimeChecker ())
+    .AddAttribute ("HelloFormat", "The format of the HELLO messages: Full lists the address of "
+                   "every neighbor, Bloom and PositionOnly send a compact beacon with a Bloom "
+                   "filter of the neighbors (about 10 bits each) or without any neighbor summary.",
+                   EnumValue (HELLO_FULL),
+                   MakeEnumAccessor (&RoutingProtocol::m_helloFormat),
+                   MakeEnumChecker (HELLO_FULL, "Full",
+                                    HELLO_BLOOM, "Bloom",
+                                    HELLO_POSITION_ONLY, "PositionOnly"))
+    .AddAttribute ("VehicleNumber", "The number of vehicles of the scenario, "
+                   "selects the road network under TestScenaries.",
+                   IntegerValue (100),
+                   MakeIntegerAccessor (&RoutingProtocol::vnum),
+                   MakeIntegerChecker<int> (1))
+    .AddAttribute ("TransmissionRange", "The line of sight transmission range (m).",
+                   DoubleValue (250),
+                   MakeDoubleAccessor (&RoutingProtocol::InsightTransRange),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("CarryTimeThreshold", "The longest time (s) a data packet is stored "
+                   "by the carry-and-forward mechanism before being dropped.",
+                   DoubleValue (20),
+                   MakeDoubleAccessor (&RoutingProtocol::CarryTimeThreshold),
+                   MakeDoubleChecker<double> ())
     .AddTraceSource ("DropPacket", "Drop data packet.",
 					MakeTraceSourceAccessor (&RoutingProtocol::m_DropPacketTrace),
 					"ns3::grp::RoutingProtocol::m_DropPacketTraceCallback")
@@ -95,6 +121,10 @@ RoutingProtocol::SetIpv4 (Ptr<Ipv4> ipv4)
 
 void RoutingProtocol::DoDispose ()
 {
+  if (m_ipv4 != 0)
+    {
+      NodeAddressIndex::Remove (m_ipv4->GetObject<Node> ());
+    }
   m_ipv4 = 0;
 
   if (m_recvSocket)
@@ -118,17 +148,15 @@ void RoutingProtocol::DoDispose ()
     }
   m_sendBlockSockets.clear ();
 
-  m_neiTable.clear ();
+  m_neiTable.Clear ();
+  m_neiExpiry.Clear ();
 
     m_wTimeCache.clear();
-    m_tracelist.clear();
-    m_squeue.clear();
+    m_pqueue.clear();
     m_pwaitqueue.clear();
     m_delayqueue.clear();
-    m_map.clear();
-
-    delete[] Graph;
-
+    m_network = 0;
+    m_routeTable = 0;
 
 
   Ipv4RoutingProtocol::DoDispose ();
@@ -153,24 +181,10 @@ void RoutingProtocol::InitialPosition()
 	m_last_x = xn;
 	m_last_y = yn;
 
-	int i = 0;
-	int idx = -1;
-	double min = 100000;
-	for(std::vector<VTrace>::iterator itr = m_tracelist.begin(); itr!=m_tracelist.end(); itr++)
+	int idx = m_network->GetNearestTrace(xn, yn);
+	for(uint32_t k = m_network->GetTraceBegin(idx); k < m_network->GetTraceEnd(idx); k++)
 	{
-		double dis = sqrt(pow(xn-itr->x, 2)+pow(yn-itr->y, 2));
-		if(dis < min)
-		{
-			min = dis;
-			idx = i;
-		}
-		i++;
-	}
-
-	std::vector<int> jlist = m_tracelist[idx].jlist;
-	for(std::vector<int>::iterator itr = jlist.begin(); itr!=jlist.end(); itr++)
-	{
-		m_trailTrace.push(*itr);
+		m_trailTrace.push(m_network->GetTraceJunction(k));
 	}
     
     m_currentJID = m_trailTrace.front();
@@ -185,93 +199,30 @@ void RoutingProtocol::InitialPosition()
 int
 RoutingProtocol::GetDirection(int currentJID, int nextJID)
 {
-	double cx = m_map[currentJID].x;
-	double cy = m_map[currentJID].y;
-	double nx = m_map[nextJID].x;
-	double ny = m_map[nextJID].y;
-
-	if(ny == cy)
-	{
-		if(nx > cx)
-			return 0;
-		else
-			return 2;
-	}
-	else
-	{
-		if(ny > cy)
-			return 1;
-		else
-			return 3;
-	}
-
-	return -1;
-}
-
-void RoutingProtocol::ReadConfiguration()
-{
-    std::ifstream file(confile);
-	std::string line;
-    while(!file.eof())
-	{
-		std::getline(file, line);
-
-		std::istringstream iss(line);
-		std::string temp;
- 
-		while (std::getline(iss, temp, '='))
-		{
-            std::string value = std::move(temp);
-            if(value == "vnum")
-            {
-                std::getline(iss, temp, ',');
-				value = std::move(temp);
-                vnum = atoi(value.c_str());
-            }
-            else if(value == "range")
-            {
-                std::getline(iss, temp, ',');
-				value = std::move(temp);
-                InsightTransRange = atof(value.c_str());
-            }
-            else if(value == "CarryTimeThreshold")
-            {
-                std::getline(iss, temp, ',');
-				value = std::move(temp);
-                CarryTimeThreshold = atof(value.c_str());
-            }
-            
-        }
-
-    }
+	return m_network->GetDirection(currentJID, nextJID);
 }
 
 void RoutingProtocol::DoInitialize ()
 {
-    ReadConfiguration();
-
 	RSSIDistanceThreshold = InsightTransRange * 0.9;
-    for(int i = 0; i < m_JuncNum; i++)
-    {
-        m_jqueuetag[i] = false;
-    }
-
-    Graph = new float *[m_JuncNum];
-    for(int i = 0;i < m_JuncNum; ++i)
-    {
-        Graph[i] = new float[m_JuncNum];
-        for(int j = 0; j<m_JuncNum; j++)
-        {
-            Graph[i][j] = INF;
-        }
-    }
+    //邻居表按路口区域大小划分网格
+    m_neiTable.SetCellSize(JunAreaRadius);
+    m_neiExpiry.SetResolution(m_helloInterval / 10, 32);
+    m_neiExpiry.SetFunction(MakeCallback(&RoutingProtocol::NeiTableCheckExpire, this));
 
-	DigitalMap map;
 	std::string mapfile = "TestScenaries/" + std::to_string(vnum) + "/6x6_map.csv";
     std::string tracefile = "TestScenaries/" + std::to_string(vnum) + "/6x6_vtrace.csv";
-	map.setMapFilePath(mapfile);
-	map.readMapFromCsv(m_map);
-	map.readTraceCsv(tracefile, m_tracelist);
+    std::string networkfile = "TestScenaries/" + std::to_string(vnum) + "/6x6_network.bin";
+    //路网只在第一辆车初始化时读取一次，其余车辆共享同一份数据
+    //存在compile-road-network生成的二进制路网时直接映射，不再解析CSV
+    if(RoadNetwork::IsCompiled(networkfile))
+        m_network = RoadNetwork::Load(networkfile);
+    else
+	    m_network = RoadNetwork::Load(mapfile, tracefile);
+    m_JuncNum = m_network->GetNJunctions();
+    //路网拓扑在仿真过程中不变，下一路口表只在第一次使用前计算一次
+    m_routeTable = JunctionRouteTable::GetHopCountTable(m_network);
+    m_routeTable->Prepare(std::vector<int>(1, m_rsujid));
 
 
   if (m_mainAddress == Ipv4Address ())
@@ -433,6 +384,7 @@ RoutingProtocol::RecvGrp (Ptr<Socket> socket)
       switch (messageHeader.GetMessageType ())
 	  {
 		case grp::MessageHeader::HELLO_MESSAGE:
+		case grp::MessageHeader::COMPACT_HELLO_MESSAGE:
 			NS_LOG_DEBUG (Simulator::Now ().GetSeconds ()
 							<< "s GRP node " << m_mainAddress
 							<< " received HELLO message of size " << messageHeader.GetSerializedSize ());
@@ -468,98 +420,115 @@ RoutingProtocol::SendFromDelayQueue()
 void
 RoutingProtocol::CheckPacketQueue()
 {
-    m_pqueue.assign(m_pwaitqueue.begin(), m_pwaitqueue.end());
+    //整批处理缓存的数据包：车辆位置与邻居表在本次检查中不变，
+    //所有数据包的目标路口只可能是路段间路由选出的路口、当前/下一路口或最近路口，
+    //因此每个目标路口的下一跳、每个目的节点是否在通信范围内都只计算一次
+    m_pqueue.swap(m_pwaitqueue);
  	m_pwaitqueue.clear();
 
-  	while(m_pqueue.empty() == false)
- 	{
- 		PacketQueueEntry qentry = m_pqueue.back();
- 		m_pqueue.pop_back();
+    Ipv4Address loopback ("127.0.0.1");
+    int areajid = -1;
+    int nearestjid = -1;
+    bool areajidKnown = false, nearestjidKnown = false;
+    std::vector<std::pair<int, Ipv4Address> > hops;
+    std::vector<std::pair<Ipv4Address, bool> > inRange;
 
- 		Ipv4Address dest = qentry.m_header.GetDestination();
- 		Ipv4Address origin = qentry.m_header.GetSource();
+  	for(std::vector<PacketQueueEntry>::iterator qentry = m_pqueue.begin(); qentry != m_pqueue.end(); qentry++)
+ 	{
+ 		Ipv4Address dest = qentry->m_header.GetDestination();
+ 		Ipv4Address origin = qentry->m_header.GetSource();
 
   		QPacketInfo pInfo(origin, dest);
  		QMap::const_iterator pItr = m_wTimeCache.find(pInfo);
  		if(pItr != m_wTimeCache.end() && Simulator::Now().GetSeconds() - pItr->second.GetSeconds() >= CarryTimeThreshold )
  		{
  			NS_LOG_UNCOND("Store time more than: " << CarryTimeThreshold << "s.");
- 			m_DropPacketTrace(qentry.m_header);
+ 			m_DropPacketTrace(qentry->m_header);
  			m_wTimeCache.erase(pInfo);
  			continue;
  		}
 
-  		grp::DataPacketHeader DataPacketHeader;
- 		qentry.m_packet->RemoveHeader (DataPacketHeader);
- 		int nextjid = (int)DataPacketHeader.GetNextJID();
- 		
-  		Ipv4Address loopback ("127.0.0.1");
-        Ipv4Address nextHop("127.0.0.1");
-
+ 		int nextjid = qentry->m_nextjid;
         if(m_JunAreaTag == true)
         {
-            nextjid = GetPacketNextJID(true);
+            if(!areajidKnown)
+            {
+                areajid = GetPacketNextJID(true);
+                areajidKnown = true;
+            }
+            nextjid = areajid;
         }
         else
         {
             if(nextjid != m_currentJID && nextjid != m_nextJID)
             {
-                nextjid = GetNearestJID();
+                if(!nearestjidKnown)
+                {
+                    nearestjid = GetNearestJID();
+                    nearestjidKnown = true;
+                }
+                nextjid = nearestjid;
             }
         }
-        nextHop = IntraPathRouting(dest, nextjid);
+        qentry->m_nextjid = nextjid;
 
-        DataPacketHeader.SetNextJID(nextjid);
-        qentry.m_packet->AddHeader (DataPacketHeader);
+        Ipv4Address nextHop = loopback;
+        if(nextjid >= 0)
+        {
+            std::vector<std::pair<Ipv4Address, bool> >::const_iterator r = inRange.begin();
+            while(r != inRange.end() && r->first != dest)
+                r++;
+            if(r == inRange.end())
+            {
+                inRange.push_back(std::make_pair(dest, IsInTransRange(dest)));
+                r = inRange.end() - 1;
+            }
+
+            if(r->second)
+            {
+                nextHop = dest;
+            }
+            else
+            {
+                std::vector<std::pair<int, Ipv4Address> >::const_iterator h = hops.begin();
+                while(h != hops.end() && h->first != nextjid)
+                    h++;
+                if(h == hops.end())
+                {
+                    hops.push_back(std::make_pair(nextjid, GetNextHopTowards(nextjid)));
+                    h = hops.end() - 1;
+                }
+                nextHop = h->second;
+            }
+        }
 
   		if(nextHop == loopback)
- 			m_pwaitqueue.push_back(qentry);
+ 			m_pwaitqueue.push_back(*qentry);
  		else
  		{
  			m_wTimeCache.erase(pInfo);
- 			m_squeue.push_back(SendingQueue(qentry.m_packet, qentry.m_header, qentry.m_ucb, nextHop));
+ 			SendStoredPacket(*qentry, nextHop);
  			// NS_LOG_UNCOND("" << Simulator::Now().GetSeconds() << " " << m_id << " forwards a STORE data packet to " << AddrToID(nextHop));
-
   		}
  	}
-
-  	if(m_squeue.empty() == false)
- 	{
- 		SendFromSQueue();
- 	}
-
+    m_pqueue.clear();
 }
 
 void
-RoutingProtocol::SendFromSQueue()
+RoutingProtocol::SendStoredPacket(PacketQueueEntry &entry, Ipv4Address nextHop)
 {
- 	if(m_squeue.empty() == false)
- 	{
- 		SendingQueue sentry = m_squeue.back();
- 		m_squeue.pop_back();
-
-  		Ptr<Ipv4Route> rtentry;
- 		rtentry = Create<Ipv4Route> ();
- 		rtentry->SetDestination (sentry.m_header.GetDestination ());
- 		rtentry->SetSource (sentry.m_header.GetSource());
- 		rtentry->SetGateway (sentry.nexthop);
- 		rtentry->SetOutputDevice (m_ipv4->GetNetDevice (0));
- 		sentry.m_ucb(rtentry, sentry.m_packet, sentry.m_header);
-
-  		Simulator::Schedule(MilliSeconds(10), &RoutingProtocol::SendFromSQueue, this);
- 	}
-}
-
-bool
-RoutingProtocol::isAdjacentVex(int sjid, int ejid)
-{
-    for(std::map<int, std::vector<float>>::iterator itr = m_map[sjid].outedge.begin(); 
-        itr != m_map[sjid].outedge.end(); itr++)
-    {
-        if(itr->first == ejid)
-            return true;    
-    }
-    return false;
+    grp::DataPacketHeader DataPacketHeader;
+    DataPacketHeader.SetNextJID(entry.m_nextjid);
+    DataPacketHeader.SetSenderID(m_id);
+    entry.m_packet->AddHeader (DataPacketHeader);
+
+    Ptr<Ipv4Route> rtentry;
+    rtentry = Create<Ipv4Route> ();
+    rtentry->SetDestination (entry.m_header.GetDestination ());
+    rtentry->SetSource (entry.m_header.GetSource());
+    rtentry->SetGateway (nextHop);
+    rtentry->SetOutputDevice (m_ipv4->GetNetDevice (0));
+    entry.m_ucb(rtentry, entry.m_packet, entry.m_header);
 }
 
 void
@@ -573,8 +542,8 @@ RoutingProtocol::ProcessHello (const grp::MessageHeader &msg,
     int cjid = GetNearestJID();
     if((int)hello.GetDirection() != m_direction && (int)hello.GetDirection() != (m_direction + 2)%4)
     {
-        double jx = m_map[cjid].x;
-        double jy = m_map[cjid].y;
+        double jx = m_network->GetJunctionX(cjid);
+        double jy = m_network->GetJunctionY(cjid);
         double nx = hello.GetLocationX();
         double ny = hello.GetLocationY();
         if(m_JunAreaTag == false && sqrt(pow(nx-jx, 2) + pow(ny-jy, 2)) > JunAreaRadius)
@@ -584,15 +553,11 @@ RoutingProtocol::ProcessHello (const grp::MessageHeader &msg,
     }
 
 	Ipv4Address originatorAddress = msg.GetOriginatorAddress();
-	std::map<Ipv4Address, NeighborTableEntry>::const_iterator itr = m_neiTable.find (originatorAddress);
-	if(itr != m_neiTable.end() && itr->second.N_sequenceNum >= msg.GetMessageSequenceNumber())
+	const NeighborTableEntry *itr = m_neiTable.Find (originatorAddress);
+	if(itr != 0 && itr->N_sequenceNum >= msg.GetMessageSequenceNumber())
 		return;
-	if(itr != m_neiTable.end())
-	{
-		m_neiTable.erase(originatorAddress);
-	}
 
-	NeighborTableEntry &neiTableTuple = m_neiTable[originatorAddress];
+	NeighborTableEntry neiTableTuple;
 	neiTableTuple.N_neighbor_address = msg.GetOriginatorAddress();
 	neiTableTuple.N_speed = hello.GetSpeed();
 	neiTableTuple.N_direction = hello.GetDirection();
@@ -605,6 +570,12 @@ RoutingProtocol::ProcessHello (const grp::MessageHeader &msg,
 	neiTableTuple.N_turn = hello.GetTurn();
 
     neiTableTuple.N_status = NeighborTableEntry::STATUS_NOT_SYM;
+    if(msg.GetMessageType() == grp::MessageHeader::COMPACT_HELLO_MESSAGE)
+    {
+        //紧凑格式：根据邻居摘要判断链路是否对称，不携带摘要时视为对称链路
+        if(hello.neighborFilter.empty() || hello.IsInNeighborFilter(m_mainAddress))
+            neiTableTuple.N_status = NeighborTableEntry::STATUS_SYM;
+    }
 	for (std::vector<Ipv4Address>::const_iterator i = hello.neighborInterfaceAddresses.begin ();
 			i != hello.neighborInterfaceAddresses.end (); i++)
 	{
@@ -614,8 +585,9 @@ RoutingProtocol::ProcessHello (const grp::MessageHeader &msg,
 			break;
 		}
 	}
+	m_neiTable.Insert (neiTableTuple);
 
-	Simulator::Schedule(GRP_NEIGHB_HOLD_TIME, &RoutingProtocol::NeiTableCheckExpire, this, originatorAddress);
+	m_neiExpiry.Schedule(originatorAddress, neiTableTuple.N_time);
 
     if(m_pwaitqueue.empty() == false)
  	{
@@ -627,8 +599,7 @@ RoutingProtocol::ProcessHello (const grp::MessageHeader &msg,
 int 
 RoutingProtocol::AddrToID(Ipv4Address addr)
 {
-	int tnum = addr.Get();
-	return tnum / 256 % 256 * 256 + tnum % 256 - 1;
+	return NodeAddressIndex::GetNodeId(addr);
 }
 
 void
@@ -701,8 +672,8 @@ RoutingProtocol::GetNearestJID()
     Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
 	double cx = MM->GetPosition ().x;
 	double cy = MM->GetPosition ().y;
-    if(pow(cx-m_map[m_currentJID].x, 2) + pow(cy-m_map[m_currentJID].y, 2)
-        < pow(cx-m_map[m_nextJID].x, 2) + pow(cy-m_map[m_nextJID].y, 2))
+    if(pow(cx-m_network->GetJunctionX(m_currentJID), 2) + pow(cy-m_network->GetJunctionY(m_currentJID), 2)
+        < pow(cx-m_network->GetJunctionX(m_nextJID), 2) + pow(cy-m_network->GetJunctionY(m_nextJID), 2))
 	{
         return m_currentJID;
     }
@@ -726,6 +697,10 @@ RoutingProtocol::SendHello ()
 	msg.SetTimeToLive (1);
 	msg.SetHopCount (0);
 	msg.SetMessageSequenceNumber (GetMessageSequenceNumber ());
+    if(m_helloFormat != HELLO_FULL)
+    {
+        msg.SetMessageType (grp::MessageHeader::COMPACT_HELLO_MESSAGE);
+    }
 	grp::MessageHeader::Hello &hello = msg.GetHello ();
 
 	Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
@@ -734,11 +709,15 @@ RoutingProtocol::SendHello ()
 	hello.SetLocation(positionX, positionY);
 
 	hello.SetSpeedAndDirection(m_speed, m_direction);
+    if(m_helloFormat == HELLO_BLOOM)
+        hello.InitNeighborFilter(m_neiTable.GetSize ());
 
-    for (std::map<Ipv4Address, NeighborTableEntry>::const_iterator iter = m_neiTable.begin ();
-			iter != m_neiTable.end (); iter++)
+    for (uint32_t i = 0; i < m_neiTable.GetSize (); i++)
 	{
-		hello.neighborInterfaceAddresses.push_back(iter->first);
+        if(m_helloFormat == HELLO_FULL)
+		    hello.neighborInterfaceAddresses.push_back(m_neiTable.Get (i).N_neighbor_address);
+        else if(m_helloFormat == HELLO_BLOOM)
+            hello.AddNeighborToFilter(m_neiTable.Get (i).N_neighbor_address);
 	}
 
 	QueueMessage (msg, JITTER);
@@ -769,10 +748,10 @@ RoutingProtocol::CheckPositionExpire()
 	Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
 	double cvx = MM->GetPosition ().x;
 	double cvy = MM->GetPosition ().y;
-	double njx = m_map[m_nextJID].x;
-	double njy = m_map[m_nextJID].y;
-	double cjx = m_map[m_currentJID].x;
-	double cjy = m_map[m_currentJID].y;
+	double njx = m_network->GetJunctionX(m_nextJID);
+	double njy = m_network->GetJunctionY(m_nextJID);
+	double cjx = m_network->GetJunctionX(m_currentJID);
+	double cjy = m_network->GetJunctionY(m_currentJID);
 	
 	double disToNextJun = sqrt(pow(cvx-njx, 2) + pow(cvy-njy, 2));
 	double disToCurrJun = sqrt(pow(cvx-cjx, 2) + pow(cvy-cjy, 2));
@@ -827,10 +806,10 @@ RoutingProtocol::SpeedCheckExpire()
 void
 RoutingProtocol::NeiTableCheckExpire(Ipv4Address addr)
 {
-	NeighborTableEntry nentry = m_neiTable[addr];
-	if(nentry.N_time <= Simulator::Now())
+	const NeighborTableEntry *nentry = m_neiTable.Find(addr);
+	if(nentry != 0 && nentry->N_time <= Simulator::Now())
 	{
-		m_neiTable.erase(addr);
+		m_neiTable.Erase(addr);
 	}
 }
 
@@ -851,21 +830,13 @@ RoutingProtocol::SetDownTarget (IpL4Protocol::DownTargetCallback callback)
 Vector
 RoutingProtocol::GetPosition(Ipv4Address adr)
 {
-	uint32_t n = NodeList().GetNNodes ();
-	uint32_t i;
-	Ptr<Node> node;
-
-	for(i = 0; i < n; i++)
+	Ptr<MobilityModel> MM = NodeAddressIndex::GetMobilityModel(adr);
+	if(MM == 0)
 	{
-		node = NodeList().GetNode (i);
-		Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-		if(ipv4->GetAddress (1, 0).GetLocal () == adr)
-		{
-			return (*node->GetObject<MobilityModel>()).GetPosition ();
-		}
+		Vector v;
+		return v;
 	}
-	Vector v;
-	return v;
+	return MM->GetPosition ();
 }
 
 void
@@ -877,10 +848,10 @@ RoutingProtocol::AddHeader (Ptr<Packet> p, Ipv4Address source, Ipv4Address desti
 		Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
         double cx = MM->GetPosition ().x;
         double cy = MM->GetPosition ().y;
-        double cjx = m_map[m_currentJID].x;
-        double cjy = m_map[m_currentJID].y;
-        double njx = m_map[m_nextJID].x;
-        double njy = m_map[m_nextJID].y;
+        double cjx = m_network->GetJunctionX(m_currentJID);
+        double cjy = m_network->GetJunctionY(m_currentJID);
+        double njx = m_network->GetJunctionX(m_nextJID);
+        double njy = m_network->GetJunctionY(m_nextJID);
 
         int nextjid;
         if(pow(cx-cjx, 2) + pow(cy-cjy, 2) < pow(cx-njx, 2) + pow(cy-njy, 2))
@@ -903,19 +874,18 @@ RoutingProtocol::AddHeader (Ptr<Packet> p, Ipv4Address source, Ipv4Address desti
 
 }
 
-bool
-RoutingProtocol::isBetweenSegment(double nx, double ny, int cjid, int djid)
+void
+RoutingProtocol::GetSegmentArea(int cjid, int djid, double &minx, double &miny, double &maxx, double &maxy)
 {
-    bool res = false;
-    double djx = m_map[djid].x;
-    double djy = m_map[djid].y;
-    double cjx = m_map[cjid].x;
-    double cjy = m_map[cjid].y;
-
-    double minx = (cjx < djx ? cjx : djx);
-    double maxx = (cjx > djx ? cjx : djx);
-    double miny = (cjy < djy ? cjy : djy);
-    double maxy = (cjy > djy ? cjy : djy);
+    double djx = m_network->GetJunctionX(djid);
+    double djy = m_network->GetJunctionY(djid);
+    double cjx = m_network->GetJunctionX(cjid);
+    double cjy = m_network->GetJunctionY(cjid);
+
+    minx = (cjx < djx ? cjx : djx);
+    maxx = (cjx > djx ? cjx : djx);
+    miny = (cjy < djy ? cjy : djy);
+    maxy = (cjy > djy ? cjy : djy);
     int dir = GetDirection(cjid, djid);
     if(dir % 2 == 0)
     {
@@ -927,60 +897,103 @@ RoutingProtocol::isBetweenSegment(double nx, double ny, int cjid, int djid)
         minx -= RoadWidth;
         maxx += RoadWidth;
     }
-    
-    if(nx >= minx && nx <= maxx && ny >= miny && ny <= maxy)
-    {
-        res = true;
-    }
+}
 
-    return res;
+bool
+RoutingProtocol::isBetweenSegment(double nx, double ny, int cjid, int djid)
+{
+    double minx, miny, maxx, maxy;
+    GetSegmentArea(cjid, djid, minx, miny, maxx, maxy);
+    return nx >= minx && nx <= maxx && ny >= miny && ny <= maxy;
 }
 
 Ipv4Address
 RoutingProtocol::IntraPathRouting(Ipv4Address dest,  int dstjid)
 {
-	Ipv4Address nextHop = Ipv4Address("127.0.0.1");
-
     if(dstjid < 0)
     {
-        return  nextHop;
+        return  Ipv4Address("127.0.0.1");
     }
+	if(IsInTransRange(dest))
+		return dest;
+	return GetNextHopTowards(dstjid);
+}
+
+bool
+RoutingProtocol::IsInTransRange(Ipv4Address dest)
+{
+	Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
+	Vector pos = MM->GetPosition();
+	Vector dpos = GetPosition(dest);
+	double range = RSSIDistanceThreshold;
+	return range > 0 && (pos.x-dpos.x)*(pos.x-dpos.x) + (pos.y-dpos.y)*(pos.y-dpos.y) < range * range;
+}
+
+Ipv4Address
+RoutingProtocol::GetNextHopTowards(int dstjid)
+{
+	Ipv4Address nextHop = Ipv4Address("127.0.0.1");
+	double range = RSSIDistanceThreshold;
+	double range2 = range * range;
+	if(range <= 0)
+		return nextHop;
 
 	Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
 	double cx = MM->GetPosition().x;
 	double cy = MM->GetPosition().y;
-	
-	double dx = GetPosition(dest).x;
-	double dy = GetPosition(dest).y;
-	double curDisToDst = sqrt(pow(cx-dx, 2) + pow(cy-dy, 2));
-	if(curDisToDst < RSSIDistanceThreshold)
-		return dest;
 
-    double jx = m_map[dstjid].x;
-	double jy = m_map[dstjid].y;
-	double mindis = sqrt(pow(cx-jx, 2) + pow(cy-jy, 2));
+    double jx = m_network->GetJunctionX(dstjid);
+	double jy = m_network->GetJunctionY(dstjid);
+	double mindis2 = (cx-jx)*(cx-jx) + (cy-jy)*(cy-jy);
+	double mindis = sqrt(mindis2);
+
+    //候选邻居必须位于当前车辆的通信范围内，且比当前车辆更靠近目标路口
+	double minx = std::max(cx - range, jx - mindis);
+	double maxx = std::min(cx + range, jx + mindis);
+	double miny = std::max(cy - range, jy - mindis);
+	double maxy = std::min(cy + range, jy + mindis);
+
+    //位于路口范围内时，只考虑当前路口与目标路口之间路段上的邻居，
+    //防止当前车辆将数据包传输给其他路段的节点
+    bool onSegment = m_JunAreaTag;
+    double sminx = 0, sminy = 0, smaxx = 0, smaxy = 0;
+    if(onSegment)
+    {
+        GetSegmentArea(GetNearestJID(), dstjid, sminx, sminy, smaxx, smaxy);
+        minx = std::max(minx, sminx);
+        maxx = std::min(maxx, smaxx);
+        miny = std::max(miny, sminy);
+        maxy = std::min(maxy, smaxy);
+    }
 
-	for (std::map<Ipv4Address, NeighborTableEntry>::const_iterator i = m_neiTable.begin (); i != m_neiTable.end (); i++)
+    m_candidates.clear();
+    m_neiTable.GetCandidates(minx, miny, maxx, maxy, m_candidates);
+
+	for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
 	{
-		if(i->second.N_status == NeighborTableEntry::STATUS_NOT_SYM)
+		if(m_neiTable.IsSymmetric(*i) == false)
 		{
 			continue;
 		}
 
-		double nx = i->second.N_location_x;
-		double ny = i->second.N_location_y;
-		double neiDisToJID = sqrt(pow(nx-jx, 2) + pow(ny-jy, 2));
-		double curDisToNei = sqrt(pow(cx-nx, 2) + pow(cy-ny, 2));
-		if(neiDisToJID < mindis && curDisToNei < RSSIDistanceThreshold)
+		double nx = m_neiTable.GetX(*i);
+		double ny = m_neiTable.GetY(*i);
+		if(onSegment && (nx < sminx || nx > smaxx || ny < sminy || ny > smaxy))
 		{
-            int cjid = GetNearestJID();
-            //此处的条件判断用以防止当前车辆将数据包传输给其他路段的节点，
-            //其他路段的节点同样有可能满足上一个条件判断
-			if(m_JunAreaTag == false || isBetweenSegment(nx, ny, cjid, dstjid) == true)
-            {
-                mindis = neiDisToJID;
-                nextHop = i->first;
-            }
+			continue;
+		}
+		double neiDisToJID = (nx-jx)*(nx-jx) + (ny-jy)*(ny-jy);
+		double curDisToNei = (cx-nx)*(cx-nx) + (cy-ny)*(cy-ny);
+		if(curDisToNei >= range2 || neiDisToJID > mindis2)
+		{
+			continue;
+		}
+        //距离相同时选择地址较小的邻居，与按地址顺序遍历邻居表的结果一致
+		Ipv4Address addr = m_neiTable.Get(*i).N_neighbor_address;
+		if(neiDisToJID < mindis2 || (nextHop != Ipv4Address("127.0.0.1") && addr < nextHop))
+		{
+			mindis2 = neiDisToJID;
+			nextHop = addr;
 		}
 	}
 	
@@ -1000,10 +1013,10 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDe
     Ptr<MobilityModel> MM = m_ipv4->GetObject<MobilityModel> ();
     double cx = MM->GetPosition ().x;
     double cy = MM->GetPosition ().y;
-    double cjx = m_map[m_currentJID].x;
-    double cjy = m_map[m_currentJID].y;
-    double njx = m_map[m_nextJID].x;
-    double njy = m_map[m_nextJID].y;
+    double cjx = m_network->GetJunctionX(m_currentJID);
+    double cjy = m_network->GetJunctionY(m_currentJID);
+    double njx = m_network->GetJunctionX(m_nextJID);
+    double njy = m_network->GetJunctionY(m_nextJID);
 
     int dstjid;
     if(m_JunAreaTag == false)
@@ -1030,7 +1043,7 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDe
     {
         rtentry = Create<Ipv4Route> ();
         rtentry->SetDestination (header.GetDestination ());
-        Ipv4Address receiverIfaceAddr = m_neiTable.find(nextHop)->second.receiverIfaceAddr;
+        Ipv4Address receiverIfaceAddr = m_neiTable.Find(nextHop)->receiverIfaceAddr;
             
         rtentry->SetSource (receiverIfaceAddr);
         rtentry->SetGateway (nextHop);
@@ -1052,60 +1065,6 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDe
 	return rtentry;
 }
 
-int
-RoutingProtocol::DijkstraAlgorithm(int srcjid, int dstjid)
-{
-    bool visited[m_JuncNum];
-    double distance[m_JuncNum];
-    int parent[m_JuncNum];
-
-    for(int i = 0; i<m_JuncNum; i++)
-    {
-        visited[i] = false;
-        distance[i] = INF;
-        parent[i] = -1;
-    }
-
-    visited[srcjid] = true;
-    distance[srcjid] = 0;
-
-    int curr = srcjid;
-    int next = -1;
-    for(int count = 1; curr >= 0 && count <= m_JuncNum; count++)
-    {
-        double min = INF;
-        for(int n = 0; n < m_JuncNum; n++)
-        {
-            if(visited[n] == false)
-            {
-                if(distance[curr] + Graph[curr][n] < distance[n])
-                {
-                    distance[n] = distance[curr] + Graph[curr][n];
-                    parent[n] = curr;
-                }
-
-                if(distance[n] < min)
-                {
-                    min = distance[n];
-                    next = n;
-                }
-            }
-        }
-        curr = next;
-        visited[curr] = true;
-    }
-
-    int jid = dstjid;
-    while(jid > 0)
-    {
-        if(parent[jid] == srcjid)
-            break;
-        jid = parent[jid];
-    }
-
-    return jid; 
-}
-
 int
 RoutingProtocol::GetPacketNextJID(bool tag)
 {
@@ -1114,26 +1073,7 @@ RoutingProtocol::GetPacketNextJID(bool tag)
     if(cjid == m_rsujid)
         return cjid;
 
-    int nextjid = -1;
-
-    for(int i = 0; i < m_JuncNum; i++)
-    {
-        for(int j = i + 1; j < m_JuncNum; j++)
-        {
-            if(isAdjacentVex(i, j) == false)
-            {
-                Graph[i][j] = Graph[j][i] = INF;
-            }
-            else
-            {
-                Graph[i][j] = Graph[j][i] = 1;
-            }
-        }
-    }
-
-    nextjid = DijkstraAlgorithm(cjid, m_rsujid);
-
-    return nextjid;
+    return m_routeTable->GetNextJunction(cjid, m_rsujid);
 }
 
 bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
@@ -1198,10 +1138,9 @@ bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
         {
             rtentry = Create<Ipv4Route> ();
             rtentry->SetDestination (header.GetDestination ());
-            Ipv4Address receiverIfaceAddr = m_neiTable.find(nextHop)->second.receiverIfaceAddr;
-
-            if(nextHop == dest)
-                receiverIfaceAddr = m_mainAddress;
+            Ipv4Address receiverIfaceAddr = m_mainAddress;
+            if(nextHop != dest)
+                receiverIfaceAddr = m_neiTable.Find(nextHop)->receiverIfaceAddr;
 
             rtentry->SetSource (receiverIfaceAddr);
             rtentry->SetGateway (nextHop);
@@ -1244,11 +1183,7 @@ bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
 	{
         //如果返回的IPv4地址为127.0.0.1，则说明当前时刻没有合适的下一跳节点
         //节点启用Carry_and_forward机制，将数据包暂时缓存起来，直到有可用下一跳节点或信息过期为止
-        grp::DataPacketHeader DHeader;
-  		DHeader.SetNextJID(nextjid);	
-        DHeader.SetSenderID(m_id);	
-  		packet->AddHeader(DHeader);		
-
+        //缓存期间不携带DataPacketHeader，发送时再由SendStoredPacket写入
     	QPacketInfo pInfo(origin, dest);		
   		QMap::const_iterator pItr = m_wTimeCache.find(pInfo);		
   		if(pItr == m_wTimeCache.end())		
@@ -1257,7 +1192,7 @@ bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
   			pTime = Simulator::Now();		
   		}		
 
-    	PacketQueueEntry qentry(packet, header, ucb);		
+    	PacketQueueEntry qentry(packet, header, ucb, nextjid);		
   		m_pwaitqueue.push_back(qentry);		
   		m_StorePacketTrace(header);
 	}
@@ -1275,10 +1210,15 @@ RoutingProtocol::NotifyInterfaceDown (uint32_t i)
 void
 RoutingProtocol::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  if (address.GetLocal () != Ipv4Address::GetLoopback ())
+    {
+      NodeAddressIndex::Add (address.GetLocal (), m_ipv4->GetObject<Node> ());
+    }
 }
 void
 RoutingProtocol::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  NodeAddressIndex::Remove (address.GetLocal ());
 }
 
 
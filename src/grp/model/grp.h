@@ -10,6 +10,7 @@
 #include "ns3/event-garbage-collector.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/timer.h"
+#include "ns3/expiry-wheel.h"
 #include "ns3/traced-callback.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -20,11 +21,16 @@
 #include <queue>
 #include "ns3/ip-l4-protocol.h"
 #include "ns3/digitalMap.h"
+#include "ns3/road-network.h"
+#include "ns3/junction-route-table.h"
+#include "ns3/grp-neighbor-table.h"
 #include "ns3/myserver.h"
 
 
 namespace ns3 {
 
+//缓存的数据包不带DataPacketHeader，目标路口保存在m_nextjid中，
+//只在数据包发出时才写入头部，避免每次检查缓存都删除并重新添加头部
 struct PacketQueueEntry
 {
  	typedef Ipv4RoutingProtocol::UnicastForwardCallback UnicastForwardCallback;
@@ -32,12 +38,14 @@ struct PacketQueueEntry
   	Ptr<Packet> m_packet;
  	Ipv4Header m_header;
  	UnicastForwardCallback m_ucb;
+    int m_nextjid;
 
-  	PacketQueueEntry(Ptr<Packet> p, Ipv4Header h, UnicastForwardCallback u)
+  	PacketQueueEntry(Ptr<Packet> p, Ipv4Header h, UnicastForwardCallback u, int nextjid)
  	{
  		this->m_packet = p;
  		this->m_header = h;
  		this->m_ucb = u;
+        this->m_nextjid = nextjid;
  	}
 
 };
@@ -96,57 +104,21 @@ struct QPacketInfo
 
 typedef std::map<QPacketInfo, Time> QMap;
 
-struct SendingQueue
-{
- 	typedef Ipv4RoutingProtocol::UnicastForwardCallback UnicastForwardCallback;
-
-  	Ptr<Packet> m_packet;
- 	Ipv4Header m_header;
- 	UnicastForwardCallback m_ucb;
- 	Ipv4Address nexthop;
-
-  	SendingQueue(Ptr<Packet> p, Ipv4Header h, UnicastForwardCallback u, Ipv4Address nexthop)
- 	{
- 		this->m_packet = p;
- 		this->m_header = h;
- 		this->m_ucb = u;
- 		this->nexthop = nexthop;
-    }
-
-};
 namespace grp {
 
-struct NeighborTableEntry
-{
-    int N_turn;
-    int N_direction;
-    Time N_time;
-    double N_speed;
-    double N_location_x;
-    double N_location_y;
-    uint16_t N_sequenceNum;
-    Ipv4Address receiverIfaceAddr;
-    Ipv4Address N_neighbor_address;
-
-    enum Status
-    {
-        STATUS_NOT_SYM = 0,
-        STATUS_SYM = 1,
-    } N_status;
-
-    NeighborTableEntry () :
-        N_turn (-1), N_speed (0), N_location_x (0), N_location_y (0),
-        N_sequenceNum (0),N_neighbor_address (), N_status (STATUS_NOT_SYM)
-    {
-
-    }
-};
-
 class RoutingProtocol : public Ipv4RoutingProtocol
 {
 public:
     static TypeId GetTypeId (void);
 
+    //HELLO消息的格式
+    enum HelloFormat
+    {
+        HELLO_FULL,          //!< 携带全部邻居地址
+        HELLO_BLOOM,         //!< 紧凑格式，邻居地址压缩为Bloom filter
+        HELLO_POSITION_ONLY, //!< 紧凑格式，不携带邻居摘要，链路均视为对称
+    };
+
     RoutingProtocol ();
     virtual ~RoutingProtocol ();
 
@@ -166,6 +138,7 @@ private:
     Ipv4Address m_mainAddress;
 
     Time m_helloInterval;
+    HelloFormat m_helloFormat;
     Timer m_helloTimer;
     Timer m_positionCheckTimer;
     Timer m_queuedMessagesTimer;
@@ -178,7 +151,11 @@ private:
 
     IpL4Protocol::DownTargetCallback m_downTarget;
     Ptr<UniformRandomVariable> m_uniformRandomVariable;
-    std::map<Ipv4Address, NeighborTableEntry> m_neiTable;
+    NeighborTable m_neiTable;
+    /// 邻居表项的过期时间, 代替每收到一个HELLO就调度一次检查事件
+    ExpiryWheel<Ipv4Address, Ipv4AddressHash> m_neiExpiry;
+    //IntraPathRouting中候选邻居的临时缓存，避免每次路由都重新分配内存
+    std::vector<uint32_t> m_candidates;
     
 
     Ptr<Socket> m_recvSocket;
@@ -195,7 +172,6 @@ private:
 
 /*------------------------------------------------------------------------------------------*/
     //以下参数需要根据实际运行情况调整
-    bool m_jqueuetag[49];
     int m_JuncNum=49;
     int m_rsujid = 45;
     double startTime = 5;
@@ -205,7 +181,6 @@ private:
     double PositionCheckThreshold = 11;
     double RoadWidth = 10;
     double JunAreaRadius = 50;
-    std::string confile = "scratch/conf.txt";
 /*------------------------------------------------------------------------------------------*/
 
 
@@ -216,7 +191,6 @@ private:
     int m_currentJID = -1;
     int m_direction = -1;
     bool m_JunAreaTag = false;
-    float ** Graph;
     double m_speed = 1;
     double RSSIDistanceThreshold = 0;
     double m_last_x = 0, m_last_y = 0;
@@ -226,16 +200,17 @@ private:
     QMap m_wTimeCache;
     std::queue<int> m_jqueue;
     std::queue<int> m_trailTrace;
-    std::vector<VTrace> m_tracelist;
-    std::vector<SendingQueue> m_squeue;
+    //CheckPacketQueue正在处理的缓存数据包
     std::vector<PacketQueueEntry> m_pqueue;		
     std::vector<PacketQueueEntry> m_pwaitqueue;	
     std::vector<DelayPacketQueueEntry> m_delayqueue;	
-    std::vector<DigitalMapEntry> m_map;
+    //所有车辆共享的路网，包括路口、路段和车辆轨迹
+    Ptr<const RoadNetwork> m_network;
+    //路网上预先计算的下一路口表，所有车辆共享
+    Ptr<JunctionRouteTable> m_routeTable;
 
 /*------------------------------------------------------------------------------------------*/
     //从配置文件读取实验运行参数
-    void ReadConfiguration();
 
 /*------------------------------------------------------------------------------------------*/
     //根据车辆的IPv4地址获取其对应的车辆编号m_id
@@ -267,17 +242,19 @@ private:
 
 /*------------------------------------------------------------------------------------------*/
 //路由方法实现，分为路段间路由和路段内路由
-    //路段间路由，为数据包挑选合适的下一个传输路段
+    //路段间路由，为数据包挑选合适的下一个传输路段，查询预先计算的最短路径下一路口表
     int GetPacketNextJID(bool tag);
     //路段内路由，数据包在路段内传播时的路由方法，即如何再路段内挑选数据包的下一跳  
     Ipv4Address IntraPathRouting(Ipv4Address dest, int dstjid);
+    //目的节点是否位于当前车辆的通信范围内
+    bool IsInTransRange(Ipv4Address dest);
+    //在邻居中挑选比当前车辆更靠近目标路口的下一跳，没有时返回127.0.0.1
+    Ipv4Address GetNextHopTowards(int dstjid);
 
-    //路段间路由采用迪杰斯特拉最短路径算法计算最优的下一路由路段
-    int DijkstraAlgorithm(int srcjid, int dstjid);
-    //用以在迪杰斯特拉算法中确定某两个路口是否是相邻
-    bool isAdjacentVex(int sjid, int ejid);
     //用以确认邻居车辆是否位于两个指定路口所形成的矩形区域内
     bool isBetweenSegment(double nx, double ny, int cjid, int djid);
+    //获取两个指定路口所形成的矩形区域
+    void GetSegmentArea(int cjid, int djid, double &minx, double &miny, double &maxx, double &maxy);
 
 /*------------------------------------------------------------------------------------------*/
     //收到控制包时的处理逻辑，控制包包括HelloMessage，即Beacon
@@ -295,8 +272,8 @@ private:
 //数据包的暂缓发送机制
     //在Carry-And-Forward机制中用以检查车辆是否携带有被暂存的数据包
     void CheckPacketQueue();
-    //在Carry-And-Forward机制中用以发送车辆携带的数据包
-    void SendFromSQueue();
+    //在Carry-And-Forward机制中用以发送车辆携带的数据包，写入DataPacketHeader后立即交给IP层
+    void SendStoredPacket(PacketQueueEntry &entry, Ipv4Address nextHop);
     //当发现数据包回传时，即可能出现环时，暂缓一段时间再发送，避免TTL快速消耗
     void SendFromDelayQueue();
 
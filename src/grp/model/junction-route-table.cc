@@ -0,0 +1,332 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "junction-route-table.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("JunctionRouteTable");
+
+/**
+ * \return the shared hop count tables, indexed by their network.  A table
+ *         removes itself from here when its last reference is released.
+ */
+static std::map<const RoadNetwork *, JunctionRouteTable *> &
+GetHopCountTables (void)
+{
+  static std::map<const RoadNetwork *, JunctionRouteTable *> tables;
+  return tables;
+}
+
+Ptr<JunctionRouteTable>
+JunctionRouteTable::GetHopCountTable (Ptr<const RoadNetwork> network)
+{
+  std::map<const RoadNetwork *, JunctionRouteTable *> &tables = GetHopCountTables ();
+  std::map<const RoadNetwork *, JunctionRouteTable *>::const_iterator itr = tables.find (PeekPointer (network));
+  if (itr != tables.end ())
+    {
+      return Ptr<JunctionRouteTable> (itr->second);
+    }
+  Ptr<JunctionRouteTable> table = Create<JunctionRouteTable> (network);
+  table->m_shared = true;
+  tables[PeekPointer (network)] = PeekPointer (table);
+  return table;
+}
+
+JunctionRouteTable::JunctionRouteTable (Ptr<const RoadNetwork> network)
+  : m_network (network),
+    m_shared (false)
+{
+  uint32_t njunctions = m_network->GetNJunctions ();
+  uint32_t nedges = m_network->GetNEdges ();
+  m_weight.assign (nedges, 1);
+  m_edgeSource.resize (nedges);
+  m_inOffset.assign (njunctions + 1, 0);
+  for (uint32_t j = 0; j < njunctions; j++)
+    {
+      for (uint32_t e = m_network->GetEdgeBegin (j); e < m_network->GetEdgeEnd (j); e++)
+        {
+          m_edgeSource[e] = j;
+          m_inOffset[m_network->GetEdgeTarget (e) + 1]++;
+        }
+    }
+  for (uint32_t j = 0; j < njunctions; j++)
+    {
+      m_inOffset[j + 1] += m_inOffset[j];
+    }
+  m_inEdge.resize (nedges);
+  std::vector<uint32_t> fill (m_inOffset.begin (), m_inOffset.end () - 1);
+  for (uint32_t e = 0; e < nedges; e++)
+    {
+      m_inEdge[fill[m_network->GetEdgeTarget (e)]++] = e;
+    }
+}
+
+JunctionRouteTable::~JunctionRouteTable ()
+{
+  if (m_shared)
+    {
+      GetHopCountTables ().erase (PeekPointer (m_network));
+    }
+}
+
+Ptr<const RoadNetwork>
+JunctionRouteTable::GetRoadNetwork (void) const
+{
+  return m_network;
+}
+
+void
+JunctionRouteTable::SetEdgeWeight (uint32_t edge, double weight)
+{
+  NS_LOG_FUNCTION (this << edge << weight);
+  NS_ASSERT_MSG (!m_shared, "The shared hop count table must not be modified");
+  if (m_weight[edge] != weight)
+    {
+      m_changes.insert (std::make_pair (edge, m_weight[edge]));
+      m_weight[edge] = weight;
+    }
+}
+
+double
+JunctionRouteTable::GetEdgeWeight (uint32_t edge) const
+{
+  return m_weight[edge];
+}
+
+void
+JunctionRouteTable::Prepare (const std::vector<int> &destinations)
+{
+  if (destinations.size () == 1)
+    {
+      GetTable (destinations[0]);
+    }
+  else
+    {
+      GetTable (destinations);
+    }
+}
+
+int
+JunctionRouteTable::GetNextJunction (int src, int dst)
+{
+  return GetTable (dst).next[src];
+}
+
+int
+JunctionRouteTable::GetNextJunction (int src, const std::vector<int> &destinations)
+{
+  if (destinations.size () == 1)
+    {
+      return GetTable (destinations[0]).next[src];
+    }
+  return GetTable (destinations).next[src];
+}
+
+double
+JunctionRouteTable::GetDistance (int src, const std::vector<int> &destinations)
+{
+  if (destinations.size () == 1)
+    {
+      return GetTable (destinations[0]).distance[src];
+    }
+  return GetTable (destinations).distance[src];
+}
+
+const JunctionRouteTable::Table &
+JunctionRouteTable::GetTable (int destination)
+{
+  ApplyChanges ();
+  std::map<int, Table>::iterator itr = m_singleTables.find (destination);
+  if (itr == m_singleTables.end ())
+    {
+      itr = m_singleTables.insert (std::make_pair (destination, Table ())).first;
+      Compute (std::vector<int> (1, destination), itr->second);
+    }
+  return itr->second;
+}
+
+const JunctionRouteTable::Table &
+JunctionRouteTable::GetTable (const std::vector<int> &destinations)
+{
+  ApplyChanges ();
+  std::vector<int> key (destinations);
+  std::sort (key.begin (), key.end ());
+  key.erase (std::unique (key.begin (), key.end ()), key.end ());
+  std::map<std::vector<int>, Table>::iterator itr = m_tables.find (key);
+  if (itr == m_tables.end ())
+    {
+      itr = m_tables.insert (std::make_pair (key, Table ())).first;
+      Compute (key, itr->second);
+    }
+  return itr->second;
+}
+
+void
+JunctionRouteTable::Compute (const std::vector<int> &destinations, Table &table) const
+{
+  NS_LOG_FUNCTION (this << destinations.size ());
+  uint32_t njunctions = m_network->GetNJunctions ();
+  table.next.assign (njunctions, -1);
+  table.distance.assign (njunctions, std::numeric_limits<double>::infinity ());
+  table.edge.assign (njunctions, -1);
+
+  Queue queue;
+  for (std::vector<int>::const_iterator d = destinations.begin (); d != destinations.end (); d++)
+    {
+      table.next[*d] = *d;
+      table.distance[*d] = 0;
+      queue.push (QueueEntry (0, *d));
+    }
+  Propagate (queue, table);
+}
+
+void
+JunctionRouteTable::Propagate (Queue &queue, Table &table) const
+{
+  // Dijkstra over the reversed edges: the next junction of the source of
+  // an edge is the junction the edge leads to.
+  while (!queue.empty ())
+    {
+      QueueEntry top = queue.top ();
+      queue.pop ();
+      uint32_t curr = top.second;
+      if (top.first > table.distance[curr])
+        {
+          continue;
+        }
+      for (uint32_t i = m_inOffset[curr]; i < m_inOffset[curr + 1]; i++)
+        {
+          uint32_t e = m_inEdge[i];
+          if (m_weight[e] < 0)
+            {
+              continue;
+            }
+          uint32_t src = m_edgeSource[e];
+          double distance = top.first + m_weight[e];
+          if (distance < table.distance[src])
+            {
+              table.distance[src] = distance;
+              table.next[src] = curr;
+              table.edge[src] = e;
+              queue.push (QueueEntry (distance, src));
+            }
+        }
+    }
+}
+
+void
+JunctionRouteTable::ApplyChanges (void)
+{
+  if (m_changes.empty ())
+    {
+      return;
+    }
+  for (std::map<int, Table>::iterator itr = m_singleTables.begin (); itr != m_singleTables.end (); itr++)
+    {
+      Update (itr->second);
+    }
+  for (std::map<std::vector<int>, Table>::iterator itr = m_tables.begin (); itr != m_tables.end (); itr++)
+    {
+      Update (itr->second);
+    }
+  m_changes.clear ();
+}
+
+void
+JunctionRouteTable::Update (Table &table) const
+{
+  NS_LOG_FUNCTION (this << m_changes.size ());
+  uint32_t njunctions = m_network->GetNJunctions ();
+  double infinity = std::numeric_limits<double>::infinity ();
+
+  // The junctions whose path used an edge that became more expensive or
+  // was disabled, and every junction whose path goes through them.
+  std::vector<uint8_t> isAffected (njunctions, 0);
+  std::vector<uint32_t> affected;
+  for (std::map<uint32_t, double>::const_iterator c = m_changes.begin (); c != m_changes.end (); c++)
+    {
+      double weight = m_weight[c->first];
+      uint32_t src = m_edgeSource[c->first];
+      bool increased = weight < 0 || (c->second >= 0 && weight > c->second);
+      if (increased && table.edge[src] == (int) c->first && !isAffected[src])
+        {
+          isAffected[src] = 1;
+          affected.push_back (src);
+        }
+    }
+  for (uint32_t k = 0; k < affected.size (); k++)
+    {
+      uint32_t curr = affected[k];
+      for (uint32_t i = m_inOffset[curr]; i < m_inOffset[curr + 1]; i++)
+        {
+          uint32_t e = m_inEdge[i];
+          uint32_t src = m_edgeSource[e];
+          if (table.edge[src] == (int) e && !isAffected[src])
+            {
+              isAffected[src] = 1;
+              affected.push_back (src);
+            }
+        }
+    }
+
+  // Restart the affected junctions from their best unaffected neighbor.
+  Queue queue;
+  for (std::vector<uint32_t>::const_iterator a = affected.begin (); a != affected.end (); a++)
+    {
+      table.next[*a] = -1;
+      table.distance[*a] = infinity;
+      table.edge[*a] = -1;
+    }
+  for (std::vector<uint32_t>::const_iterator a = affected.begin (); a != affected.end (); a++)
+    {
+      for (uint32_t e = m_network->GetEdgeBegin (*a); e < m_network->GetEdgeEnd (*a); e++)
+        {
+          uint32_t dst = m_network->GetEdgeTarget (e);
+          if (m_weight[e] < 0 || isAffected[dst])
+            {
+              continue;
+            }
+          double distance = table.distance[dst] + m_weight[e];
+          if (distance < table.distance[*a])
+            {
+              table.distance[*a] = distance;
+              table.next[*a] = dst;
+              table.edge[*a] = e;
+            }
+        }
+      if (table.distance[*a] < infinity)
+        {
+          queue.push (QueueEntry (table.distance[*a], *a));
+        }
+    }
+
+  // The edges that became cheaper may shorten the path of their source.
+  for (std::map<uint32_t, double>::const_iterator c = m_changes.begin (); c != m_changes.end (); c++)
+    {
+      double weight = m_weight[c->first];
+      if (weight < 0 || (c->second >= 0 && weight >= c->second))
+        {
+          continue;
+        }
+      uint32_t src = m_edgeSource[c->first];
+      uint32_t dst = m_network->GetEdgeTarget (c->first);
+      double distance = table.distance[dst] + weight;
+      if (distance < table.distance[src])
+        {
+          table.distance[src] = distance;
+          table.next[src] = dst;
+          table.edge[src] = c->first;
+          queue.push (QueueEntry (distance, src));
+        }
+    }
+
+  Propagate (queue, table);
+}
+
+}
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef JUNCTION_ROUTE_TABLE_H
+#define JUNCTION_ROUTE_TABLE_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <queue>
+#include <functional>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/road-network.h"
+
+namespace ns3 {
+
+/**
+ * \brief Next-junction tables over a RoadNetwork.
+ *
+ * For a set of destination junctions (a single RSU junction or a whole
+ * RSU set) the table stores, for every junction of the network, the next
+ * junction on a shortest path towards the nearest destination.  A table is
+ * computed once, on first use or by Prepare, with a single Dijkstra run
+ * over the reversed edges; afterwards every lookup is O(1).  When edge
+ * weights change, the cached tables are repaired on the next lookup: only
+ * the junctions whose shortest path used an edge that became more
+ * expensive, or that can benefit from an edge that became cheaper, are
+ * visited again.
+ */
+class JunctionRouteTable : public SimpleRefCount<JunctionRouteTable>
+{
+public:
+  /**
+   * Get the table with unit edge weights (hop count) for the given network.
+   * The table is shared by every caller using the same network, hence its
+   * weights must not be modified.
+   *
+   * \param network the road network
+   * \return the shared hop count table
+   */
+  static Ptr<JunctionRouteTable> GetHopCountTable (Ptr<const RoadNetwork> network);
+
+  /**
+   * Create a private table with unit edge weights.
+   *
+   * \param network the road network
+   */
+  JunctionRouteTable (Ptr<const RoadNetwork> network);
+  ~JunctionRouteTable ();
+
+  Ptr<const RoadNetwork> GetRoadNetwork (void) const;
+
+  /**
+   * \param edge the index of the edge in the road network
+   * \param weight the new weight, a negative value disables the edge
+   *
+   * The cached tables are updated on the next lookup, so a batch of
+   * changes is applied at once.
+   */
+  void SetEdgeWeight (uint32_t edge, double weight);
+  double GetEdgeWeight (uint32_t edge) const;
+
+  /**
+   * Compute the table towards the given destinations now rather than on
+   * the first lookup.
+   *
+   * \param destinations the destination junctions
+   */
+  void Prepare (const std::vector<int> &destinations);
+
+  /**
+   * \param src the current junction
+   * \param dst the destination junction
+   * \return the junction following \p src on a shortest path to \p dst,
+   *         \p src itself if it is the destination and -1 if \p dst cannot
+   *         be reached
+   */
+  int GetNextJunction (int src, int dst);
+
+  /**
+   * \param src the current junction
+   * \param destinations the destination junctions
+   * \return the junction following \p src on a shortest path to the
+   *         nearest destination, \p src itself if it is a destination and -1
+   *         if no destination can be reached
+   */
+  int GetNextJunction (int src, const std::vector<int> &destinations);
+
+  /**
+   * \param src the current junction
+   * \param destinations the destination junctions
+   * \return the length of the shortest path from \p src to the nearest
+   *         destination, infinity if no destination can be reached
+   */
+  double GetDistance (int src, const std::vector<int> &destinations);
+
+private:
+  JunctionRouteTable (const JunctionRouteTable &);
+  JunctionRouteTable &operator = (const JunctionRouteTable &);
+
+  /// Shortest path tree towards a destination set.
+  struct Table
+  {
+    std::vector<int> next;
+    std::vector<double> distance;
+    /// the edge towards next, -1 for the destinations and the unreachable
+    std::vector<int> edge;
+  };
+  typedef std::pair<double, uint32_t> QueueEntry;
+  typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > Queue;
+
+  const Table &GetTable (int destination);
+  const Table &GetTable (const std::vector<int> &destinations);
+  void Compute (const std::vector<int> &destinations, Table &table) const;
+  /// Apply the pending weight changes to every cached table.
+  void ApplyChanges (void);
+  void Update (Table &table) const;
+  /// Dijkstra from the junctions in the queue over the reversed edges.
+  void Propagate (Queue &queue, Table &table) const;
+
+  Ptr<const RoadNetwork> m_network;
+  /// true if this is the shared hop count table of m_network
+  bool m_shared;
+  std::vector<double> m_weight;
+  /// source junction of every edge
+  std::vector<uint32_t> m_edgeSource;
+  /// incoming edges of every junction, in CSR form
+  std::vector<uint32_t> m_inOffset;
+  std::vector<uint32_t> m_inEdge;
+  /// weight of the changed edges before their first change since the last
+  /// lookup
+  std::map<uint32_t, double> m_changes;
+  /// tables towards a single junction
+  std::map<int, Table> m_singleTables;
+  /// tables indexed by their sorted destination set
+  std::map<std::vector<int>, Table> m_tables;
+};
+
+}
+
+#endif /* JUNCTION_ROUTE_TABLE_H */
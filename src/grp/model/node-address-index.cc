@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "node-address-index.h"
+#include "ns3/log.h"
+#include <unordered_map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NodeAddressIndex");
+
+namespace {
+
+struct IndexEntry
+{
+  Ptr<Node> node;
+  /// resolved on first use, the mobility may be aggregated after the address
+  Ptr<MobilityModel> mobility;
+};
+
+typedef std::unordered_map<uint32_t, IndexEntry> AddressMap;
+
+AddressMap &
+GetAddressMap (void)
+{
+  static AddressMap addresses;
+  return addresses;
+}
+
+} // anonymous namespace
+
+void
+NodeAddressIndex::Add (Ipv4Address address, Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (address << node);
+  IndexEntry &entry = GetAddressMap ()[address.Get ()];
+  entry.node = node;
+  entry.mobility = 0;
+}
+
+void
+NodeAddressIndex::Remove (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (address);
+  GetAddressMap ().erase (address.Get ());
+}
+
+void
+NodeAddressIndex::Remove (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (node);
+  AddressMap &addresses = GetAddressMap ();
+  for (AddressMap::iterator i = addresses.begin (); i != addresses.end (); )
+    {
+      if (i->second.node == node)
+        {
+          i = addresses.erase (i);
+        }
+      else
+        {
+          i++;
+        }
+    }
+}
+
+Ptr<Node>
+NodeAddressIndex::GetNode (Ipv4Address address)
+{
+  AddressMap &addresses = GetAddressMap ();
+  AddressMap::const_iterator i = addresses.find (address.Get ());
+  if (i == addresses.end ())
+    {
+      return 0;
+    }
+  return i->second.node;
+}
+
+Ptr<MobilityModel>
+NodeAddressIndex::GetMobilityModel (Ipv4Address address)
+{
+  AddressMap &addresses = GetAddressMap ();
+  AddressMap::iterator i = addresses.find (address.Get ());
+  if (i == addresses.end ())
+    {
+      return 0;
+    }
+  if (i->second.mobility == 0)
+    {
+      i->second.mobility = i->second.node->GetObject<MobilityModel> ();
+    }
+  return i->second.mobility;
+}
+
+int32_t
+NodeAddressIndex::GetNodeId (Ipv4Address address)
+{
+  Ptr<Node> node = GetNode (address);
+  if (node == 0)
+    {
+      return -1;
+    }
+  return node->GetId ();
+}
+
+}
@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef NODE_ADDRESS_INDEX_H
+#define NODE_ADDRESS_INDEX_H
+
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief Process-wide index from IPv4 addresses to nodes and their mobility.
+ *
+ * The routing protocols register the addresses of their node when the
+ * addresses are added to an interface and unregister them when they are
+ * removed or when the protocol is disposed.  Any code that needs the
+ * position or the id of the node owning an address (grp destination
+ * lookups, myserver, simulation scripts) then finds it in O(1) instead
+ * of walking the NodeList and calling GetObject<Ipv4> on every node.
+ */
+class NodeAddressIndex
+{
+public:
+  /**
+   * \param address the address
+   * \param node the node owning the address
+   */
+  static void Add (Ipv4Address address, Ptr<Node> node);
+  /**
+   * \param address the address to forget
+   */
+  static void Remove (Ipv4Address address);
+  /**
+   * Forget every address of a node.
+   *
+   * \param node the node
+   */
+  static void Remove (Ptr<Node> node);
+
+  /**
+   * \param address the address
+   * \return the node owning the address, or 0 if it is unknown
+   */
+  static Ptr<Node> GetNode (Ipv4Address address);
+  /**
+   * \param address the address
+   * \return the mobility model of the node owning the address, or 0 if the
+   *         address is unknown or the node has no mobility model
+   */
+  static Ptr<MobilityModel> GetMobilityModel (Ipv4Address address);
+  /**
+   * \param address the address
+   * \return the id of the node owning the address, or -1 if it is unknown
+   */
+  static int32_t GetNodeId (Ipv4Address address);
+};
+
+}
+
+#endif /* NODE_ADDRESS_INDEX_H */
@@ -0,0 +1,449 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "road-network.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <map>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RoadNetwork");
+
+/**
+ * \return the networks currently loaded, indexed by their files.  A
+ *         network removes itself from here when its last reference is
+ *         released.
+ */
+static std::map<std::string, RoadNetwork *> &
+GetLoadedNetworks (void)
+{
+  static std::map<std::string, RoadNetwork *> networks;
+  return networks;
+}
+
+/// "GRNB" in the byte order of the writer
+static const uint32_t ROAD_NETWORK_MAGIC = 0x424e5247;
+static const uint32_t ROAD_NETWORK_VERSION = 1;
+static const uint32_t ROAD_NETWORK_HEADER_WORDS = 8;
+
+Ptr<const RoadNetwork>
+RoadNetwork::Load (std::string mapFile, std::string traceFile)
+{
+  NS_LOG_FUNCTION (mapFile << traceFile);
+  std::string key = mapFile + '\n' + traceFile;
+  std::map<std::string, RoadNetwork *> &networks = GetLoadedNetworks ();
+  std::map<std::string, RoadNetwork *>::const_iterator itr = networks.find (key);
+  if (itr != networks.end ())
+    {
+      return Ptr<const RoadNetwork> (itr->second);
+    }
+
+  std::vector<DigitalMapEntry> map;
+  std::vector<VTrace> traces;
+  DigitalMap reader;
+  reader.setMapFilePath (mapFile);
+  reader.readMapFromCsv (map);
+  reader.readTraceCsv (traceFile, traces);
+
+  Ptr<RoadNetwork> network = Create<RoadNetwork> (map, traces);
+  network->m_key = key;
+  networks[key] = PeekPointer (network);
+  NS_LOG_DEBUG ("Loaded road network with " << network->GetNJunctions ()
+                << " junctions, " << network->GetNEdges () << " edges and "
+                << network->GetNTraces () << " traces");
+  return network;
+}
+
+Ptr<const RoadNetwork>
+RoadNetwork::Load (std::string compiledFile)
+{
+  NS_LOG_FUNCTION (compiledFile);
+  std::map<std::string, RoadNetwork *> &networks = GetLoadedNetworks ();
+  std::map<std::string, RoadNetwork *>::const_iterator itr = networks.find (compiledFile);
+  if (itr != networks.end ())
+    {
+      return Ptr<const RoadNetwork> (itr->second);
+    }
+
+  Ptr<RoadNetwork> network = Map (compiledFile);
+  if (network == 0)
+    {
+      NS_FATAL_ERROR ("Cannot load the compiled road network " << compiledFile);
+    }
+  network->m_key = compiledFile;
+  networks[compiledFile] = PeekPointer (network);
+  NS_LOG_DEBUG ("Mapped road network with " << network->GetNJunctions ()
+                << " junctions, " << network->GetNEdges () << " edges and "
+                << network->GetNTraces () << " traces");
+  return network;
+}
+
+bool
+RoadNetwork::IsCompiled (std::string path)
+{
+  std::ifstream file (path.c_str (), std::ios::binary);
+  uint32_t header[2];
+  if (!file.read (reinterpret_cast<char *> (header), sizeof (header)))
+    {
+      return false;
+    }
+  return header[0] == ROAD_NETWORK_MAGIC && header[1] == ROAD_NETWORK_VERSION;
+}
+
+Ptr<RoadNetwork>
+RoadNetwork::Map (std::string path)
+{
+  int fd = open (path.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Cannot open " << path);
+      return 0;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size == 0)
+    {
+      close (fd);
+      return 0;
+    }
+  void *mapping = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Cannot map " << path);
+      return 0;
+    }
+
+  Ptr<RoadNetwork> network = Ptr<RoadNetwork> (new RoadNetwork (), false);
+  network->m_mapping = mapping;
+  network->m_mappingSize = st.st_size;
+  if (!network->SetImage (static_cast<const char *> (mapping), st.st_size))
+    {
+      NS_LOG_WARN (path << " is not a valid compiled road network");
+      return 0;
+    }
+  return network;
+}
+
+namespace {
+
+/**
+ * Append 32 bit words to an image.
+ */
+class ImageWriter
+{
+public:
+  ImageWriter (std::vector<char> &image)
+    : m_image (image),
+      m_pos (0)
+  {
+  }
+  void WriteU32 (uint32_t v)
+  {
+    std::memcpy (&m_image[m_pos], &v, 4);
+    m_pos += 4;
+  }
+  void WriteFloat (float v)
+  {
+    std::memcpy (&m_image[m_pos], &v, 4);
+    m_pos += 4;
+  }
+  uint64_t GetPosition (void) const
+  {
+    return m_pos;
+  }
+
+private:
+  std::vector<char> &m_image;
+  uint64_t m_pos;
+};
+
+} // anonymous namespace
+
+RoadNetwork::RoadNetwork ()
+  : m_mapping (0),
+    m_mappingSize (0),
+    m_image (0),
+    m_imageSize (0)
+{
+}
+
+RoadNetwork::RoadNetwork (const std::vector<DigitalMapEntry> &map,
+                          const std::vector<VTrace> &traces)
+  : m_mapping (0),
+    m_mappingSize (0),
+    m_image (0),
+    m_imageSize (0)
+{
+  uint64_t nedges = 0;
+  for (std::vector<DigitalMapEntry>::const_iterator i = map.begin (); i != map.end (); i++)
+    {
+      nedges += i->outedge.size ();
+    }
+  uint64_t ntraces = 0;
+  uint64_t ntraceJunctions = 0;
+  for (std::vector<VTrace>::const_iterator t = traces.begin (); t != traces.end (); t++)
+    {
+      // a trace without junctions cannot be followed
+      if (!t->jlist.empty ())
+        {
+          ntraces++;
+          ntraceJunctions += t->jlist.size ();
+        }
+    }
+
+  uint64_t words = ROAD_NETWORK_HEADER_WORDS + 3 * map.size () + 1 + 3 * nedges
+    + 3 * ntraces + 1 + ntraceJunctions;
+  m_ownedImage.resize (words * 4);
+  ImageWriter writer (m_ownedImage);
+  writer.WriteU32 (ROAD_NETWORK_MAGIC);
+  writer.WriteU32 (ROAD_NETWORK_VERSION);
+  writer.WriteU32 (map.size ());
+  writer.WriteU32 (nedges);
+  writer.WriteU32 (ntraces);
+  writer.WriteU32 (ntraceJunctions);
+  writer.WriteU32 (0);
+  writer.WriteU32 (0);
+
+  for (std::vector<DigitalMapEntry>::const_iterator i = map.begin (); i != map.end (); i++)
+    {
+      writer.WriteFloat (i->x);
+    }
+  for (std::vector<DigitalMapEntry>::const_iterator i = map.begin (); i != map.end (); i++)
+    {
+      writer.WriteFloat (i->y);
+    }
+  uint32_t offset = 0;
+  writer.WriteU32 (offset);
+  for (std::vector<DigitalMapEntry>::const_iterator i = map.begin (); i != map.end (); i++)
+    {
+      offset += i->outedge.size ();
+      writer.WriteU32 (offset);
+    }
+  typedef std::map<int, std::vector<float> >::const_iterator EdgeIterator;
+  for (std::vector<DigitalMapEntry>::const_iterator i = map.begin (); i != map.end (); i++)
+    {
+      for (EdgeIterator e = i->outedge.begin (); e != i->outedge.end (); e++)
+        {
+          writer.WriteU32 (e->first);
+        }
+    }
+  for (std::vector<DigitalMapEntry>::const_iterator i = map.begin (); i != map.end (); i++)
+    {
+      for (EdgeIterator e = i->outedge.begin (); e != i->outedge.end (); e++)
+        {
+          writer.WriteFloat (e->second[0]);
+        }
+    }
+  for (std::vector<DigitalMapEntry>::const_iterator i = map.begin (); i != map.end (); i++)
+    {
+      for (EdgeIterator e = i->outedge.begin (); e != i->outedge.end (); e++)
+        {
+          writer.WriteFloat (e->second[1]);
+        }
+    }
+
+  for (std::vector<VTrace>::const_iterator t = traces.begin (); t != traces.end (); t++)
+    {
+      if (!t->jlist.empty ())
+        {
+          writer.WriteFloat (t->x);
+        }
+    }
+  for (std::vector<VTrace>::const_iterator t = traces.begin (); t != traces.end (); t++)
+    {
+      if (!t->jlist.empty ())
+        {
+          writer.WriteFloat (t->y);
+        }
+    }
+  offset = 0;
+  writer.WriteU32 (offset);
+  for (std::vector<VTrace>::const_iterator t = traces.begin (); t != traces.end (); t++)
+    {
+      if (!t->jlist.empty ())
+        {
+          offset += t->jlist.size ();
+          writer.WriteU32 (offset);
+        }
+    }
+  for (std::vector<VTrace>::const_iterator t = traces.begin (); t != traces.end (); t++)
+    {
+      for (std::vector<int>::const_iterator j = t->jlist.begin (); j != t->jlist.end (); j++)
+        {
+          writer.WriteU32 (*j);
+        }
+    }
+  NS_ASSERT (writer.GetPosition () == m_ownedImage.size ());
+
+  bool valid = SetImage (&m_ownedImage[0], m_ownedImage.size ());
+  NS_ABORT_MSG_UNLESS (valid, "The road network refers to a junction that does not exist");
+}
+
+RoadNetwork::~RoadNetwork ()
+{
+  if (!m_key.empty ())
+    {
+      GetLoadedNetworks ().erase (m_key);
+    }
+  if (m_mapping != 0)
+    {
+      munmap (m_mapping, m_mappingSize);
+    }
+}
+
+bool
+RoadNetwork::SetImage (const char *image, uint64_t size)
+{
+  if (size < ROAD_NETWORK_HEADER_WORDS * 4)
+    {
+      return false;
+    }
+  const uint32_t *header = reinterpret_cast<const uint32_t *> (image);
+  if (header[0] != ROAD_NETWORK_MAGIC || header[1] != ROAD_NETWORK_VERSION)
+    {
+      return false;
+    }
+  m_nJunctions = header[2];
+  m_nEdges = header[3];
+  m_nTraces = header[4];
+  m_nTraceJunctions = header[5];
+  uint64_t words = ROAD_NETWORK_HEADER_WORDS + 3 * (uint64_t) m_nJunctions + 1 + 3 * (uint64_t) m_nEdges
+    + 3 * (uint64_t) m_nTraces + 1 + m_nTraceJunctions;
+  if (size != words * 4)
+    {
+      return false;
+    }
+
+  const uint32_t *word = header + ROAD_NETWORK_HEADER_WORDS;
+  m_junctionX = reinterpret_cast<const float *> (word);
+  word += m_nJunctions;
+  m_junctionY = reinterpret_cast<const float *> (word);
+  word += m_nJunctions;
+  m_edgeOffset = word;
+  word += m_nJunctions + 1;
+  m_edgeTarget = word;
+  word += m_nEdges;
+  m_edgeAngle = reinterpret_cast<const float *> (word);
+  word += m_nEdges;
+  m_edgeLength = reinterpret_cast<const float *> (word);
+  word += m_nEdges;
+  m_traceX = reinterpret_cast<const float *> (word);
+  word += m_nTraces;
+  m_traceY = reinterpret_cast<const float *> (word);
+  word += m_nTraces;
+  m_traceOffset = word;
+  word += m_nTraces + 1;
+  m_traceJunction = reinterpret_cast<const int32_t *> (word);
+
+  // the lookups do not check their indices, the image must be consistent
+  if (m_edgeOffset[0] != 0 || m_edgeOffset[m_nJunctions] != m_nEdges
+      || m_traceOffset[0] != 0 || m_traceOffset[m_nTraces] != m_nTraceJunctions)
+    {
+      return false;
+    }
+  for (uint32_t j = 0; j < m_nJunctions; j++)
+    {
+      if (m_edgeOffset[j] > m_edgeOffset[j + 1])
+        {
+          return false;
+        }
+    }
+  for (uint32_t e = 0; e < m_nEdges; e++)
+    {
+      if (m_edgeTarget[e] >= m_nJunctions)
+        {
+          return false;
+        }
+    }
+  for (uint32_t t = 0; t < m_nTraces; t++)
+    {
+      if (m_traceOffset[t] > m_traceOffset[t + 1])
+        {
+          return false;
+        }
+    }
+  for (uint32_t k = 0; k < m_nTraceJunctions; k++)
+    {
+      if (m_traceJunction[k] < 0 || (uint32_t) m_traceJunction[k] >= m_nJunctions)
+        {
+          return false;
+        }
+    }
+
+  m_image = image;
+  m_imageSize = size;
+  return true;
+}
+
+bool
+RoadNetwork::Save (std::string path) const
+{
+  NS_LOG_FUNCTION (this << path);
+  std::ofstream file (path.c_str (), std::ios::binary | std::ios::trunc);
+  file.write (m_image, m_imageSize);
+  return bool (file);
+}
+
+bool
+RoadNetwork::IsAdjacent (uint32_t from, uint32_t to) const
+{
+  return FindEdge (from, to) >= 0;
+}
+
+int
+RoadNetwork::FindEdge (uint32_t from, uint32_t to) const
+{
+  for (uint32_t e = m_edgeOffset[from]; e < m_edgeOffset[from + 1]; e++)
+    {
+      if (m_edgeTarget[e] == to)
+        {
+          return e;
+        }
+    }
+  return -1;
+}
+
+int
+RoadNetwork::GetDirection (uint32_t from, uint32_t to) const
+{
+  float cx = m_junctionX[from];
+  float cy = m_junctionY[from];
+  float nx = m_junctionX[to];
+  float ny = m_junctionY[to];
+
+  if (ny == cy)
+    {
+      return nx > cx ? 0 : 2;
+    }
+  else
+    {
+      return ny > cy ? 1 : 3;
+    }
+}
+
+int
+RoadNetwork::GetNearestTrace (double x, double y) const
+{
+  int idx = -1;
+  double min = 0;
+  for (uint32_t i = 0; i < m_nTraces; i++)
+    {
+      double dx = x - m_traceX[i];
+      double dy = y - m_traceY[i];
+      double dis = dx * dx + dy * dy;
+      if (idx < 0 || dis < min)
+        {
+          min = dis;
+          idx = i;
+        }
+    }
+  return idx;
+}
+
+}
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ROAD_NETWORK_H
+#define ROAD_NETWORK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/digitalMap.h"
+
+namespace ns3 {
+
+/**
+ * \brief Immutable road network shared by every vehicle and the controller.
+ *
+ * The junctions, the out-going edges of every junction and the vehicle
+ * trace junction lists are stored as flat CSR (compressed sparse row)
+ * arrays.  A network is loaded once per (map file, trace file) pair by
+ * RoadNetwork::Load; further calls return the same reference-counted
+ * instance, so memory and start-up time scale with the size of the map
+ * rather than with the number of vehicles.
+ *
+ * All the arrays live in one contiguous image of 32 bit words, which Save
+ * writes as is.  Loading such a compiled file maps it in memory and only
+ * checks the array bounds, without parsing anything.  The image is:
+ *
+ * - a header of 8 words: the magic number, the format version, the number
+ *   of junctions, of edges, of traces and of trace junctions, and two
+ *   reserved words;
+ * - junction x[n], junction y[n], edge offset[n+1];
+ * - edge target[e], edge angle[e], edge length[e];
+ * - trace x[t], trace y[t], trace offset[t+1], trace junction[k].
+ *
+ * Numbers are stored in the byte order of the machine that compiled the
+ * file; a file with the wrong byte order is rejected.
+ */
+class RoadNetwork : public SimpleRefCount<RoadNetwork>
+{
+public:
+  /**
+   * Get the network described by the given files, parsing them only if no
+   * other user currently holds a reference to the same network.
+   *
+   * \param mapFile the junction/edge CSV file (see DigitalMap::readMapFromCsv)
+   * \param traceFile the vehicle trace CSV file (see DigitalMap::readTraceCsv)
+   * \return the shared network
+   */
+  static Ptr<const RoadNetwork> Load (std::string mapFile, std::string traceFile);
+  /**
+   * Get the network stored in a compiled file, mapping it in memory only if
+   * no other user currently holds a reference to the same network.
+   *
+   * \param compiledFile a file written by Save
+   * \return the shared network
+   */
+  static Ptr<const RoadNetwork> Load (std::string compiledFile);
+  /**
+   * \param path a file name
+   * \return true if the file starts like a compiled network
+   */
+  static bool IsCompiled (std::string path);
+
+  /**
+   * Write the compiled image of this network.
+   *
+   * \param path the output file name
+   * \return true on success
+   */
+  bool Save (std::string path) const;
+
+  /**
+   * Build a network from already parsed entries.  The result is not
+   * registered in the process-wide cache.
+   *
+   * \param map the junction entries, indexed by junction id
+   * \param traces the vehicle traces
+   */
+  RoadNetwork (const std::vector<DigitalMapEntry> &map,
+               const std::vector<VTrace> &traces);
+  ~RoadNetwork ();
+
+  uint32_t GetNJunctions (void) const
+  {
+    return m_nJunctions;
+  }
+  float GetJunctionX (uint32_t jid) const
+  {
+    return m_junctionX[jid];
+  }
+  float GetJunctionY (uint32_t jid) const
+  {
+    return m_junctionY[jid];
+  }
+
+  /**
+   * The out-going edges of junction jid are the edge indices in
+   * [GetEdgeBegin (jid), GetEdgeEnd (jid)), sorted by target junction.
+   */
+  uint32_t GetEdgeBegin (uint32_t jid) const
+  {
+    return m_edgeOffset[jid];
+  }
+  uint32_t GetEdgeEnd (uint32_t jid) const
+  {
+    return m_edgeOffset[jid + 1];
+  }
+  uint32_t GetNEdges (void) const
+  {
+    return m_nEdges;
+  }
+  uint32_t GetEdgeTarget (uint32_t edge) const
+  {
+    return m_edgeTarget[edge];
+  }
+  float GetEdgeAngle (uint32_t edge) const
+  {
+    return m_edgeAngle[edge];
+  }
+  float GetEdgeLength (uint32_t edge) const
+  {
+    return m_edgeLength[edge];
+  }
+
+  /**
+   * \param from the start junction
+   * \param to the end junction
+   * \return true if the map has an edge from \p from to \p to
+   */
+  bool IsAdjacent (uint32_t from, uint32_t to) const;
+  /**
+   * \param from the start junction
+   * \param to the end junction
+   * \return the index of the edge from \p from to \p to, or -1 if there
+   *         is none
+   */
+  int FindEdge (uint32_t from, uint32_t to) const;
+
+  /**
+   * \param from the start junction
+   * \param to the end junction
+   * \return the direction of the road from \p from to \p to, 0,1,2,3 for
+   *         east, north, west and south respectively
+   */
+  int GetDirection (uint32_t from, uint32_t to) const;
+
+  uint32_t GetNTraces (void) const
+  {
+    return m_nTraces;
+  }
+  float GetTraceX (uint32_t trace) const
+  {
+    return m_traceX[trace];
+  }
+  float GetTraceY (uint32_t trace) const
+  {
+    return m_traceY[trace];
+  }
+
+  /**
+   * The junctions visited by a trace are GetTraceJunction (k) for k in
+   * [GetTraceBegin (trace), GetTraceEnd (trace)).
+   */
+  uint32_t GetTraceBegin (uint32_t trace) const
+  {
+    return m_traceOffset[trace];
+  }
+  uint32_t GetTraceEnd (uint32_t trace) const
+  {
+    return m_traceOffset[trace + 1];
+  }
+  int GetTraceJunction (uint32_t k) const
+  {
+    return m_traceJunction[k];
+  }
+
+  /**
+   * \param x the x coordinate of a vehicle
+   * \param y the y coordinate of a vehicle
+   * \return the index of the trace whose start point is the closest to
+   *         (x,y), or -1 if there are no traces
+   */
+  int GetNearestTrace (double x, double y) const;
+
+private:
+  RoadNetwork ();
+  RoadNetwork (const RoadNetwork &);
+  RoadNetwork &operator = (const RoadNetwork &);
+
+  /**
+   * Point the arrays into an image and check it.
+   *
+   * \param image the image
+   * \param size the size of the image in bytes
+   * \return false if the image is not a valid network
+   */
+  bool SetImage (const char *image, uint64_t size);
+  /**
+   * \param path a compiled file
+   * \return the network, or 0 if the file cannot be mapped or is invalid
+   */
+  static Ptr<RoadNetwork> Map (std::string path);
+
+  /// key of this network in the process-wide cache, empty if not cached
+  std::string m_key;
+
+  /// the image built from parsed entries
+  std::vector<char> m_ownedImage;
+  /// the image mapped from a compiled file
+  void *m_mapping;
+  uint64_t m_mappingSize;
+
+  const char *m_image;
+  uint64_t m_imageSize;
+
+  uint32_t m_nJunctions;
+  uint32_t m_nEdges;
+  uint32_t m_nTraces;
+  uint32_t m_nTraceJunctions;
+
+  const float *m_junctionX;
+  const float *m_junctionY;
+
+  const uint32_t *m_edgeOffset;
+  const uint32_t *m_edgeTarget;
+  const float *m_edgeAngle;
+  const float *m_edgeLength;
+
+  const float *m_traceX;
+  const float *m_traceY;
+  const uint32_t *m_traceOffset;
+  const int32_t *m_traceJunction;
+};
+
+}
+
+#endif /* ROAD_NETWORK_H */
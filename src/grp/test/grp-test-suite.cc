@@ -2,6 +2,13 @@
 
 // Include a header file from your module to test.
 #include "ns3/grp.h"
+#include "ns3/road-network.h"
+#include "ns3/junction-route-table.h"
+#include "ns3/node-address-index.h"
+#include "ns3/grp-neighbor-table.h"
+#include "ns3/constant-position-mobility-model.h"
+#include <fstream>
+#include <cmath>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +53,466 @@ GrpTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Check that the shared road network keeps the map in CSR form and that
+// every user of the same files gets the same instance.
+class RoadNetworkTestCase : public TestCase
+{
+public:
+  RoadNetworkTestCase ();
+  virtual ~RoadNetworkTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RoadNetworkTestCase::RoadNetworkTestCase ()
+  : TestCase ("Road network CSR layout and sharing")
+{
+}
+
+RoadNetworkTestCase::~RoadNetworkTestCase ()
+{
+}
+
+void
+RoadNetworkTestCase::DoRun (void)
+{
+  // 0 -- 1
+  // |
+  // 2
+  std::string mapFile = CreateTempDirFilename ("grp-map.csv");
+  std::string traceFile = CreateTempDirFilename ("grp-vtrace.csv");
+  {
+    std::ofstream map (mapFile.c_str ());
+    map << "0,0,0,2,1,0,100,2,270,100" << std::endl;
+    map << "1,100,0,1,0,180,100" << std::endl;
+    map << "2,0,-100,1,0,90,100" << std::endl;
+    std::ofstream trace (traceFile.c_str ());
+    trace << "0,0,0,1" << std::endl;
+    trace << "0,-100,2,0,1" << std::endl;
+  }
+
+  Ptr<const RoadNetwork> network = RoadNetwork::Load (mapFile, traceFile);
+  NS_TEST_ASSERT_MSG_EQ (network->GetNJunctions (), 3, "Wrong number of junctions");
+  NS_TEST_ASSERT_MSG_EQ (network->GetNEdges (), 4, "Wrong number of edges");
+  NS_TEST_ASSERT_MSG_EQ (network->GetEdgeEnd (0) - network->GetEdgeBegin (0), 2, "Wrong degree of junction 0");
+  NS_TEST_ASSERT_MSG_EQ (network->GetEdgeTarget (network->GetEdgeBegin (0)), 1, "Edges are not sorted");
+  NS_TEST_ASSERT_MSG_EQ_TOL (network->GetEdgeLength (network->GetEdgeBegin (2)), 100, 0.001, "Wrong edge length");
+  NS_TEST_ASSERT_MSG_EQ (network->IsAdjacent (0, 2), true, "0 -> 2 exists");
+  NS_TEST_ASSERT_MSG_EQ (network->IsAdjacent (1, 2), false, "1 -> 2 does not exist");
+  NS_TEST_ASSERT_MSG_EQ (network->GetDirection (0, 1), 0, "0 -> 1 points east");
+  NS_TEST_ASSERT_MSG_EQ (network->GetDirection (0, 2), 3, "0 -> 2 points south");
+
+  // the trailing empty line of the trace file is not a trace
+  NS_TEST_ASSERT_MSG_EQ (network->GetNTraces (), 2, "Wrong number of traces");
+  NS_TEST_ASSERT_MSG_EQ (network->GetNearestTrace (5, -90), 1, "Wrong nearest trace");
+  NS_TEST_ASSERT_MSG_EQ (network->GetTraceEnd (1) - network->GetTraceBegin (1), 3, "Wrong trace length");
+  NS_TEST_ASSERT_MSG_EQ (network->GetTraceJunction (network->GetTraceBegin (1)), 2, "Wrong first trace junction");
+
+  Ptr<const RoadNetwork> other = RoadNetwork::Load (mapFile, traceFile);
+  NS_TEST_ASSERT_MSG_EQ (other, network, "The network was loaded twice");
+  NS_TEST_ASSERT_MSG_EQ (network->GetReferenceCount (), 2, "The network is not shared");
+
+  // the compiled image maps back to the same network
+  std::string compiledFile = CreateTempDirFilename ("grp-network.bin");
+  NS_TEST_ASSERT_MSG_EQ (RoadNetwork::IsCompiled (mapFile), false, "A CSV file is not compiled");
+  NS_TEST_ASSERT_MSG_EQ (network->Save (compiledFile), true, "Cannot save the network");
+  NS_TEST_ASSERT_MSG_EQ (RoadNetwork::IsCompiled (compiledFile), true, "The saved file is not compiled");
+  Ptr<const RoadNetwork> mapped = RoadNetwork::Load (compiledFile);
+  NS_TEST_ASSERT_MSG_NE (mapped, network, "A compiled file is a different network");
+  NS_TEST_ASSERT_MSG_EQ (RoadNetwork::Load (compiledFile), mapped, "The compiled network was mapped twice");
+  NS_TEST_ASSERT_MSG_EQ (mapped->GetNJunctions (), 3, "Wrong number of junctions");
+  NS_TEST_ASSERT_MSG_EQ (mapped->GetNEdges (), 4, "Wrong number of edges");
+  NS_TEST_ASSERT_MSG_EQ (mapped->GetNTraces (), 2, "Wrong number of traces");
+  for (uint32_t j = 0; j < network->GetNJunctions (); j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (mapped->GetJunctionX (j), network->GetJunctionX (j), "Wrong junction x");
+      NS_TEST_ASSERT_MSG_EQ (mapped->GetJunctionY (j), network->GetJunctionY (j), "Wrong junction y");
+      NS_TEST_ASSERT_MSG_EQ (mapped->GetEdgeBegin (j), network->GetEdgeBegin (j), "Wrong edge offset");
+    }
+  for (uint32_t e = 0; e < network->GetNEdges (); e++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (mapped->GetEdgeTarget (e), network->GetEdgeTarget (e), "Wrong edge target");
+      NS_TEST_ASSERT_MSG_EQ (mapped->GetEdgeAngle (e), network->GetEdgeAngle (e), "Wrong edge angle");
+    }
+  NS_TEST_ASSERT_MSG_EQ (mapped->GetTraceJunction (mapped->GetTraceBegin (1)), 2, "Wrong first trace junction");
+
+}
+
+// Check the precomputed next-junction tables on a 3x2 grid
+//
+// 3 -- 4 -- 5
+// |    |    |
+// 0 -- 1 -- 2
+class JunctionRouteTableTestCase : public TestCase
+{
+public:
+  JunctionRouteTableTestCase ();
+  virtual ~JunctionRouteTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void AddEdge (std::vector<DigitalMapEntry> &map, int a, int b);
+};
+
+JunctionRouteTableTestCase::JunctionRouteTableTestCase ()
+  : TestCase ("Next junction table lookups and incremental updates")
+{
+}
+
+JunctionRouteTableTestCase::~JunctionRouteTableTestCase ()
+{
+}
+
+void
+JunctionRouteTableTestCase::AddEdge (std::vector<DigitalMapEntry> &map, int a, int b)
+{
+  std::vector<float> edge (3, 0);
+  map[a].outedge[b] = edge;
+  map[a].edgeNum++;
+  map[b].outedge[a] = edge;
+  map[b].edgeNum++;
+}
+
+void
+JunctionRouteTableTestCase::DoRun (void)
+{
+  std::vector<DigitalMapEntry> map (6);
+  for (int i = 0; i < 6; i++)
+    {
+      map[i].x = (i % 3) * 100;
+      map[i].y = (i / 3) * 100;
+      map[i].edgeNum = 0;
+    }
+  AddEdge (map, 0, 1);
+  AddEdge (map, 1, 2);
+  AddEdge (map, 3, 4);
+  AddEdge (map, 4, 5);
+  AddEdge (map, 0, 3);
+  AddEdge (map, 1, 4);
+  AddEdge (map, 2, 5);
+  Ptr<const RoadNetwork> network = Create<RoadNetwork> (map, std::vector<VTrace> ());
+
+  Ptr<JunctionRouteTable> table = JunctionRouteTable::GetHopCountTable (network);
+  NS_TEST_ASSERT_MSG_EQ (JunctionRouteTable::GetHopCountTable (network), table, "The hop count table is not shared");
+  NS_TEST_ASSERT_MSG_EQ (table->GetNextJunction (5, 5), 5, "A destination is its own next junction");
+  NS_TEST_ASSERT_MSG_EQ (table->GetNextJunction (3, 5), 4, "3 -> 4 -> 5");
+  NS_TEST_ASSERT_MSG_EQ (table->GetNextJunction (2, 5), 5, "2 -> 5");
+  int next = table->GetNextJunction (0, 5);
+  NS_TEST_ASSERT_MSG_EQ ((next == 1 || next == 3), true, "0 goes through 1 or 3");
+
+  std::vector<int> rsus;
+  rsus.push_back (2);
+  rsus.push_back (3);
+  NS_TEST_ASSERT_MSG_EQ (table->GetNextJunction (0, rsus), 3, "3 is the nearest RSU of 0");
+  NS_TEST_ASSERT_MSG_EQ (table->GetNextJunction (1, rsus), 2, "2 is the nearest RSU of 1");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table->GetDistance (4, rsus), 1, 0.001, "Wrong distance");
+
+  // A private table follows weight changes
+  Ptr<JunctionRouteTable> weighted = Create<JunctionRouteTable> (network);
+  NS_TEST_ASSERT_MSG_EQ_TOL (weighted->GetDistance (1, std::vector<int> (1, 3)), 2, 0.001, "Wrong distance");
+  for (uint32_t e = network->GetEdgeBegin (1); e < network->GetEdgeEnd (1); e++)
+    {
+      if (network->GetEdgeTarget (e) == 0)
+        {
+          weighted->SetEdgeWeight (e, -1);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (weighted->GetNextJunction (1, 3), 4, "1 -> 0 is disabled");
+  NS_TEST_ASSERT_MSG_EQ_TOL (weighted->GetDistance (1, std::vector<int> (1, 3)), 2, 0.001, "Wrong distance");
+  NS_TEST_ASSERT_MSG_EQ_TOL (table->GetDistance (1, std::vector<int> (1, 3)), 2, 0.001,
+                             "The shared table is not affected");
+
+  // Batches of weight changes repair the cached tables like a full
+  // computation on a larger grid
+  std::vector<DigitalMapEntry> grid (36);
+  for (int i = 0; i < 36; i++)
+    {
+      grid[i].x = (i % 6) * 100;
+      grid[i].y = (i / 6) * 100;
+      grid[i].edgeNum = 0;
+      if (i % 6 > 0)
+        {
+          AddEdge (grid, i - 1, i);
+        }
+      if (i >= 6)
+        {
+          AddEdge (grid, i - 6, i);
+        }
+    }
+  Ptr<const RoadNetwork> gridNetwork = Create<RoadNetwork> (grid, std::vector<VTrace> ());
+  Ptr<JunctionRouteTable> incremental = Create<JunctionRouteTable> (gridNetwork);
+  std::vector<int> gridRsus;
+  gridRsus.push_back (14);
+  gridRsus.push_back (33);
+  incremental->Prepare (gridRsus);
+  incremental->Prepare (std::vector<int> (1, 0));
+  uint32_t seed = 12345;
+  for (int round = 0; round < 50; round++)
+    {
+      for (int k = 0; k < 8; k++)
+        {
+          seed = seed * 1103515245 + 12345;
+          uint32_t edge = (seed >> 8) % gridNetwork->GetNEdges ();
+          seed = seed * 1103515245 + 12345;
+          uint32_t r = (seed >> 8) % 12;
+          incremental->SetEdgeWeight (edge, r == 0 ? -1 : r * 0.25);
+        }
+      Ptr<JunctionRouteTable> full = Create<JunctionRouteTable> (gridNetwork);
+      for (uint32_t e = 0; e < gridNetwork->GetNEdges (); e++)
+        {
+          full->SetEdgeWeight (e, incremental->GetEdgeWeight (e));
+        }
+      for (int j = 0; j < 36; j++)
+        {
+          double expected = full->GetDistance (j, gridRsus);
+          double distance = incremental->GetDistance (j, gridRsus);
+          NS_TEST_ASSERT_MSG_EQ ((std::isinf (expected) == std::isinf (distance)), true, "Wrong reachability of " << j);
+          if (!std::isinf (expected))
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL (distance, expected, 1e-9, "Wrong distance of " << j);
+              int next = incremental->GetNextJunction (j, gridRsus);
+              if (next != j)
+                {
+                  int e = gridNetwork->FindEdge (j, next);
+                  NS_TEST_ASSERT_MSG_EQ ((e >= 0 && incremental->GetEdgeWeight (e) >= 0), true, "Next junction of " << j << " is not usable");
+                  NS_TEST_ASSERT_MSG_EQ_TOL (incremental->GetEdgeWeight (e) + incremental->GetDistance (next, gridRsus), distance, 1e-9,
+                                             "Next junction of " << j << " is not on a shortest path");
+                }
+            }
+          std::vector<int> origin (1, 0);
+          expected = full->GetDistance (j, origin);
+          distance = incremental->GetDistance (j, origin);
+          NS_TEST_ASSERT_MSG_EQ ((std::isinf (expected) == std::isinf (distance)), true, "Wrong reachability of " << j);
+          if (!std::isinf (expected))
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL (distance, expected, 1e-9, "Wrong distance of " << j);
+            }
+        }
+    }
+}
+
+// Check the address to node/mobility index
+class NodeAddressIndexTestCase : public TestCase
+{
+public:
+  NodeAddressIndexTestCase ();
+  virtual ~NodeAddressIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NodeAddressIndexTestCase::NodeAddressIndexTestCase ()
+  : TestCase ("Address indexed node and position lookup")
+{
+}
+
+NodeAddressIndexTestCase::~NodeAddressIndexTestCase ()
+{
+}
+
+void
+NodeAddressIndexTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  NodeAddressIndex::Add (Ipv4Address ("10.1.0.7"), node);
+  NodeAddressIndex::Add (Ipv4Address ("10.2.0.7"), node);
+
+  // the mobility model is aggregated after the address is registered
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (Vector (10, 20, 0));
+  node->AggregateObject (mobility);
+
+  NS_TEST_ASSERT_MSG_EQ (NodeAddressIndex::GetNode (Ipv4Address ("10.1.0.7")), node, "Wrong node");
+  NS_TEST_ASSERT_MSG_EQ (NodeAddressIndex::GetNodeId (Ipv4Address ("10.2.0.7")), (int32_t) node->GetId (), "Wrong node id");
+  NS_TEST_ASSERT_MSG_EQ (NodeAddressIndex::GetNodeId (Ipv4Address ("10.3.0.7")), -1, "Unknown address");
+  Ptr<MobilityModel> found = NodeAddressIndex::GetMobilityModel (Ipv4Address ("10.1.0.7"));
+  NS_TEST_ASSERT_MSG_EQ ((found != 0), true, "No mobility model");
+  NS_TEST_ASSERT_MSG_EQ_TOL (found->GetPosition ().y, 20, 0.001, "Wrong position");
+
+  NodeAddressIndex::Remove (Ipv4Address ("10.1.0.7"));
+  NS_TEST_ASSERT_MSG_EQ ((NodeAddressIndex::GetNode (Ipv4Address ("10.1.0.7")) == 0), true, "Address not removed");
+  NodeAddressIndex::Remove (node);
+  NS_TEST_ASSERT_MSG_EQ ((NodeAddressIndex::GetNode (Ipv4Address ("10.2.0.7")) == 0), true, "Node not removed");
+
+  Simulator::Destroy ();
+}
+
+// Check the slot bookkeeping and the grid queries of the neighbor table
+class NeighborTableTestCase : public TestCase
+{
+public:
+  NeighborTableTestCase ();
+  virtual ~NeighborTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Add (grp::NeighborTable &table, const char *address, double x, double y);
+  uint32_t CountCandidates (const grp::NeighborTable &table, double minx, double miny,
+                            double maxx, double maxy);
+};
+
+NeighborTableTestCase::NeighborTableTestCase ()
+  : TestCase ("Neighbor table slots and grid queries")
+{
+}
+
+NeighborTableTestCase::~NeighborTableTestCase ()
+{
+}
+
+void
+NeighborTableTestCase::Add (grp::NeighborTable &table, const char *address, double x, double y)
+{
+  grp::NeighborTableEntry entry;
+  entry.N_neighbor_address = Ipv4Address (address);
+  entry.N_location_x = x;
+  entry.N_location_y = y;
+  entry.N_status = grp::NeighborTableEntry::STATUS_SYM;
+  table.Insert (entry);
+}
+
+uint32_t
+NeighborTableTestCase::CountCandidates (const grp::NeighborTable &table, double minx, double miny,
+                                        double maxx, double maxy)
+{
+  std::vector<uint32_t> slots;
+  table.GetCandidates (minx, miny, maxx, maxy, slots);
+  uint32_t n = 0;
+  for (std::vector<uint32_t>::const_iterator i = slots.begin (); i != slots.end (); i++)
+    {
+      if (table.GetX (*i) >= minx && table.GetX (*i) <= maxx
+          && table.GetY (*i) >= miny && table.GetY (*i) <= maxy)
+        {
+          n++;
+        }
+    }
+  return n;
+}
+
+void
+NeighborTableTestCase::DoRun (void)
+{
+  grp::NeighborTable table;
+  table.SetCellSize (50);
+  Add (table, "10.1.0.1", 10, 10);
+  Add (table, "10.1.0.2", 120, 10);
+  Add (table, "10.1.0.3", 480, 5);
+  Add (table, "10.1.0.4", -30, -400);
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 4, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (CountCandidates (table, 0, -10, 500, 10), 3, "Wrong candidates on the segment");
+
+  // moving a neighbor moves it to its new cell
+  Add (table, "10.1.0.4", 250, 0);
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 4, "Replacing an entry changed the size");
+  NS_TEST_ASSERT_MSG_EQ (CountCandidates (table, 0, -10, 500, 10), 4, "Moved neighbor not found");
+  NS_TEST_ASSERT_MSG_EQ (CountCandidates (table, -100, -500, 0, -300), 0, "Stale cell entry");
+
+  // erasing moves the last slot into the hole
+  NS_TEST_ASSERT_MSG_EQ (table.Erase (Ipv4Address ("10.1.0.1")), true, "Neighbor not erased");
+  NS_TEST_ASSERT_MSG_EQ (table.Erase (Ipv4Address ("10.1.0.1")), false, "Neighbor erased twice");
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 3, "Wrong size after erase");
+  const grp::NeighborTableEntry *entry = table.Find (Ipv4Address ("10.1.0.4"));
+  NS_TEST_ASSERT_MSG_EQ ((entry != 0), true, "Moved slot lost");
+  NS_TEST_ASSERT_MSG_EQ_TOL (entry->N_location_x, 250, 0.001, "Moved slot corrupted");
+  NS_TEST_ASSERT_MSG_EQ (CountCandidates (table, 0, 0, 50, 50), 0, "Erased neighbor still in its cell");
+  NS_TEST_ASSERT_MSG_EQ (CountCandidates (table, 200, -10, 300, 10), 1, "Moved slot not in its cell");
+
+  table.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (table.IsEmpty (), true, "Table not cleared");
+}
+
+// Check the compact HELLO encoding and its neighbor summary
+class CompactHelloTestCase : public TestCase
+{
+public:
+  CompactHelloTestCase ();
+  virtual ~CompactHelloTestCase ();
+
+private:
+  virtual void DoRun (void);
+  uint32_t RoundTrip (const grp::MessageHeader &in, grp::MessageHeader &out);
+};
+
+CompactHelloTestCase::CompactHelloTestCase ()
+  : TestCase ("Compact HELLO encoding")
+{
+}
+
+CompactHelloTestCase::~CompactHelloTestCase ()
+{
+}
+
+uint32_t
+CompactHelloTestCase::RoundTrip (const grp::MessageHeader &in, grp::MessageHeader &out)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (in);
+  uint32_t size = packet->GetSize ();
+  packet->RemoveHeader (out);
+  return size;
+}
+
+void
+CompactHelloTestCase::DoRun (void)
+{
+  grp::MessageHeader msg;
+  msg.SetMessageType (grp::MessageHeader::COMPACT_HELLO_MESSAGE);
+  msg.SetVTime (Seconds (3));
+  msg.SetOriginatorAddress (Ipv4Address ("10.1.0.1"));
+  grp::MessageHeader::Hello &hello = msg.GetHello ();
+  hello.SetLocation (1234.567, -89.01);
+  hello.SetSpeedAndDirection (13.89, (uint32_t)-1);
+  hello.SetTurn (7);
+
+  // no neighbor summary
+  grp::MessageHeader out;
+  uint32_t coreSize = RoundTrip (msg, out);
+  NS_TEST_ASSERT_MSG_EQ (out.GetMessageType (), grp::MessageHeader::COMPACT_HELLO_MESSAGE, "Wrong type");
+  NS_TEST_ASSERT_MSG_EQ (out.GetOriginatorAddress (), Ipv4Address ("10.1.0.1"), "Wrong originator");
+  const grp::MessageHeader::Hello &outHello = out.GetHello ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (outHello.GetLocationX (), 1234.567, 0.01, "Wrong x");
+  NS_TEST_ASSERT_MSG_EQ_TOL (outHello.GetLocationY (), -89.01, 0.01, "Wrong y");
+  NS_TEST_ASSERT_MSG_EQ_TOL (outHello.GetSpeed (), 13.89, 0.01, "Wrong speed");
+  NS_TEST_ASSERT_MSG_EQ ((int)outHello.GetDirection (), -1, "Unknown direction not kept");
+  NS_TEST_ASSERT_MSG_EQ (outHello.GetTurn (), 7, "Wrong turn");
+  NS_TEST_ASSERT_MSG_EQ (outHello.neighborFilter.empty (), true, "Unexpected neighbor summary");
+
+  // the summary takes about 10 bits per neighbor
+  hello.InitNeighborFilter (40);
+  uint32_t emptySize = RoundTrip (msg, out);
+  NS_TEST_ASSERT_MSG_EQ (emptySize, coreSize + 52, "Wrong summary size");
+  NS_TEST_ASSERT_MSG_EQ (out.GetHello ().IsInNeighborFilter (Ipv4Address ("10.1.0.2")), false,
+                         "Empty summary contains a neighbor");
+  for (uint32_t n = 2; n < 42; n++)
+    {
+      hello.AddNeighborToFilter (Ipv4Address ((10u << 24) | (1u << 16) | n));
+    }
+  NS_TEST_ASSERT_MSG_EQ (RoundTrip (msg, out), emptySize, "The summary size changed");
+  for (uint32_t n = 2; n < 42; n++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (out.GetHello ().IsInNeighborFilter (Ipv4Address ((10u << 24) | (1u << 16) | n)),
+                             true, "Neighbor missing from the summary");
+    }
+  uint32_t falsePositives = 0;
+  for (uint32_t n = 1000; n < 2000; n++)
+    {
+      falsePositives += out.GetHello ().IsInNeighborFilter (Ipv4Address ((10u << 24) | (1u << 16) | n));
+    }
+  NS_TEST_ASSERT_MSG_LT (falsePositives, 30u, "Too many false positives with 40 neighbors");
+
+  // the full format still lists the neighbors
+  grp::MessageHeader full;
+  full.SetVTime (Seconds (3));
+  full.GetHello ().SetLocation (1, 2);
+  full.GetHello ().neighborInterfaceAddresses.push_back (Ipv4Address ("10.1.0.9"));
+  RoundTrip (full, out);
+  NS_TEST_ASSERT_MSG_EQ (out.GetMessageType (), grp::MessageHeader::HELLO_MESSAGE, "Wrong type");
+  NS_TEST_ASSERT_MSG_EQ (out.GetHello ().neighborInterfaceAddresses.size (), 1, "Wrong neighbors");
+  NS_TEST_ASSERT_MSG_EQ (out.GetHello ().neighborFilter.empty (), true, "Stale summary");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +528,11 @@ GrpTestSuite::GrpTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new GrpTestCase1, TestCase::QUICK);
+  AddTestCase (new RoadNetworkTestCase, TestCase::QUICK);
+  AddTestCase (new JunctionRouteTableTestCase, TestCase::QUICK);
+  AddTestCase (new NodeAddressIndexTestCase, TestCase::QUICK);
+  AddTestCase (new NeighborTableTestCase, TestCase::QUICK);
+  AddTestCase (new CompactHelloTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
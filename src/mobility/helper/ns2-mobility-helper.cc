@@ -41,9 +41,14 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <set>
+#include <vector>
+#include <cstring>
+#include <sys/stat.h>
 #include "ns3/log.h"
 #include "ns3/unused.h"
 #include "ns3/simulator.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/node-list.h"
 #include "ns3/node.h"
 #include "ns3/constant-velocity-mobility-model.h"
@@ -62,6 +67,7 @@ NS_LOG_COMPONENT_DEFINE ("Ns2MobilityHelper");
 #define  NS2_SET      "set"
 #define  NS2_NODEID   "$node_("
 #define  NS2_NS_SCH   "$ns_"
+#define  NS2_CACHE_MAGIC "NS2MOB01"
 
 
 /**
@@ -166,10 +172,12 @@ static bool IsSchedSetPos (ParseResult pr);
 static bool IsSchedMobilityPos (ParseResult pr);
 
 /**
- * Set waypoints and speed for movement.
+ * Set waypoints and speed for movement.  The times are relative to
+ * origin, which is the time the movement is scheduled.
  */
 static DestinationPoint SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector lastPos, double at,
-                                     double xFinalPosition, double yFinalPosition, double speed);
+                                     double xFinalPosition, double yFinalPosition, double speed,
+                                     Time origin = Seconds (0));
 
 /**
  * Set initial position for a node
@@ -183,7 +191,9 @@ static Vector SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, double
 
 
 Ns2MobilityHelper::Ns2MobilityHelper (std::string filename)
-  : m_filename (filename)
+  : m_filename (filename),
+    m_streaming (false),
+    m_lookahead (Seconds (5))
 {
   std::ifstream file (m_filename.c_str (), std::ios::in);
   if (!(file.is_open ())) NS_FATAL_ERROR("Could not open trace file " << m_filename.c_str() << " for reading, aborting here \n"); 
@@ -211,9 +221,28 @@ Ns2MobilityHelper::GetMobilityModel (std::string idString, const ObjectStore &st
 }
 
 
+void
+Ns2MobilityHelper::EnableStreaming (Time lookahead)
+{
+  m_streaming = true;
+  m_lookahead = lookahead;
+}
+
+void
+Ns2MobilityHelper::SetCacheFile (std::string filename)
+{
+  m_cacheFilename = filename;
+}
+
 void
 Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 {
+  if (m_streaming)
+    {
+      StreamNodesMovements (store);
+      return;
+    }
+
   std::map<int, DestinationPoint> last_pos;    // Stores previous movement scheduled for each node
 
   //*****************************************************************
@@ -430,6 +459,519 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 }
 
 
+/**
+ * A statement of the trace, as read in streaming mode and as stored in
+ * the cache file
+ */
+struct Ns2Statement
+{
+  /// Kind of statement
+  enum Kind
+  {
+    INITIAL_POSITION = 0, //!< $node_(0) set X_ 1
+    SCHED_POSITION = 1,   //!< $ns_ at 1 "$node_(0) set X_ 1"
+    SETDEST = 2           //!< $ns_ at 1 "$node_(0) setdest 2 3 4"
+  };
+  uint8_t kind;   //!< the Kind of statement
+  uint8_t coord;  //!< the coordinate set, 0 for X_, 1 for Y_, 2 for Z_
+  uint32_t node;  //!< the node id
+  double at;      //!< the time of a scheduled statement
+  double x;       //!< the coordinate value, or the X destination
+  double y;       //!< the Y destination
+  double speed;   //!< the speed of a setdest
+};
+
+/// Size of a statement in the cache file
+static const uint32_t NS2_CACHE_STATEMENT_SIZE = 1 + 1 + 4 + 4 * 8;
+
+/// Header of the cache file
+struct Ns2CacheHeader
+{
+  char magic[8];        //!< NS2_CACHE_MAGIC
+  uint64_t traceSize;   //!< size of the trace the cache was built from
+  int64_t traceMtime;   //!< modification time of the trace
+  uint64_t nScheduled;  //!< number of scheduled statements, stored first
+  uint64_t nInitial;    //!< number of initial positions, stored next
+  uint64_t nNodes;      //!< number of node ids, stored last
+};
+
+/// Names of the coordinates of a statement
+static std::string g_ns2Coords[] = { NS2_X_COORD, NS2_Y_COORD, NS2_Z_COORD };
+
+/**
+ * Parse a line of the trace, with the checks of the default mode
+ * \param line the line
+ * \param [out] statement the statement read
+ * \return true if the line is a valid statement
+ */
+static bool
+ParseNs2Statement (const std::string &line, Ns2Statement &statement)
+{
+  if (line.empty ())
+    {
+      return false;
+    }
+  ParseResult pr = ParseNs2Line (line);
+  if (pr.tokens.size () != 4 && pr.tokens.size () != 7 && pr.tokens.size () != 8)
+    {
+      NS_LOG_ERROR ("Line has not correct number of parameters (corrupted file?): " << line << "\n");
+      return false;
+    }
+  int iNodeId = GetNodeIdInt (pr);
+  if (iNodeId == -1)
+    {
+      NS_LOG_ERROR ("Node number couldn't be obtained (corrupted file?): " << line << "\n");
+      return false;
+    }
+  statement.node = iNodeId;
+  statement.at = 0;
+  statement.x = 0;
+  statement.y = 0;
+  statement.speed = 0;
+  statement.coord = 0;
+
+  if (IsSetInitialPos (pr))
+    {
+      statement.kind = Ns2Statement::INITIAL_POSITION;
+      statement.coord = (pr.tokens[2] == NS2_X_COORD) ? 0 : (pr.tokens[2] == NS2_Y_COORD) ? 1 : 2;
+      statement.x = pr.dvals[3];
+      return true;
+    }
+  if (!IsNumber (pr.tokens[2]))
+    {
+      NS_LOG_WARN ("Time is not a number: " << pr.tokens[2]);
+      return false;
+    }
+  statement.at = pr.dvals[2];
+  if (statement.at < 0)
+    {
+      NS_LOG_WARN ("Time is less than cero: " << statement.at);
+      return false;
+    }
+  if (IsSchedMobilityPos (pr))
+    {
+      statement.kind = Ns2Statement::SETDEST;
+      statement.x = pr.dvals[5];
+      statement.y = pr.dvals[6];
+      statement.speed = pr.dvals[7];
+      return true;
+    }
+  if (IsSchedSetPos (pr))
+    {
+      statement.kind = Ns2Statement::SCHED_POSITION;
+      statement.coord = (pr.tokens[5] == NS2_X_COORD) ? 0 : (pr.tokens[5] == NS2_Y_COORD) ? 1 : 2;
+      statement.x = pr.dvals[6];
+      return true;
+    }
+  NS_LOG_WARN ("Format Line is not correct: " << line << "\n");
+  return false;
+}
+
+/**
+ * Write a statement to the cache file
+ * \param os the cache file
+ * \param statement the statement
+ */
+static void
+WriteNs2Statement (std::ostream &os, const Ns2Statement &statement)
+{
+  os.write ((const char *)&statement.kind, 1);
+  os.write ((const char *)&statement.coord, 1);
+  os.write ((const char *)&statement.node, 4);
+  os.write ((const char *)&statement.at, 8);
+  os.write ((const char *)&statement.x, 8);
+  os.write ((const char *)&statement.y, 8);
+  os.write ((const char *)&statement.speed, 8);
+}
+
+/**
+ * Read a statement from the cache file
+ * \param is the cache file
+ * \param [out] statement the statement
+ * \return true if a statement was read
+ */
+static bool
+ReadNs2Statement (std::istream &is, Ns2Statement &statement)
+{
+  char buffer[NS2_CACHE_STATEMENT_SIZE];
+  if (!is.read (buffer, NS2_CACHE_STATEMENT_SIZE))
+    {
+      return false;
+    }
+  std::memcpy (&statement.kind, buffer, 1);
+  std::memcpy (&statement.coord, buffer + 1, 1);
+  std::memcpy (&statement.node, buffer + 2, 4);
+  std::memcpy (&statement.at, buffer + 6, 8);
+  std::memcpy (&statement.x, buffer + 14, 8);
+  std::memcpy (&statement.y, buffer + 22, 8);
+  std::memcpy (&statement.speed, buffer + 30, 8);
+  return true;
+}
+
+/**
+ * Get the size and modification time of the trace
+ * \param filename the trace
+ * \param [out] header the header whose trace fields are set
+ * \return true if the trace exists
+ */
+static bool
+GetNs2TraceStamp (std::string filename, Ns2CacheHeader &header)
+{
+  struct stat st;
+  if (stat (filename.c_str (), &st) != 0)
+    {
+      return false;
+    }
+  header.traceSize = st.st_size;
+  header.traceMtime = st.st_mtime;
+  return true;
+}
+
+/**
+ * Convert the trace into a cache file
+ * \param filename the trace
+ * \param cacheFilename the cache file
+ * \return true if the cache file was written
+ */
+static bool
+BuildNs2Cache (std::string filename, std::string cacheFilename)
+{
+  NS_LOG_FUNCTION (filename << cacheFilename);
+  Ns2CacheHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, NS2_CACHE_MAGIC, sizeof (header.magic));
+  if (!GetNs2TraceStamp (filename, header))
+    {
+      return false;
+    }
+  std::ifstream file (filename.c_str (), std::ios::in);
+  std::ofstream cache (cacheFilename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open () || !cache.is_open ())
+    {
+      return false;
+    }
+  cache.write ((const char *)&header, sizeof (header));
+
+  // the scheduled statements are written as they are read, the initial
+  // positions are kept to be written after them
+  std::vector<Ns2Statement> initial;
+  std::set<uint32_t> nodes;
+  std::string line;
+  Ns2Statement statement;
+  while (getline (file, line))
+    {
+      if (!ParseNs2Statement (line, statement))
+        {
+          continue;
+        }
+      nodes.insert (statement.node);
+      if (statement.kind == Ns2Statement::INITIAL_POSITION)
+        {
+          initial.push_back (statement);
+        }
+      else
+        {
+          WriteNs2Statement (cache, statement);
+          header.nScheduled++;
+        }
+    }
+  for (std::vector<Ns2Statement>::const_iterator i = initial.begin (); i != initial.end (); i++)
+    {
+      WriteNs2Statement (cache, *i);
+    }
+  header.nInitial = initial.size ();
+  for (std::set<uint32_t>::const_iterator i = nodes.begin (); i != nodes.end (); i++)
+    {
+      uint32_t node = *i;
+      cache.write ((const char *)&node, 4);
+    }
+  header.nNodes = nodes.size ();
+  cache.seekp (0);
+  cache.write ((const char *)&header, sizeof (header));
+  return cache.good ();
+}
+
+/**
+ * \brief Reads a trace while the simulation runs.
+ *
+ * The statements are read in order and applied as in the default mode.
+ * A statement scheduled after the lookahead window stops the reading,
+ * which resumes when the simulation time gets within the window of it.
+ */
+class Ns2MobilityStream : public SimpleRefCount<Ns2MobilityStream>
+{
+public:
+  /**
+   * \param objects the objects of the store, by node id
+   * \param lookahead how far ahead of the simulation time the movements are scheduled
+   */
+  Ns2MobilityStream (const std::vector<Ptr<Object> > &objects, Time lookahead);
+  /**
+   * Read the text trace.
+   * \param filename the trace
+   * \return true if the trace could be opened
+   */
+  bool OpenTrace (std::string filename);
+  /**
+   * Read the cache file of the trace, build it if needed.
+   * \param filename the trace
+   * \param cacheFilename the cache file
+   * \return true if the cache file could be opened
+   */
+  bool OpenCache (std::string filename, std::string cacheFilename);
+  /**
+   * Apply the initial positions and schedule the movements of the first
+   * window.
+   */
+  void Start (void);
+
+private:
+  /// Schedule the movements of the next window.
+  void Refill (void);
+  /**
+   * \param [out] statement the next scheduled statement
+   * \return true if a statement was read
+   */
+  bool Next (Ns2Statement &statement);
+  /**
+   * \param node the node id
+   * \return the mobility model of the node, created if needed, or 0
+   */
+  Ptr<ConstantVelocityMobilityModel> GetModel (uint32_t node);
+  /**
+   * \param statement the statement to apply
+   */
+  void Apply (const Ns2Statement &statement);
+
+  std::vector<Ptr<Object> > m_objects;       //!< the objects, by node id
+  std::map<uint32_t, DestinationPoint> m_lastPos; //!< previous movement of every node
+  std::map<uint32_t, Vector> m_setPos;       //!< position of every node after the set statements
+  Time m_lookahead;                          //!< the window
+  std::ifstream m_file;                      //!< the trace or the cache file
+  bool m_cache;                              //!< whether m_file is a cache file
+  Ns2CacheHeader m_header;                   //!< header of the cache file
+  uint64_t m_nRead;                          //!< scheduled statements read from the cache
+  Ns2Statement m_pending;                    //!< statement read after the window
+  bool m_hasPending;                         //!< whether m_pending is valid
+};
+
+Ns2MobilityStream::Ns2MobilityStream (const std::vector<Ptr<Object> > &objects, Time lookahead)
+  : m_objects (objects),
+    m_lookahead (lookahead),
+    m_cache (false),
+    m_nRead (0),
+    m_hasPending (false)
+{
+}
+
+bool
+Ns2MobilityStream::OpenTrace (std::string filename)
+{
+  m_file.open (filename.c_str (), std::ios::in);
+  m_cache = false;
+  return m_file.is_open ();
+}
+
+bool
+Ns2MobilityStream::OpenCache (std::string filename, std::string cacheFilename)
+{
+  Ns2CacheHeader stamp;
+  if (!GetNs2TraceStamp (filename, stamp))
+    {
+      return false;
+    }
+  for (int attempt = 0; attempt < 2; attempt++)
+    {
+      m_file.close ();
+      m_file.clear ();
+      m_file.open (cacheFilename.c_str (), std::ios::in | std::ios::binary);
+      if (m_file.is_open ()
+          && m_file.read ((char *)&m_header, sizeof (m_header))
+          && std::memcmp (m_header.magic, NS2_CACHE_MAGIC, sizeof (m_header.magic)) == 0
+          && m_header.traceSize == stamp.traceSize
+          && m_header.traceMtime == stamp.traceMtime)
+        {
+          m_cache = true;
+          return true;
+        }
+      NS_LOG_INFO ("Building the cache file " << cacheFilename << " of " << filename);
+      if (!BuildNs2Cache (filename, cacheFilename))
+        {
+          break;
+        }
+    }
+  NS_LOG_WARN ("Cannot use the cache file " << cacheFilename << ", reading the trace");
+  return OpenTrace (filename);
+}
+
+Ptr<ConstantVelocityMobilityModel>
+Ns2MobilityStream::GetModel (uint32_t node)
+{
+  if (node >= m_objects.size ())
+    {
+      return 0;
+    }
+  Ptr<Object> object = m_objects[node];
+  Ptr<ConstantVelocityMobilityModel> model = object->GetObject<ConstantVelocityMobilityModel> ();
+  if (model == 0)
+    {
+      model = CreateObject<ConstantVelocityMobilityModel> ();
+      object->AggregateObject (model);
+    }
+  return model;
+}
+
+bool
+Ns2MobilityStream::Next (Ns2Statement &statement)
+{
+  if (m_cache)
+    {
+      if (m_nRead == m_header.nScheduled)
+        {
+          return false;
+        }
+      m_nRead++;
+      return ReadNs2Statement (m_file, statement);
+    }
+  std::string line;
+  while (getline (m_file, line))
+    {
+      if (ParseNs2Statement (line, statement))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+Ns2MobilityStream::Start (void)
+{
+  if (m_cache)
+    {
+      // the initial positions and the node ids follow the scheduled statements
+      std::streampos scheduled = m_file.tellg ();
+      m_file.seekg (scheduled + (std::streamoff)(m_header.nScheduled * NS2_CACHE_STATEMENT_SIZE));
+      Ns2Statement statement;
+      for (uint64_t i = 0; i < m_header.nInitial && ReadNs2Statement (m_file, statement); i++)
+        {
+          Apply (statement);
+        }
+      for (uint64_t i = 0; i < m_header.nNodes; i++)
+        {
+          uint32_t node;
+          if (m_file.read ((char *)&node, 4))
+            {
+              GetModel (node);
+            }
+        }
+      m_file.seekg (scheduled);
+    }
+  Refill ();
+}
+
+void
+Ns2MobilityStream::Refill (void)
+{
+  double horizon = (Simulator::Now () + m_lookahead).GetSeconds ();
+  while (m_hasPending || Next (m_pending))
+    {
+      m_hasPending = true;
+      if (m_pending.kind != Ns2Statement::INITIAL_POSITION && m_pending.at > horizon)
+        {
+          Time delay = Seconds (m_pending.at) - m_lookahead - Simulator::Now ();
+          Simulator::Schedule (Max (delay, Seconds (0)), &Ns2MobilityStream::Refill,
+                               Ptr<Ns2MobilityStream> (this));
+          return;
+        }
+      m_hasPending = false;
+      Apply (m_pending);
+    }
+  m_file.close ();
+}
+
+void
+Ns2MobilityStream::Apply (const Ns2Statement &statement)
+{
+  Ptr<ConstantVelocityMobilityModel> model = GetModel (statement.node);
+  if (model == 0)
+    {
+      NS_LOG_ERROR ("Unknown node ID (corrupted file?): " << statement.node << "\n");
+      return;
+    }
+  Time now = Simulator::Now ();
+  double at = statement.at;
+  if (statement.kind != Ns2Statement::INITIAL_POSITION && Seconds (at) < now)
+    {
+      NS_LOG_WARN ("Statement of node " << statement.node << " at " << at << " s is late, trace not sorted?");
+      at = now.GetSeconds ();
+    }
+  DestinationPoint &last = m_lastPos[statement.node];
+  switch (statement.kind)
+    {
+    case Ns2Statement::INITIAL_POSITION:
+      {
+        if (!now.IsZero ())
+          {
+            NS_LOG_WARN ("Initial position of node " << statement.node << " read at " << now.GetSeconds () << " s");
+          }
+        DestinationPoint point;
+        point.m_finalPosition = SetInitialPosition (model, g_ns2Coords[statement.coord], statement.x);
+        last = point;
+        m_setPos[statement.node] = point.m_finalPosition;
+        NS_LOG_DEBUG ("Positions after parse for node " << statement.node << " position = " << last.m_finalPosition);
+      }
+      break;
+    case Ns2Statement::SETDEST:
+      if (last.m_targetArrivalTime > at)
+        {
+          NS_LOG_LOGIC ("Did not reach a destination! stoptime = " << last.m_targetArrivalTime << ", at = " << at);
+          double actuallytraveled = at - last.m_travelStartTime;
+          Vector reached = Vector (last.m_startPosition.x + last.m_speed.x * actuallytraveled,
+                                   last.m_startPosition.y + last.m_speed.y * actuallytraveled,
+                                   0);
+          last.m_stopEvent.Cancel ();
+          last.m_finalPosition = reached;
+        }
+      last = SetMovement (model, last.m_finalPosition, at, statement.x, statement.y, statement.speed, now);
+      NS_LOG_DEBUG ("Positions after parse for node " << statement.node << " position =" << last.m_finalPosition);
+      break;
+    case Ns2Statement::SCHED_POSITION:
+      // as in the default mode, the coordinates not set are the ones of
+      // the initial position and of the previous set statements
+      m_setPos[statement.node] = SetOneInitialCoord (m_setPos[statement.node], g_ns2Coords[statement.coord], statement.x);
+      last.m_finalPosition = m_setPos[statement.node];
+      Simulator::Schedule (Seconds (at) - now, &ConstantVelocityMobilityModel::SetPosition, model, last.m_finalPosition);
+      if (last.m_targetArrivalTime > at)
+        {
+          last.m_stopEvent.Cancel ();
+        }
+      last.m_targetArrivalTime = at;
+      last.m_travelStartTime = at;
+      NS_LOG_DEBUG ("Positions after parse for node " << statement.node << " position =" << last.m_finalPosition);
+      break;
+    }
+}
+
+void
+Ns2MobilityHelper::StreamNodesMovements (const ObjectStore &store) const
+{
+  std::vector<Ptr<Object> > objects;
+  for (Ptr<Object> object = store.Get (0); object != 0; object = store.Get (objects.size ()))
+    {
+      objects.push_back (object);
+    }
+  Ptr<Ns2MobilityStream> stream = Create<Ns2MobilityStream> (objects, m_lookahead);
+  bool opened = m_cacheFilename.empty () ? stream->OpenTrace (m_filename)
+    : stream->OpenCache (m_filename, m_cacheFilename);
+  if (!opened)
+    {
+      NS_FATAL_ERROR ("Could not open trace file " << m_filename << " for reading");
+    }
+  stream->Start ();
+}
+
+
 ParseResult
 ParseNs2Line (const std::string& str)
 {
@@ -731,7 +1273,7 @@ IsSchedMobilityPos (ParseResult pr)
 
 DestinationPoint
 SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at,
-             double xFinalPosition, double yFinalPosition, double speed)
+             double xFinalPosition, double yFinalPosition, double speed, Time origin)
 {
   DestinationPoint retval;
   retval.m_startPosition = last_pos;
@@ -742,7 +1284,7 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
   if (speed == 0)
     {
       // We have to maintain last position, and stop the movement
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model,
+      retval.m_stopEvent = Simulator::Schedule (Seconds (at) - origin, &ConstantVelocityMobilityModel::SetVelocity, model,
                                                 Vector (0, 0, 0));
       return retval;
     }
@@ -766,8 +1308,8 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
       NS_LOG_DEBUG ("Calculated Speed: X=" << xSpeed << " Y=" << ySpeed << " Z=" << zSpeed);
 
       // Set the Values
-      Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (xSpeed, ySpeed, zSpeed));
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at + time), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
+      Simulator::Schedule (Seconds (at) - origin, &ConstantVelocityMobilityModel::SetVelocity, model, Vector (xSpeed, ySpeed, zSpeed));
+      retval.m_stopEvent = Simulator::Schedule (Seconds (at + time) - origin, &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
       retval.m_finalPosition.x += xSpeed * time;
       retval.m_finalPosition.y += ySpeed * time;
       retval.m_targetArrivalTime += time;
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include "ns3/ptr.h"
 #include "ns3/object.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -69,6 +70,17 @@ class ConstantVelocityMobilityModel;
  *
  *  See usage example in examples/mobility/ns2-mobility-trace.cc
  *
+ * By default the whole trace is read when the helper is installed and
+ * every movement is scheduled up front.  For long traces, EnableStreaming
+ * makes the helper read the trace once, in order, while the simulation
+ * runs: only the movements that start within the lookahead window are
+ * scheduled, and the rest of the trace is read when the simulation gets
+ * closer to it.  The scheduled movements must then be sorted by time, as
+ * SUMO and BonnMotion write them.  SetCacheFile additionally converts the
+ * trace into a binary file, reused as long as the trace does not change,
+ * which is read without any parsing and which lists the initial positions
+ * and the nodes of the trace up front.
+ *
  * \bug Rounding errors may cause movement to diverge from the mobility
  * pattern in ns-2 (using the same trace).
  * See https://www.nsnam.org/bugzilla/show_bug.cgi?id=1316
@@ -103,6 +115,30 @@ public:
    */
   template <typename T>
   void Install (T begin, T end) const;
+
+  /**
+   * Read the trace while the simulation runs instead of at Install.
+   *
+   * Without cache file, an initial position statement is applied when it
+   * is read, and the mobility model of a node is created the first time
+   * the node appears in the trace.  The statements must be sorted by
+   * time; a statement scheduled before the current simulation time is
+   * applied immediately.
+   *
+   * \param lookahead how far ahead of the simulation time the movements
+   *        are scheduled
+   */
+  void EnableStreaming (Time lookahead = Seconds (5));
+
+  /**
+   * Use a binary version of the trace in streaming mode.  The file is
+   * created from the trace if it does not exist or if the trace changed
+   * since it was created.  The file is in the native byte order and is
+   * only meant to be reused on the same machine.
+   *
+   * \param filename the name of the binary file
+   */
+  void SetCacheFile (std::string filename);
 private:
   /**
    * \brief a class to hold input objects internally
@@ -130,7 +166,15 @@ public:
    * \return pointer to a ConstantVelocityMobilityModel
    */
   Ptr<ConstantVelocityMobilityModel> GetMobilityModel (std::string idString, const ObjectStore &store) const;
+  /**
+   * Read the trace in streaming mode
+   * \param store Object store containing ns-3 mobility models
+   */
+  void StreamNodesMovements (const ObjectStore &store) const;
   std::string m_filename; //!< filename of file containing ns-2 mobility trace 
+  bool m_streaming;       //!< whether the trace is read while the simulation runs
+  Time m_lookahead;       //!< how far ahead the movements are scheduled in streaming mode
+  std::string m_cacheFilename; //!< binary version of the trace, empty if none
 };
 
 } // namespace ns3
@@ -70,6 +70,7 @@ HierarchicalMobilityModel::SetChild (Ptr<MobilityModel> model)
     {
       SetPosition (pos);
     }
+  ForgetPosition ();
 }
 
 void 
@@ -94,6 +95,7 @@ HierarchicalMobilityModel::SetParent (Ptr<MobilityModel> model)
     {
       SetPosition (pos);
     }
+  ForgetPosition ();
 }
 
 
@@ -22,6 +22,10 @@
 
 #include "mobility-model.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include <limits>
 
 namespace ns3 {
 
@@ -53,6 +57,7 @@ MobilityModel::GetTypeId (void)
 }
 
 MobilityModel::MobilityModel ()
+  : m_positionValid (false)
 {
 }
 
@@ -63,7 +68,15 @@ MobilityModel::~MobilityModel ()
 Vector
 MobilityModel::GetPosition (void) const
 {
-  return DoGetPosition ();
+  Time now = Simulator::Now ();
+  if (!m_positionValid || m_positionTime != now)
+    {
+      Vector position = DoGetPosition ();
+      m_position = position;
+      m_positionTime = now;
+      m_positionValid = true;
+    }
+  return m_position;
 }
 Vector
 MobilityModel::GetVelocity (void) const
@@ -75,13 +88,14 @@ void
 MobilityModel::SetPosition (const Vector &position)
 {
   DoSetPosition (position);
+  m_positionValid = false;
 }
 
 double 
 MobilityModel::GetDistanceFrom (Ptr<const MobilityModel> other) const
 {
-  Vector oPosition = other->DoGetPosition ();
-  Vector position = DoGetPosition ();
+  Vector oPosition = other->GetPosition ();
+  Vector position = GetPosition ();
   return CalculateDistance (position, oPosition);
 }
 
@@ -94,9 +108,41 @@ MobilityModel::GetRelativeSpeed (Ptr<const MobilityModel> other) const
 void
 MobilityModel::NotifyCourseChange (void) const
 {
+  m_positionValid = false;
   m_courseChangeTrace (this);
 }
 
+void
+MobilityModel::ForgetPosition (void) const
+{
+  m_positionValid = false;
+}
+
+void
+MobilityModel::GetAllPositions (Time t, std::vector<Vector> &positions)
+{
+  double dt = (t - Simulator::Now ()).GetSeconds ();
+  double nan = std::numeric_limits<double>::quiet_NaN ();
+  positions.resize (NodeList::GetNNodes ());
+  for (uint32_t i = 0; i < positions.size (); i++)
+    {
+      Ptr<MobilityModel> mobility = NodeList::GetNode (i)->GetObject<MobilityModel> ();
+      if (mobility == 0)
+        {
+          positions[i] = Vector (nan, nan, nan);
+          continue;
+        }
+      positions[i] = mobility->GetPosition ();
+      if (dt != 0)
+        {
+          Vector velocity = mobility->GetVelocity ();
+          positions[i].x += velocity.x * dt;
+          positions[i].y += velocity.y * dt;
+          positions[i].z += velocity.z * dt;
+        }
+    }
+}
+
 int64_t
 MobilityModel::AssignStreams (int64_t start)
 {
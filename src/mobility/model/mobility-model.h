@@ -22,7 +22,9 @@
 
 #include "ns3/vector.h"
 #include "ns3/object.h"
+#include "ns3/nstime.h"
 #include "ns3/traced-callback.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -49,6 +51,9 @@ public:
 
   /**
    * \return the current position
+   *
+   * The position is computed once per simulation time: until the time
+   * advances or the course changes, the next calls return it again.
    */
   Vector GetPosition (void) const;
   /**
@@ -79,6 +84,20 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Get the positions of all the nodes of the NodeList in one pass, for
+   * the spatial indices and the statistics that need all of them.
+   *
+   * The position of a node at a time other than the current one is
+   * extrapolated from its current position and velocity, which is exact
+   * as long as its velocity does not change until then.
+   *
+   * \param t the time of the positions
+   * \param [out] positions the positions, indexed by node id; NaN for
+   *        the nodes without mobility model
+   */
+  static void GetAllPositions (Time t, std::vector<Vector> &positions);
+
   /**
    *  TracedCallback signature.
    *
@@ -92,6 +111,12 @@ protected:
    * position changes to notify course change listeners.
    */
   void NotifyCourseChange (void) const;
+  /**
+   * Must be invoked by subclasses when the position changes at the
+   * current time without a course change notification, so that the
+   * position computed before the change is not returned again.
+   */
+  void ForgetPosition (void) const;
 private:
   /**
    * \return the current position.
@@ -129,6 +154,10 @@ private:
    */
   ns3::TracedCallback<Ptr<const MobilityModel> > m_courseChangeTrace;
 
+  mutable Vector m_position;     //!< position computed at m_positionTime
+  mutable Time m_positionTime;   //!< time m_position was computed at
+  mutable bool m_positionValid;  //!< whether m_position may be returned at m_positionTime
+
 };
 
 } // namespace ns3
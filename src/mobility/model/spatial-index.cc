@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spatial-index.h"
+#include "mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpatialIndex");
+
+NS_OBJECT_ENSURE_REGISTERED (SpatialIndex);
+
+TypeId
+SpatialIndex::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SpatialIndex")
+    .SetParent<Object> ()
+    .SetGroupName ("Mobility")
+    .AddConstructor<SpatialIndex> ()
+    .AddAttribute ("CellSize", "The side of the cells of the grid (m).",
+                   DoubleValue (250),
+                   MakeDoubleAccessor (&SpatialIndex::m_cellSize),
+                   MakeDoubleChecker<double> (0.001))
+  ;
+  return tid;
+}
+
+SpatialIndex::SpatialIndex ()
+  : m_cellSize (250),
+    m_maxSpeed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SpatialIndex::~SpatialIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+SpatialIndex::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+  Object::DoDispose ();
+}
+
+void
+SpatialIndex::Clear (void)
+{
+  for (std::vector<Item>::iterator i = m_items.begin (); i != m_items.end (); i++)
+    {
+      if (i->mobility != 0 && m_byMobility.erase (PeekPointer (i->mobility)) > 0)
+        {
+          i->mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                      MakeCallback (&SpatialIndex::CourseChanged, this));
+        }
+    }
+  m_items.clear ();
+  m_cells.clear ();
+  m_everywhere.clear ();
+  m_dirty.clear ();
+}
+
+void
+SpatialIndex::SetCellSize (double cellSize)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT_MSG (m_items.empty (), "The cell size of a non empty index cannot change");
+  m_cellSize = cellSize;
+}
+
+uint32_t
+SpatialIndex::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  uint32_t id = m_items.size ();
+  Item item;
+  item.mobility = mobility;
+  item.cell = 0;
+  item.indexed = false;
+  item.dirty = false;
+  m_items.push_back (item);
+  if (mobility == 0)
+    {
+      m_everywhere.push_back (id);
+      return id;
+    }
+  std::vector<uint32_t> &ids = m_byMobility[PeekPointer (mobility)];
+  if (ids.empty ())
+    {
+      mobility->TraceConnectWithoutContext ("CourseChange",
+                                            MakeCallback (&SpatialIndex::CourseChanged, this));
+    }
+  ids.push_back (id);
+  m_items[id].dirty = true;
+  m_dirty.push_back (id);
+  return id;
+}
+
+uint32_t
+SpatialIndex::GetN (void) const
+{
+  return m_items.size ();
+}
+
+void
+SpatialIndex::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  std::unordered_map<const MobilityModel *, std::vector<uint32_t> >::const_iterator i =
+    m_byMobility.find (PeekPointer (mobility));
+  if (i == m_byMobility.end ())
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator id = i->second.begin (); id != i->second.end (); id++)
+    {
+      if (!m_items[*id].dirty)
+        {
+          m_items[*id].dirty = true;
+          m_dirty.push_back (*id);
+        }
+    }
+}
+
+int32_t
+SpatialIndex::GetCellCoordinate (double x) const
+{
+  return (int32_t) std::floor (x / m_cellSize);
+}
+
+int64_t
+SpatialIndex::GetCellKey (int32_t cx, int32_t cy)
+{
+  return ((int64_t) cx << 32) | (uint32_t) cy;
+}
+
+void
+SpatialIndex::Refresh (uint32_t id)
+{
+  Item &item = m_items[id];
+  item.dirty = false;
+  Vector position = item.mobility->GetPosition ();
+  m_maxSpeed = std::max (m_maxSpeed, item.mobility->GetVelocity ().GetLength ());
+  int64_t cell = GetCellKey (GetCellCoordinate (position.x), GetCellCoordinate (position.y));
+  if (item.indexed && item.cell == cell)
+    {
+      return;
+    }
+  if (item.indexed)
+    {
+      std::vector<uint32_t> &old = m_cells[item.cell];
+      std::vector<uint32_t>::iterator i = std::find (old.begin (), old.end (), id);
+      NS_ASSERT (i != old.end ());
+      *i = old.back ();
+      old.pop_back ();
+      if (old.empty ())
+        {
+          m_cells.erase (item.cell);
+        }
+    }
+  m_cells[cell].push_back (id);
+  item.cell = cell;
+  item.indexed = true;
+}
+
+void
+SpatialIndex::Rebuild (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_refreshTime = Simulator::Now ();
+  m_maxSpeed = 0;
+  m_dirty.clear ();
+  for (uint32_t id = 0; id < m_items.size (); id++)
+    {
+      if (m_items[id].mobility != 0)
+        {
+          Refresh (id);
+        }
+    }
+}
+
+void
+SpatialIndex::GetCandidates (const Vector &position, double range, std::vector<uint32_t> &ids)
+{
+  ids.clear ();
+  for (std::vector<uint32_t>::const_iterator i = m_dirty.begin (); i != m_dirty.end (); i++)
+    {
+      Refresh (*i);
+    }
+  m_dirty.clear ();
+
+  double slack = m_maxSpeed * (Simulator::Now () - m_refreshTime).GetSeconds ();
+  if (slack > m_cellSize)
+    {
+      Rebuild ();
+      slack = 0;
+    }
+
+  double r = range + slack;
+  int32_t minx = GetCellCoordinate (position.x - r);
+  int32_t maxx = GetCellCoordinate (position.x + r);
+  int32_t miny = GetCellCoordinate (position.y - r);
+  int32_t maxy = GetCellCoordinate (position.y + r);
+  if ((double)(maxx - minx + 1) * (maxy - miny + 1) > m_cells.size ())
+    {
+      // fewer non empty cells than cells in range
+      for (std::unordered_map<int64_t, std::vector<uint32_t> >::const_iterator c = m_cells.begin ();
+           c != m_cells.end (); c++)
+        {
+          int32_t cx = (int32_t)(c->first >> 32);
+          int32_t cy = (int32_t)(uint32_t) c->first;
+          if (cx >= minx && cx <= maxx && cy >= miny && cy <= maxy)
+            {
+              ids.insert (ids.end (), c->second.begin (), c->second.end ());
+            }
+        }
+    }
+  else
+    {
+      for (int32_t cx = minx; cx <= maxx; cx++)
+        {
+          for (int32_t cy = miny; cy <= maxy; cy++)
+            {
+              std::unordered_map<int64_t, std::vector<uint32_t> >::const_iterator c =
+                m_cells.find (GetCellKey (cx, cy));
+              if (c != m_cells.end ())
+                {
+                  ids.insert (ids.end (), c->second.begin (), c->second.end ());
+                }
+            }
+        }
+    }
+  ids.insert (ids.end (), m_everywhere.begin (), m_everywhere.end ());
+  std::sort (ids.begin (), ids.end ());
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup mobility
+ * \brief A uniform grid of mobility models, to find the ones near a point.
+ *
+ * Broadcast channels use it to evaluate only the receivers that are
+ * within the interference range of a transmitter instead of all of them.
+ *
+ * Every item is stored in the cell of the position it had when it was
+ * last refreshed.  An item is refreshed, lazily on the next query, when
+ * its mobility model notifies a course change; between two course
+ * changes its velocity is assumed constant, which holds for the ns-3
+ * mobility models except ConstantAccelerationMobilityModel.  A query
+ * widens its range by the distance the fastest item may have covered
+ * since the items were last refreshed, and the whole grid is rebuilt
+ * when that slack exceeds one cell.  The candidates returned are thus a
+ * superset of the items within range, the caller checks the exact
+ * distance.
+ *
+ * Items without a mobility model are returned by every query.
+ */
+class SpatialIndex : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SpatialIndex ();
+  virtual ~SpatialIndex ();
+
+  /**
+   * \param cellSize the side of the cells in meters, usually the range
+   *        of the queries.  The index must be empty.
+   */
+  void SetCellSize (double cellSize);
+
+  /**
+   * \param mobility the mobility model of the new item, or 0
+   * \return the id of the item, the ids are allocated from 0 in order
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * \return the number of items
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * \param position the center of the query
+   * \param range the distance from the center, in meters
+   * \param [out] ids the sorted ids of the items that may be within
+   *        range of the center
+   */
+  void GetCandidates (const Vector &position, double range, std::vector<uint32_t> &ids);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// An indexed mobility model.
+  struct Item
+  {
+    Ptr<MobilityModel> mobility; //!< the mobility model, may be 0
+    int64_t cell;                //!< the key of its cell
+    bool indexed;                //!< whether it is in a cell
+    bool dirty;                  //!< whether its course changed since its refresh
+  };
+
+  /**
+   * \param mobility the mobility model whose course changed
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  /** Disconnect from the mobility models and remove all the items. */
+  void Clear (void);
+  /**
+   * Move an item to the cell of its current position.
+   * \param id the item
+   */
+  void Refresh (uint32_t id);
+  /** Refresh all the items. */
+  void Rebuild (void);
+  /**
+   * \param x a coordinate
+   * \return the cell coordinate
+   */
+  int32_t GetCellCoordinate (double x) const;
+  /**
+   * \param cx the cell x coordinate
+   * \param cy the cell y coordinate
+   * \return the key of the cell
+   */
+  static int64_t GetCellKey (int32_t cx, int32_t cy);
+
+  double m_cellSize;                                        //!< side of the cells
+  std::vector<Item> m_items;                                //!< the items, by id
+  std::unordered_map<int64_t, std::vector<uint32_t> > m_cells; //!< the items of every non empty cell
+  std::unordered_map<const MobilityModel *, std::vector<uint32_t> > m_byMobility; //!< the items of every mobility model
+  std::vector<uint32_t> m_everywhere;                       //!< the items without mobility model
+  std::vector<uint32_t> m_dirty;                            //!< the items to refresh
+  Time m_refreshTime;                                       //!< time of the last rebuild
+  double m_maxSpeed;                                        //!< highest speed since the last rebuild
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_INDEX_H */
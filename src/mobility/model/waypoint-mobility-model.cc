@@ -85,6 +85,7 @@ WaypointMobilityModel::AddWaypoint (const Waypoint &waypoint)
     {
       m_first = false;
       m_current = m_next = waypoint;
+      ForgetPosition ();
     }
   else
     {
@@ -206,6 +207,7 @@ WaypointMobilityModel::EndMobility (void)
   m_current.time = Time(std::numeric_limits<uint64_t>::infinity());
   m_next.time = m_current.time;
   m_first = true;
+  ForgetPosition ();
 }
 Vector
 WaypointMobilityModel::DoGetVelocity (void) const
@@ -31,6 +31,9 @@
 #include "ns3/mobility-model.h"
 #include "ns3/waypoint-mobility-model.h"
 #include "ns3/mobility-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include <cmath>
 
 using namespace ns3;
 
@@ -410,6 +413,132 @@ WaypointMobilityModelViaHelper::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Mobility model that counts the computations of its position
+ */
+class CountingMobilityModel : public MobilityModel
+{
+public:
+  CountingMobilityModel ()
+    : m_nComputed (0)
+  {
+  }
+  /**
+   * \param velocity the new velocity
+   */
+  void SetVelocity (const Vector &velocity)
+  {
+    m_start = DoGetPosition ();
+    m_startTime = Simulator::Now ();
+    m_velocity = velocity;
+    NotifyCourseChange ();
+  }
+  uint32_t m_nComputed; //!< number of positions computed
+
+private:
+  virtual Vector DoGetPosition (void) const
+  {
+    const_cast<CountingMobilityModel *> (this)->m_nComputed++;
+    double t = (Simulator::Now () - m_startTime).GetSeconds ();
+    return Vector (m_start.x + m_velocity.x * t, m_start.y + m_velocity.y * t, m_start.z + m_velocity.z * t);
+  }
+  virtual void DoSetPosition (const Vector &position)
+  {
+    m_start = position;
+    m_startTime = Simulator::Now ();
+  }
+  virtual Vector DoGetVelocity (void) const
+  {
+    return m_velocity;
+  }
+
+  Vector m_start;     //!< position at m_startTime
+  Time m_startTime;   //!< time of the last change
+  Vector m_velocity;  //!< the velocity
+};
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Test the position memo of MobilityModel and GetAllPositions
+ */
+class PositionMemoTestCase : public TestCase
+{
+public:
+  PositionMemoTestCase ();
+  virtual ~PositionMemoTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Read the position several times.
+   * \param position the expected position
+   * \param nComputed the expected number of computations after the reads
+   */
+  void Check (Vector position, uint32_t nComputed);
+
+  Ptr<CountingMobilityModel> m_mobility; //!< the model
+};
+
+PositionMemoTestCase::PositionMemoTestCase ()
+  : TestCase ("Test the position memo and GetAllPositions")
+{
+}
+
+PositionMemoTestCase::~PositionMemoTestCase ()
+{
+}
+
+void
+PositionMemoTestCase::Check (Vector position, uint32_t nComputed)
+{
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Vector pos = m_mobility->GetPosition ();
+      NS_TEST_EXPECT_MSG_EQ_TOL (pos.x, position.x, 0.001, "Wrong position at " << Simulator::Now ().GetSeconds () << " s");
+      NS_TEST_EXPECT_MSG_EQ_TOL (pos.y, position.y, 0.001, "Wrong position at " << Simulator::Now ().GetSeconds () << " s");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_mobility->m_nComputed, nComputed, "Wrong number of computations at " << Simulator::Now ().GetSeconds () << " s");
+}
+
+void
+PositionMemoTestCase::DoRun (void)
+{
+  NodeContainer c;
+  c.Create (2);
+  m_mobility = CreateObject<CountingMobilityModel> ();
+  c.Get (0)->AggregateObject (m_mobility);
+  m_mobility->SetPosition (Vector (1, 2, 0));
+
+  // one computation per time
+  Check (Vector (1, 2, 0), 1);
+  // one more after a change of position at the same time
+  m_mobility->SetPosition (Vector (3, 2, 0));
+  Check (Vector (3, 2, 0), 2);
+  Simulator::Schedule (Seconds (1), &PositionMemoTestCase::Check, this, Vector (3, 2, 0), 3);
+  // one more after a course change at the same time
+  Simulator::Schedule (Seconds (2), &CountingMobilityModel::SetVelocity, m_mobility, Vector (1, 0, 0));
+  Simulator::Schedule (Seconds (2), &PositionMemoTestCase::Check, this, Vector (3, 2, 0), 5);
+  Simulator::Schedule (Seconds (4), &PositionMemoTestCase::Check, this, Vector (5, 2, 0), 6);
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+
+  std::vector<Vector> positions;
+  MobilityModel::GetAllPositions (Simulator::Now (), positions);
+  NS_TEST_ASSERT_MSG_EQ (positions.size (), c.GetN (), "Wrong number of positions");
+  NS_TEST_EXPECT_MSG_EQ_TOL (positions[c.Get (0)->GetId ()].x, 6, 0.001, "Wrong current position");
+  NS_TEST_EXPECT_MSG_EQ (std::isnan (positions[c.Get (1)->GetId ()].x), true, "Position of a node without mobility");
+  MobilityModel::GetAllPositions (Simulator::Now () + Seconds (2), positions);
+  NS_TEST_EXPECT_MSG_EQ_TOL (positions[c.Get (0)->GetId ()].x, 8, 0.001, "Wrong extrapolated position");
+
+  m_mobility = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup mobility-test
  * \ingroup tests
@@ -429,6 +558,7 @@ MobilityTestSuite::MobilityTestSuite ()
   AddTestCase (new WaypointLazyNotifyTrue, TestCase::QUICK);
   AddTestCase (new WaypointInitialPositionIsWaypoint, TestCase::QUICK);
   AddTestCase (new WaypointMobilityModelViaHelper, TestCase::QUICK);
+  AddTestCase (new PositionMemoTestCase, TestCase::QUICK);
 }
 
 static MobilityTestSuite mobilityTestSuite; ///< the test suite
@@ -115,17 +115,26 @@ public:
       return (time < o.time);
     }
   };
+  /// How the helper reads the trace
+  enum Mode
+  {
+    EAGER,     ///< read the whole trace at Install
+    STREAMING, ///< read the trace while the simulation runs
+    CACHE      ///< stream the binary cache of the trace
+  };
   /**
    * Create new test case. To make it useful SetTrace () and AddReferencePoint () must be called
    *
    * \param name        Short description
    * \param timeLimit   Test time limit
    * \param nodes       Number of nodes used in the test trace, 1 by default
+   * \param mode        How the helper reads the trace, EAGER by default
    */
-  Ns2MobilityHelperTest (std::string const & name, Time timeLimit, uint32_t nodes = 1)
+  Ns2MobilityHelperTest (std::string const & name, Time timeLimit, uint32_t nodes = 1, Mode mode = EAGER)
     : TestCase (name),
       m_timeLimit (timeLimit),
       m_nodeCount (nodes),
+      m_mode (mode),
       m_nextRefPoint (0)
   {
   }
@@ -154,6 +163,8 @@ private:
   Time m_timeLimit;
   /// Number of nodes used in the test
   uint32_t m_nodeCount;
+  /// How the helper reads the trace
+  Mode m_mode;
   /// Trace as string
   std::string m_trace;
   /// Reference mobility
@@ -254,6 +265,15 @@ private:
         return;
       }
     Ns2MobilityHelper mobility (m_traceFile);
+    if (m_mode != EAGER)
+      {
+        // a short lookahead, so that the trace is read in several steps
+        mobility.EnableStreaming (Seconds (1));
+      }
+    if (m_mode == CACHE)
+      {
+        mobility.SetCacheFile (CreateTempDirFilename ("Ns2MobilityHelperTest.cache"));
+      }
     mobility.Install ();
     if (CheckInitialPositions ())
       {
@@ -278,13 +298,26 @@ public:
   Ns2MobilityHelperTestSuite () : TestSuite ("mobility-ns2-trace-helper", UNIT)
   {
     SetDataDir (NS_TEST_SOURCEDIR);
+    AddTestCases (Ns2MobilityHelperTest::EAGER, "");
+    AddTestCases (Ns2MobilityHelperTest::STREAMING, " (streaming)");
+    AddTestCases (Ns2MobilityHelperTest::CACHE, " (cache)");
+  }
 
+private:
+  /**
+   * Add the test cases for a mode of the helper
+   *
+   * \param mode    How the helper reads the traces
+   * \param suffix  Appended to the names of the test cases
+   */
+  void AddTestCases (Ns2MobilityHelperTest::Mode mode, std::string suffix)
+  {
     // to be used as temporary variable for test cases.
     // Note that test suite takes care of deleting all test cases.
     Ns2MobilityHelperTest * t (0);
 
     // Initial position
-    t = new Ns2MobilityHelperTest ("initial position", Seconds (1));
+    t = new Ns2MobilityHelperTest ("initial position" + suffix, Seconds (1), 1, mode);
     t->SetTrace ("$node_(0) set X_ 1.0\n"
                  "$node_(0) set Y_ 2.0\n"
                  "$node_(0) set Z_ 3.0\n"
@@ -293,7 +326,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Check parsing comments, empty lines and no EOF at the end of file
-    t = new Ns2MobilityHelperTest ("comments", Seconds (1));
+    t = new Ns2MobilityHelperTest ("comments" + suffix, Seconds (1), 1, mode);
     t->SetTrace ("# comment\n"
                  "\n\n" // empty lines
                  "$node_(0) set X_ 1.0 # comment \n"
@@ -305,7 +338,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Simple setdest. Arguments are interpreted as x, y, speed by default
-    t = new Ns2MobilityHelperTest ("simple setdest", Seconds (10));
+    t = new Ns2MobilityHelperTest ("simple setdest" + suffix, Seconds (10), 1, mode);
     t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 25 0 5\"");
     //                     id  t  position         velocity
     t->AddReferencePoint ("0", 0, Vector (0, 0, 0), Vector (0, 0, 0));
@@ -314,7 +347,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Several set and setdest. Arguments are interpreted as x, y, speed by default
-    t = new Ns2MobilityHelperTest ("square setdest", Seconds (6));
+    t = new Ns2MobilityHelperTest ("square setdest" + suffix, Seconds (6), 1, mode);
     t->SetTrace ("$node_(0) set X_ 0.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 5  0  5\"\n"
@@ -334,32 +367,37 @@ public:
     t->AddReferencePoint ("0", 5, Vector (0, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
 
-    // Copy of previous test case but with the initial positions at
-    // the end of the trace rather than at the beginning.
-    //
-    // Several set and setdest. Arguments are interpreted as x, y, speed by default
-    t = new Ns2MobilityHelperTest ("square setdest (initial positions at end)", Seconds (6));
-    t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 15  10  5\"\n"
-                 "$ns_ at 2.0 \"$node_(0) setdest 15  15  5\"\n"
-                 "$ns_ at 3.0 \"$node_(0) setdest 10  15  5\"\n"
-                 "$ns_ at 4.0 \"$node_(0) setdest 10  10  5\"\n"
-                 "$node_(0) set X_ 10.0\n"
-                 "$node_(0) set Y_ 10.0\n"
-                 );
-    //                     id  t  position         velocity
-    t->AddReferencePoint ("0", 0, Vector (10, 10, 0), Vector (0,  0, 0));
-    t->AddReferencePoint ("0", 1, Vector (10, 10, 0), Vector (5,  0, 0));
-    t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  0, 0));
-    t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  5, 0));
-    t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (0,  0, 0));
-    t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (-5, 0, 0));
-    t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, 0, 0));
-    t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, -5, 0));
-    t->AddReferencePoint ("0", 5, Vector (10, 10, 0), Vector (0,  0, 0));
-    AddTestCase (t, TestCase::QUICK);
+    // The streaming mode reads the initial positions when it reaches
+    // them, only the cache moves them before the movements.
+    if (mode != Ns2MobilityHelperTest::STREAMING)
+      {
+        // Copy of previous test case but with the initial positions at
+        // the end of the trace rather than at the beginning.
+        //
+        // Several set and setdest. Arguments are interpreted as x, y, speed by default
+        t = new Ns2MobilityHelperTest ("square setdest (initial positions at end)" + suffix, Seconds (6), 1, mode);
+        t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 15  10  5\"\n"
+                     "$ns_ at 2.0 \"$node_(0) setdest 15  15  5\"\n"
+                     "$ns_ at 3.0 \"$node_(0) setdest 10  15  5\"\n"
+                     "$ns_ at 4.0 \"$node_(0) setdest 10  10  5\"\n"
+                     "$node_(0) set X_ 10.0\n"
+                     "$node_(0) set Y_ 10.0\n"
+                     );
+        //                     id  t  position         velocity
+        t->AddReferencePoint ("0", 0, Vector (10, 10, 0), Vector (0,  0, 0));
+        t->AddReferencePoint ("0", 1, Vector (10, 10, 0), Vector (5,  0, 0));
+        t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  0, 0));
+        t->AddReferencePoint ("0", 2, Vector (15, 10, 0), Vector (0,  5, 0));
+        t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (0,  0, 0));
+        t->AddReferencePoint ("0", 3, Vector (15, 15, 0), Vector (-5, 0, 0));
+        t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, 0, 0));
+        t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, -5, 0));
+        t->AddReferencePoint ("0", 5, Vector (10, 10, 0), Vector (0,  0, 0));
+        AddTestCase (t, TestCase::QUICK);
+      }
 
     // Scheduled set position
-    t = new Ns2MobilityHelperTest ("scheduled set position", Seconds (2));
+    t = new Ns2MobilityHelperTest ("scheduled set position" + suffix, Seconds (2), 1, mode);
     t->SetTrace ("$ns_ at 1.0 \"$node_(0) set X_ 10\"\n"
                  "$ns_ at 1.0 \"$node_(0) set Z_ 10\"\n"
                  "$ns_ at 1.0 \"$node_(0) set Y_ 10\"");
@@ -370,7 +408,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Malformed lines
-    t = new Ns2MobilityHelperTest ("malformed lines", Seconds (2));
+    t = new Ns2MobilityHelperTest ("malformed lines" + suffix, Seconds (2), 1, mode);
     t->SetTrace ("$node() set X_ 1 # node id is not present\n"
                  "$node # incoplete line\"\n"
                  "$node this line is not correct\n"
@@ -386,7 +424,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Non possible values
-    t = new Ns2MobilityHelperTest ("non possible values", Seconds (2));
+    t = new Ns2MobilityHelperTest ("non possible values" + suffix, Seconds (2), 1, mode);
     t->SetTrace ("$node_(0) set X_ 1 # line OK \n"
                  "$node_(0) set Y_ 2 # line OK \n"
                  "$node_(0) set Z_ 3 # line OK \n"
@@ -406,7 +444,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // More than one node
-    t = new Ns2MobilityHelperTest ("few nodes, combinations of set and setdest", Seconds (10), 3);
+    t = new Ns2MobilityHelperTest ("few nodes, combinations of set and setdest" + suffix, Seconds (10), 3, mode);
     t->SetTrace ("$node_(0) set X_ 1.0\n"
                  "$node_(0) set Y_ 2.0\n"
                  "$node_(0) set Z_ 3.0\n"
@@ -434,7 +472,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Test for Speed == 0, that acts as stop the node.
-    t = new Ns2MobilityHelperTest ("setdest with speed cero", Seconds (10));
+    t = new Ns2MobilityHelperTest ("setdest with speed cero" + suffix, Seconds (10), 1, mode);
     t->SetTrace ("$ns_ at 1.0 \"$node_(0) setdest 25 0 5\"\n"
                  "$ns_ at 7.0 \"$node_(0) setdest 11  22  0\"\n");
     //                     id  t  position         velocity
@@ -446,7 +484,7 @@ public:
 
 
     // Test negative positions
-    t = new Ns2MobilityHelperTest ("test negative positions", Seconds (10));
+    t = new Ns2MobilityHelperTest ("test negative positions" + suffix, Seconds (10), 1, mode);
     t->SetTrace ("$node_(0) set X_ -1.0\n"
                  "$node_(0) set Y_ 0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 0 0 1\"\n"
@@ -460,7 +498,7 @@ public:
     AddTestCase (t, TestCase::QUICK);
 
     // Sqare setdest with values in the form 1.0e+2
-    t = new Ns2MobilityHelperTest ("Foalt numbers in 1.0e+2 format", Seconds (6));
+    t = new Ns2MobilityHelperTest ("Foalt numbers in 1.0e+2 format" + suffix, Seconds (6), 1, mode);
     t->SetTrace ("$node_(0) set X_ 0.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 1.0e+2  0       1.0e+2\"\n"
@@ -478,7 +516,7 @@ public:
     t->AddReferencePoint ("0", 4, Vector (0, 100, 0), Vector (0, -100, 0));
     t->AddReferencePoint ("0", 5, Vector (0, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
-    t = new Ns2MobilityHelperTest ("Bug 1219 testcase", Seconds (16));
+    t = new Ns2MobilityHelperTest ("Bug 1219 testcase" + suffix, Seconds (16), 1, mode);
     t->SetTrace ("$node_(0) set X_ 0.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 0  10       1\"\n"
@@ -490,14 +528,14 @@ public:
     t->AddReferencePoint ("0", 6, Vector (0, 5, 0), Vector (0,  -1, 0));
     t->AddReferencePoint ("0", 16, Vector (0, -10, 0), Vector (0, 0, 0));
     AddTestCase (t, TestCase::QUICK);
-    t = new Ns2MobilityHelperTest ("Bug 1059 testcase", Seconds (16));
+    t = new Ns2MobilityHelperTest ("Bug 1059 testcase" + suffix, Seconds (16), 1, mode);
     t->SetTrace ("$node_(0) set X_ 10.0\r\n"
                  "$node_(0) set Y_ 0.0\r\n"
                  );
     //                     id  t  position         velocity
     t->AddReferencePoint ("0", 0, Vector (10, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
-    t = new Ns2MobilityHelperTest ("Bug 1301 testcase", Seconds (16));
+    t = new Ns2MobilityHelperTest ("Bug 1301 testcase" + suffix, Seconds (16), 1, mode);
     t->SetTrace ("$node_(0) set X_ 10.0\n"
                  "$node_(0) set Y_ 0.0\n"
                  "$ns_ at 1.0 \"$node_(0) setdest 10  0       1\"\n"
@@ -508,7 +546,7 @@ public:
     t->AddReferencePoint ("0", 0, Vector (10, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
 
-    t = new Ns2MobilityHelperTest ("Bug 1316 testcase", Seconds (1000));
+    t = new Ns2MobilityHelperTest ("Bug 1316 testcase" + suffix, Seconds (1000), 1, mode);
     t->SetTrace ("$node_(0) set X_ 350.00000000000000\n"
                  "$node_(0) set Y_ 50.00000000000000\n"
                  "$ns_ at 50.00000000000000  \"$node_(0) setdest 400.00000000000000 50.00000000000000 1.00000000000000\"\n"
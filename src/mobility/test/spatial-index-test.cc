@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/spatial-index.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Compare the candidates of a SpatialIndex with a linear scan
+ * while the items move and change course.
+ */
+class SpatialIndexTestCase : public TestCase
+{
+public:
+  SpatialIndexTestCase ();
+  virtual ~SpatialIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /// Query around every item and check the candidates
+  void Check (void);
+  /// Change the velocity of some items
+  void Turn (void);
+
+  Ptr<SpatialIndex> m_index;                            ///< the index
+  std::vector<Ptr<ConstantVelocityMobilityModel> > m_models; ///< the indexed models
+  Ptr<UniformRandomVariable> m_random;                  ///< random velocities
+  uint32_t m_nCandidates;                               ///< candidates returned
+  uint32_t m_nQueries;                                  ///< queries run
+};
+
+SpatialIndexTestCase::SpatialIndexTestCase ()
+  : TestCase ("Check the candidates of the spatial index against a linear scan"),
+    m_nCandidates (0),
+    m_nQueries (0)
+{
+}
+
+SpatialIndexTestCase::~SpatialIndexTestCase ()
+{
+}
+
+void
+SpatialIndexTestCase::DoTeardown (void)
+{
+  m_index->Dispose ();
+  m_index = 0;
+  m_models.clear ();
+}
+
+void
+SpatialIndexTestCase::Check (void)
+{
+  const double range = 300;
+  std::vector<uint32_t> ids;
+  for (uint32_t k = 0; k < m_models.size (); k++)
+    {
+      Vector center = m_models[k]->GetPosition ();
+      m_index->GetCandidates (center, range, ids);
+      NS_TEST_ASSERT_MSG_EQ (std::is_sorted (ids.begin (), ids.end ()), true, "Candidates are not sorted");
+      for (uint32_t j = 0; j < m_models.size (); j++)
+        {
+          if (CalculateDistance (center, m_models[j]->GetPosition ()) <= range)
+            {
+              NS_TEST_ASSERT_MSG_EQ (std::binary_search (ids.begin (), ids.end (), j), true,
+                                     "Item within range is not a candidate");
+            }
+        }
+      // the item without mobility model is always a candidate
+      NS_TEST_ASSERT_MSG_EQ (ids.back (), m_models.size (), "Missing item without mobility");
+      m_nCandidates += ids.size ();
+      m_nQueries++;
+    }
+}
+
+void
+SpatialIndexTestCase::Turn (void)
+{
+  for (uint32_t k = 0; k < m_models.size (); k += 3)
+    {
+      m_models[k]->SetVelocity (Vector (m_random->GetValue (-40, 40), m_random->GetValue (-40, 40), 0));
+    }
+  // teleport one of them
+  m_models[1]->SetPosition (Vector (m_random->GetValue (0, 5000), m_random->GetValue (0, 5000), 0));
+}
+
+void
+SpatialIndexTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_index = CreateObject<SpatialIndex> ();
+  m_index->SetCellSize (300);
+  for (uint32_t k = 0; k < 400; k++)
+    {
+      Ptr<ConstantVelocityMobilityModel> model = CreateObject<ConstantVelocityMobilityModel> ();
+      model->SetPosition (Vector (m_random->GetValue (0, 5000), m_random->GetValue (0, 5000), 0));
+      model->SetVelocity (Vector (m_random->GetValue (-30, 30), m_random->GetValue (-30, 30), 0));
+      NS_TEST_ASSERT_MSG_EQ (m_index->Add (model), k, "Wrong id");
+      m_models.push_back (model);
+    }
+  m_index->Add (0);
+
+  for (double t = 0; t < 60; t += 1.5)
+    {
+      Simulator::Schedule (Seconds (t), &SpatialIndexTestCase::Check, this);
+    }
+  for (double t = 5.2; t < 60; t += 7)
+    {
+      Simulator::Schedule (Seconds (t), &SpatialIndexTestCase::Turn, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // the queries must prune most of the 400 items
+  NS_TEST_ASSERT_MSG_LT (m_nCandidates / m_nQueries, 100, "The index does not prune the far items");
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Spatial index test suite
+ */
+class SpatialIndexTestSuite : public TestSuite
+{
+public:
+  SpatialIndexTestSuite ();
+};
+
+SpatialIndexTestSuite::SpatialIndexTestSuite ()
+  : TestSuite ("spatial-index", UNIT)
+{
+  AddTestCase (new SpatialIndexTestCase, TestCase::QUICK);
+}
+
+static SpatialIndexTestSuite g_spatialIndexTestSuite; ///< the test suite
@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "block-tracker.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+BlockTracker::BlockTracker ()
+  : m_length (0),
+    m_covered (0)
+{
+  m_blankLens.insert (0);
+}
+
+void
+BlockTracker::SetLength (double length)
+{
+  NS_ASSERT (m_members.empty ());
+  m_length = length;
+  m_blankLens.clear ();
+  m_blankLens.insert (length);
+}
+
+double
+BlockTracker::GetLength (void) const
+{
+  return m_length;
+}
+
+void
+BlockTracker::Update (int id, MemberType type, double offset, Time expiry)
+{
+  Remove (id);
+
+  Member member;
+  member.offset = std::min (std::max (offset, 0.0), m_length);
+  member.id = id;
+  member.type = type;
+  member.expiry = expiry;
+  member.hasBlock = false;
+  MemberIterator itr = m_members.insert (member).first;
+  m_ids[id] = itr;
+  m_expiries.insert (std::make_pair (expiry, id));
+
+  MemberIterator first, last;
+  GetWindow (itr, first, last);
+  ClearBlocks (first, last);
+  BuildBlocks (first, last);
+}
+
+bool
+BlockTracker::Remove (int id)
+{
+  std::map<int, MemberIterator>::iterator idItr = m_ids.find (id);
+  if (idItr == m_ids.end ())
+    {
+      return false;
+    }
+  MemberIterator itr = idItr->second;
+  MemberIterator first, last;
+  GetWindow (itr, first, last);
+  ClearBlocks (first, last);
+  if (first == itr)
+    {
+      first++;
+    }
+  m_expiries.erase (std::make_pair (itr->expiry, id));
+  m_ids.erase (idItr);
+  m_members.erase (itr);
+  BuildBlocks (first, last);
+  return true;
+}
+
+bool
+BlockTracker::Expire (Time now)
+{
+  bool changed = false;
+  while (!m_expiries.empty () && m_expiries.begin ()->first < now)
+    {
+      Remove (m_expiries.begin ()->second);
+      changed = true;
+    }
+  return changed;
+}
+
+Time
+BlockTracker::GetNextExpiry (void) const
+{
+  if (m_expiries.empty ())
+    {
+      return Seconds (-1);
+    }
+  return m_expiries.begin ()->first;
+}
+
+uint32_t
+BlockTracker::GetNMembers (void) const
+{
+  return m_members.size ();
+}
+
+uint32_t
+BlockTracker::GetNBlocks (void) const
+{
+  return m_blocks.size ();
+}
+
+double
+BlockTracker::GetMaxBlankLen (void) const
+{
+  return *m_blankLens.rbegin ();
+}
+
+double
+BlockTracker::GetMaxBlockLen (void) const
+{
+  if (m_blockLens.empty ())
+    {
+      return -1;
+    }
+  return *m_blockLens.rbegin ();
+}
+
+double
+BlockTracker::GetCoveredLen (void) const
+{
+  return m_covered;
+}
+
+void
+BlockTracker::GetWindow (MemberIterator member, MemberIterator &first, MemberIterator &last) const
+{
+  // from the HEADER before the member, excluded ...
+  first = member;
+  while (first != m_members.begin ())
+    {
+      MemberIterator prev = first;
+      prev--;
+      if (prev->type == HEADER)
+        {
+          break;
+        }
+      first = prev;
+    }
+  // ... to the HEADER after it, included
+  last = member;
+  last++;
+  while (last != m_members.end () && last->type != HEADER)
+    {
+      last++;
+    }
+  if (last != m_members.end ())
+    {
+      last++;
+    }
+}
+
+void
+BlockTracker::ClearBlocks (MemberIterator first, MemberIterator last)
+{
+  for (MemberIterator itr = first; itr != last; itr++)
+    {
+      if (itr->hasBlock)
+        {
+          RemoveBlock (itr);
+        }
+    }
+}
+
+void
+BlockTracker::BuildBlocks (MemberIterator first, MemberIterator last)
+{
+  bool open = false;
+  double start = 0;
+  MemberIterator opener = m_members.end ();
+  if (first == m_members.begin ())
+    {
+      // a HEADER before any TAILER ends a block from the segment start
+      MemberIterator itr = first;
+      while (itr != last && itr->type == ISOLATED)
+        {
+          itr++;
+        }
+      open = (itr != last && itr->type == HEADER);
+    }
+
+  for (MemberIterator itr = first; itr != last; itr++)
+    {
+      switch (itr->type)
+        {
+        case ISOLATED:
+          if (!open)
+            {
+              AddBlock (itr, itr->offset, itr->offset);
+            }
+          break;
+        case TAILER:
+          if (!open)
+            {
+              open = true;
+              start = itr->offset;
+              opener = itr;
+            }
+          break;
+        case HEADER:
+          if (open)
+            {
+              AddBlock (itr, start, itr->offset);
+              open = false;
+            }
+          break;
+        }
+    }
+
+  // a TAILER that is never closed opens a block up to the segment end
+  if (open)
+    {
+      NS_ASSERT (last == m_members.end () && opener != m_members.end ());
+      AddBlock (opener, start, m_length);
+    }
+}
+
+void
+BlockTracker::AddBlock (MemberIterator owner, double start, double end)
+{
+  BlockIterator itr = m_blocks.insert (Block (start, end));
+  BlockIterator next = itr;
+  next++;
+  double prevEnd = (itr == m_blocks.begin ()) ? 0 : (--BlockIterator (itr))->second;
+  double nextStart = (next == m_blocks.end ()) ? m_length : next->first;
+
+  m_blankLens.erase (m_blankLens.find (nextStart - prevEnd));
+  m_blankLens.insert (start - prevEnd);
+  m_blankLens.insert (nextStart - end);
+  m_blockLens.insert (end - start);
+  m_covered += end - start;
+  owner->hasBlock = true;
+  owner->block = itr;
+}
+
+void
+BlockTracker::RemoveBlock (MemberIterator owner)
+{
+  BlockIterator itr = owner->block;
+  BlockIterator next = itr;
+  next++;
+  double prevEnd = (itr == m_blocks.begin ()) ? 0 : (--BlockIterator (itr))->second;
+  double nextStart = (next == m_blocks.end ()) ? m_length : next->first;
+  double start = itr->first;
+  double end = itr->second;
+
+  m_blankLens.erase (m_blankLens.find (start - prevEnd));
+  m_blankLens.erase (m_blankLens.find (nextStart - end));
+  m_blankLens.insert (nextStart - prevEnd);
+  m_blockLens.erase (m_blockLens.find (end - start));
+  m_covered -= end - start;
+  m_blocks.erase (itr);
+  owner->hasBlock = false;
+}
+
+}
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef BLOCK_TRACKER_H
+#define BLOCK_TRACKER_H
+
+#include <stdint.h>
+#include <set>
+#include <map>
+#include <utility>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief The blocks (vehicle platoons) reported on one road segment.
+ *
+ * The members of the blocks are kept ordered by their offset from the
+ * start of the segment, in the travel direction.  A TAILER opens a block
+ * that the next HEADER closes, an ISOLATED vehicle outside any block is a
+ * block of length zero.  A HEADER before any TAILER closes a block that
+ * starts at the beginning of the segment and a TAILER that is never
+ * closed opens a block up to the end of the segment.
+ *
+ * Since the state of this scan is reset by every HEADER, changing a
+ * member only changes the blocks between the closest HEADERs around it.
+ * Update, Remove and Expire rebuild those blocks only and keep the
+ * number of blocks, the block lengths, the blank lengths between them and
+ * the covered length up to date, so every aggregate is read in O(1).
+ */
+class BlockTracker
+{
+public:
+  enum MemberType
+  {
+    HEADER = 0,
+    TAILER = 1,
+    ISOLATED = 2,
+  };
+
+  BlockTracker ();
+
+  /**
+   * \param length the length of the segment, members must be reported
+   *        with an offset in [0, length]
+   */
+  void SetLength (double length);
+  double GetLength (void) const;
+
+  /**
+   * Add a member or replace the report of the same member.
+   *
+   * \param id the id of the vehicle
+   * \param type its role in its block
+   * \param offset its distance from the start of the segment
+   * \param expiry the time after which the report is dropped by Expire
+   */
+  void Update (int id, MemberType type, double offset, Time expiry);
+  /**
+   * \param id the id of the vehicle
+   * \return true if the vehicle was a member
+   */
+  bool Remove (int id);
+  /**
+   * Remove the members whose expiry time is before \p now.
+   *
+   * \param now the current time
+   * \return true if a member was removed
+   */
+  bool Expire (Time now);
+  /**
+   * \return the earliest expiry time of the members, or a negative time
+   *         if there are none
+   */
+  Time GetNextExpiry (void) const;
+
+  uint32_t GetNMembers (void) const;
+  uint32_t GetNBlocks (void) const;
+  /// \return the longest part of the segment not covered by a block
+  double GetMaxBlankLen (void) const;
+  /// \return the length of the longest block, -1 if there is none
+  double GetMaxBlockLen (void) const;
+  /// \return the sum of the block lengths
+  double GetCoveredLen (void) const;
+
+private:
+  /// a block, from its start offset to its end offset
+  typedef std::pair<double, double> Block;
+  typedef std::multiset<Block>::iterator BlockIterator;
+
+  struct Member
+  {
+    double offset;
+    int id;
+    MemberType type;
+    Time expiry;
+    /// the block this member ends, if any
+    mutable bool hasBlock;
+    mutable BlockIterator block;
+
+    bool operator< (const Member &o) const
+    {
+      return offset < o.offset || (offset == o.offset && id < o.id);
+    }
+  };
+  typedef std::set<Member>::iterator MemberIterator;
+
+  /**
+   * \param member a member
+   * \param [out] first the first member whose block may depend on \p member
+   * \param [out] last one past the last such member
+   */
+  void GetWindow (MemberIterator member, MemberIterator &first, MemberIterator &last) const;
+  /// Remove the blocks ended by the members in [first, last).
+  void ClearBlocks (MemberIterator first, MemberIterator last);
+  /// Build again the blocks of the members in [first, last).
+  void BuildBlocks (MemberIterator first, MemberIterator last);
+  void AddBlock (MemberIterator owner, double start, double end);
+  void RemoveBlock (MemberIterator owner);
+
+  double m_length;
+  std::set<Member> m_members;
+  /// position of every member
+  std::map<int, MemberIterator> m_ids;
+  /// members by expiry time
+  std::set<std::pair<Time, int> > m_expiries;
+
+  std::multiset<Block> m_blocks;
+  std::multiset<double> m_blockLens;
+  /// the blank lengths between consecutive blocks and the segment ends
+  std::multiset<double> m_blankLens;
+  double m_covered;
+};
+
+}
+
+#endif /* BLOCK_TRACKER_H */
@@ -18,6 +18,7 @@
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/network-module.h"
 #include "ns3/tag.h"
+#include "ns3/node-address-index.h"
 #include <cmath>
 
 namespace ns3 {
@@ -47,7 +48,13 @@ void RoutingProtocol::SetIpv4 (Ptr<Ipv4> ipv4)
 }
 void RoutingProtocol::DoDispose () 
 {
+  if (m_ipv4 != 0)
+    {
+      NodeAddressIndex::Remove (m_ipv4->GetObject<Node> ());
+    }
   m_ipv4 = 0;
+  m_network = 0;
+  m_costTable = 0;
 }
 void RoutingProtocol::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const {}
 void RoutingProtocol::SetMainInterface (uint32_t interface)
@@ -58,8 +65,17 @@ void RoutingProtocol::SetDownTarget (IpL4Protocol::DownTargetCallback callback)
 void RoutingProtocol::AddHeader (Ptr<Packet> p, Ipv4Address source, Ipv4Address destination, uint8_t protocol, Ptr<Ipv4Route> route) {}
 void RoutingProtocol::NotifyInterfaceUp (uint32_t i) {}
 void RoutingProtocol::NotifyInterfaceDown (uint32_t i) {}
-void RoutingProtocol::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address) {}
-void RoutingProtocol::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address) {}
+void RoutingProtocol::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  if (address.GetLocal () != Ipv4Address::GetLoopback ())
+    {
+      NodeAddressIndex::Add (address.GetLocal (), m_ipv4->GetObject<Node> ());
+    }
+}
+void RoutingProtocol::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  NodeAddressIndex::Remove (address.GetLocal ());
+}
 
 int64_t
 RoutingProtocol::AssignStreams (int64_t stream)
@@ -89,13 +105,16 @@ RoutingProtocol::SendRoadConInfoViaLTE(RoadSegment info, Time time)
     std::map<RoadSegment, Time>::iterator itr = m_contable.find(info);
     if(itr != m_contable.end())
     {
-        if(itr->second < time)
-            itr->second = time;
+        if(itr->second >= time)
+            return;
+        itr->second = time;
     }
     else
     {
         m_contable[info] = time;
     }
+    SetSegmentDirty(info.sjid, info.ejid);
+    m_conExpiry.push(std::make_pair(time, info));
 }
 
 void
@@ -116,289 +135,141 @@ RoutingProtocol::RequireTokenFromLC(int jid)
     }
 }
 
-bool BlockSortFunU(const BlockMemberInfo& info1, const BlockMemberInfo& info2)
+BlockTracker&
+RoutingProtocol::GetBlockTracker(RoadSegment seg)
 {
-  return info1.location < info2.location;
-}
-
-bool BlockSortFunD(const BlockMemberInfo& info1, const BlockMemberInfo& info2)
-{
-  return info1.location > info2.location;
+    BlockTrackerTable::iterator itr = m_blockTrackers.find(seg);
+    if(itr == m_blockTrackers.end())
+    {
+        int dir = GetRoadDirection(seg.sjid, seg.ejid);
+        double length = 0;
+        if(dir == 0 || dir == 2)
+            length = fabs(m_network->GetJunctionX(seg.ejid) - m_network->GetJunctionX(seg.sjid));
+        else
+            length = fabs(m_network->GetJunctionY(seg.ejid) - m_network->GetJunctionY(seg.sjid));
+        itr = m_blockTrackers.insert(std::make_pair(seg, BlockTracker())).first;
+        itr->second.SetLength(length);
+    }
+    return itr->second;
 }
 
 void 
 RoutingProtocol::PurgeBlockInfo(RoadSegment seg)
 {
-    std::vector<BlockMemberInfo>& rlist = m_bnodeTable[seg];
-    double time = Simulator::Now().GetSeconds();
-    std::vector<BlockMemberInfo>::iterator itr = rlist.begin();
-    while(itr != rlist.end())
+    BlockTrackerTable::iterator itr = m_blockTrackers.find(seg);
+    if(itr != m_blockTrackers.end() && itr->second.Expire(Simulator::Now()))
     {
-        if(itr->time < time)
-        {
-            rlist.erase(itr);
-            continue;
-        }
-        itr++;
+        SetSegmentDirty(seg.sjid, seg.ejid);
     }
-    UpdateAvailableBlock(seg);
 }
 
 void
-RoutingProtocol::UpdateAvailableBlock(RoadSegment seg)
+RoutingProtocol::PurgeExpiredBlocks()
 {
-    std::vector<BlockMemberInfo> rlist = m_bnodeTable[seg];
-
-    if(rlist.empty() == true)
-        return;
-    
-    int dir = GetRoadDirection(seg.sjid, seg.ejid);
-    if(dir == 0 || dir == 1)
-    {
-        sort(rlist.begin(), rlist.end(), BlockSortFunU);
-    }
-    else
-    {
-        sort(rlist.begin(), rlist.end(), BlockSortFunD);
-    }
-
-    std::vector<BlockInfo> rblock;
-    std::vector<BlockMemberInfo>::iterator itr = rlist.begin(); 
-    std::vector<BlockMemberInfo>::iterator rend = rlist.end();
-
-    if(itr->vType == BlockMemberInfo::HEADER)
-    {
-        BlockInfo block;
-        if(dir == 0 || dir == 2)
-            block.tloc = m_map[seg.sjid].x;
-        else
-            block.tloc = m_map[seg.sjid].y;
-        block.hloc = itr->location;
-        rblock.push_back(block);
-        itr++;
-    }
-    if((rend - 1)->vType == BlockMemberInfo::TAILER)
+    while(m_blockExpiry.empty() == false && m_blockExpiry.top().first < Simulator::Now())
     {
-        BlockInfo block;
-        if(dir == 0 || dir == 2)
-            block.hloc = m_map[seg.ejid].x;
-        else
-            block.hloc = m_map[seg.ejid].y;
-        block.tloc = rend->location;
-        rblock.push_back(block);
-        rend--;
+        PurgeBlockInfo(m_blockExpiry.top().second);
+        m_blockExpiry.pop();
     }
-
-    std::stack<BlockMemberInfo> bstack;
-    while(itr != rend)
-    {
-        BlockInfo block;
-
-        if(itr->vType == BlockMemberInfo::ISOLATED)
-        {
-            block.hloc = block.tloc = itr->location;
-            rblock.push_back(block);
-        }
-        else if(itr->vType == BlockMemberInfo::TAILER)
-        {
-            bstack.push(*itr);
-        }
-        else
-        {
-            if(bstack.empty() == false)
-            {
-                BlockMemberInfo tailer = bstack.top();
-                bstack.pop();
-                block.hloc = itr->location;
-                block.tloc = tailer.location;
-                rblock.push_back(block);
-
-                if(itr->dir < 2 && block.tloc > block.hloc)
-                {
-                    NS_LOG_UNCOND("ERROR!");
-                }
-                if(itr->dir >= 2 && block.tloc < block.hloc)
-                {
-                    NS_LOG_UNCOND("ERROR!");
-                }
-            }
-        }
-        itr++;
-    }
-
-    blocklist[seg] = rblock;
 }
 
 void 
 RoutingProtocol::AddBlockInfo(int sjid, int ejid, BlockMemberInfo info)
 {
+    NS_ASSERT_MSG(m_network != 0, "SetDigitalMap must be called before AddBlockInfo");
+    PurgeExpiredBlocks();
+
     RoadSegment seg(sjid, ejid);
-    std::vector<BlockMemberInfo>& rlist = m_bnodeTable[seg];
-    std::vector<BlockMemberInfo>::iterator itr = rlist.begin();
-    while(itr != rlist.end())
+    BlockTracker& tracker = GetBlockTracker(seg);
+    //车辆位置换算为沿行驶方向到路段起点的距离
+    int dir = GetRoadDirection(sjid, ejid);
+    double spos = (dir == 0 || dir == 2) ? m_network->GetJunctionX(sjid) : m_network->GetJunctionY(sjid);
+    double offset = (dir == 0 || dir == 1) ? info.location - spos : spos - info.location;
+    //车辆上报的信息在BlockUpdateTime + 0.1秒之后过期
+    Time expiry = info.time + Seconds(BlockUpdateTime + 0.1);
+    tracker.Update(info.id, (BlockTracker::MemberType) info.vType, offset, expiry);
+    m_blockExpiry.push(std::make_pair(expiry, seg));
+    SetSegmentDirty(sjid, ejid);
+}
+
+void
+RoutingProtocol::SetDigitalMap(Ptr<const RoadNetwork> network)
+{
+    m_network = network;
+    //没有车辆上报之前所有路段都不可用
+    m_costTable = Create<JunctionRouteTable>(network);
+    for(uint32_t e = 0; e < network->GetNEdges(); e++)
     {
-        if(itr->id == info.id)
-        {
-            rlist.erase(itr);
-            break;
-        }
-        itr++;
+        m_costTable->SetEdgeWeight(e, -1);
+    }
+    m_dirtySegments.clear();
+    for(BlockTrackerTable::const_iterator itr = m_blockTrackers.begin(); itr != m_blockTrackers.end(); itr++)
+    {
+        SetSegmentDirty(itr->first.sjid, itr->first.ejid);
+    }
+    for(std::map<RoadSegment, Time>::const_iterator itr = m_contable.begin(); itr != m_contable.end(); itr++)
+    {
+        SetSegmentDirty(itr->first.sjid, itr->first.ejid);
     }
-    rlist.push_back(info);
-
-    UpdateAvailableBlock(seg);
-    Simulator::Schedule(Seconds(BlockUpdateTime + 0.1), &RoutingProtocol::PurgeBlockInfo, this, seg);
 }
 
 void
-RoutingProtocol::SetDigitalMap(std::vector<DigitalMapEntry> map)
+RoutingProtocol::SetSegmentDirty(int sjid, int ejid)
 {
-    m_map.assign(map.begin(), map.end());
+    if(sjid < ejid)
+        m_dirtySegments.insert(RoadSegment(sjid, ejid));
+    else
+        m_dirtySegments.insert(RoadSegment(ejid, sjid));
 }
 
 int 
 RoutingProtocol::GetRoadDirection(int i, int j)
 {
-    double cx = m_map[i].x;
-	double cy = m_map[i].y;
-	double nx = m_map[j].x;
-	double ny = m_map[j].y;
-
-	if(ny == cy)
-	{
-		if(nx > cx)
-			return 0;
-		else
-			return 2;
-	}
-	else
-	{
-		if(ny > cy)
-			return 1;
-		else
-			return 3;
-	}
-
-	return -1;
+    return m_network->GetDirection(i, j);
 }
 
 double
-RoutingProtocol::GetMaxBlankLen(std::vector<BlockInfo> block, RoadSegment seg)
+RoutingProtocol::GetMaxBlankLen(RoadSegment seg)
 {
-    double spos = 0, epos = 0;
-    int dir = GetRoadDirection(seg.sjid, seg.ejid);
-    int factor = 0;
-
-    if(dir == 0 || dir == 1)
-    {
-        factor = 1;
-    }
-    else
-    {
-        factor = -1;
-    }
-    
-
-    if(dir == 0 || dir == 2)
-    {
-        spos = m_map[seg.sjid].x;
-        epos = m_map[seg.ejid].x;
-    }
-    else
-    {
-        spos = m_map[seg.sjid].y;
-        epos = m_map[seg.ejid].y;
-    }
-
-    double lmax = -1;
-    for(std::vector<BlockInfo>::iterator pitr = block.begin(); pitr != block.end(); pitr++)
-    {
-        double blen = (pitr->tloc - spos) * factor;
-        if(blen > lmax)
-        {
-            lmax = blen;
-        }
-        spos = pitr->hloc;
-    }
-    if(spos != epos && (epos - spos) * factor > lmax)
-    {
-        lmax = (epos - spos) * factor;
-    }
-    return lmax;
+    return GetBlockTracker(seg).GetMaxBlankLen();
 }
 
 double
-RoutingProtocol::GetMaxBlockLen(std::vector<BlockInfo> block, RoadSegment seg)
+RoutingProtocol::GetMaxBlockLen(RoadSegment seg)
 {
-    int factor = 0;
-    int dir = GetRoadDirection(seg.sjid, seg.ejid);
-
-    if(dir == 0 || dir == 1)
-    {
-        factor = 1;
-    }
-    else
-    {
-        factor = -1;
-    }
-
-    double maxlen = -1;
-    for(std::vector<BlockInfo>::iterator itr = block.begin(); itr != block.end(); itr++)
-    {
-        double len = (itr->hloc - itr->tloc) * factor;
-        if(len > maxlen)
-        {
-            maxlen = len;
-        }
-    }
-    return maxlen;
+    return GetBlockTracker(seg).GetMaxBlockLen();
 }
 
 double
-RoutingProtocol::GetCoverRate(std::vector<BlockInfo> block, RoadSegment seg)
+RoutingProtocol::GetCoverRate(RoadSegment seg)
 {
-    int factor = 0;
-    int dir = GetRoadDirection(seg.sjid, seg.ejid);
-
-    if(dir == 0 || dir == 1)
-    {
-        factor = 1;
-    }
-    else
-    {
-        factor = -1;
-    }
-
-    double sum = 0;
-    double len = sqrt(pow(m_map[seg.sjid].x - m_map[seg.ejid].x, 2) + pow(m_map[seg.sjid].y - m_map[seg.ejid].y, 2));
-    for(std::vector<BlockInfo>::iterator itr = block.begin(); itr != block.end(); itr++)
-    {
-        sum += (itr->hloc - itr->tloc) * factor;
-    }
-    return sum / len;
+    double len = sqrt(pow(m_network->GetJunctionX(seg.sjid) - m_network->GetJunctionX(seg.ejid), 2) + pow(m_network->GetJunctionY(seg.sjid) - m_network->GetJunctionY(seg.ejid), 2));
+    return GetBlockTracker(seg).GetCoveredLen() / len;
 }
 
 double
 RoutingProtocol::CalculateRoadCost(RoadSegment pseg, RoadSegment nseg)
 {
     double cost = INF;
-    std::vector<BlockInfo> pblock = blocklist[pseg];
-    std::vector<BlockInfo> nblock = blocklist[nseg];
-    if(pblock.empty() == false && nblock.empty() == false)
+    BlockTrackerTable::const_iterator pitr = m_blockTrackers.find(pseg);
+    BlockTrackerTable::const_iterator nitr = m_blockTrackers.find(nseg);
+    if(pitr != m_blockTrackers.end() && nitr != m_blockTrackers.end() && pitr->second.GetNBlocks() > 0 && nitr->second.GetNBlocks() > 0)
     {
-        double pblen = GetMaxBlankLen(pblock, pseg);
-        double nblen = GetMaxBlankLen(nblock, nseg);
+        const BlockTracker& pblock = pitr->second;
+        const BlockTracker& nblock = nitr->second;
+        double pblen = pblock.GetMaxBlankLen();
+        double nblen = nblock.GetMaxBlankLen();
         double maxblanklen = 0, maxblocklen = 0;
         
         if(pblen > nblen)
         {
             maxblanklen = pblen;
-            maxblocklen = GetMaxBlockLen(pblock, pseg);
+            maxblocklen = pblock.GetMaxBlockLen();
         }
         else
         {
             maxblanklen = nblen;
-            maxblocklen = GetMaxBlockLen(nblock, nseg);
+            maxblocklen = nblock.GetMaxBlockLen();
         }
 
         double flen = 0;
@@ -409,11 +280,11 @@ RoutingProtocol::CalculateRoadCost(RoadSegment pseg, RoadSegment nseg)
         }
 
         double Ns = 5;
-        double x2 = fabs(pblock.size() - nblock.size()) / Ns;
+        double x2 = fabs((double) pblock.GetNBlocks() - (double) nblock.GetNBlocks()) / Ns;
         double fnum = exp(- PI * x2);
 
-        double x3 = GetCoverRate(pblock, pseg);
-        double x4 = GetCoverRate(nblock, nseg);
+        double x3 = GetCoverRate(pseg);
+        double x4 = GetCoverRate(nseg);
         double pfcov = 1 - exp(-(10 * x3) / PI);
         double nfcov = 1 - exp(-(10 * x4) / PI);
         double fcov = pfcov * nfcov;
@@ -425,109 +296,74 @@ RoutingProtocol::CalculateRoadCost(RoadSegment pseg, RoadSegment nseg)
 }
 
 void 
-RoutingProtocol::GetRoadCostGraph()
+RoutingProtocol::UpdateRoadCostGraph()
 {
-    for(int i = 0; i < jnum; i++)
+    PurgeExpiredBlocks();
+
+    //连通信息过期的路段需要重新计算代价
+    while(m_conExpiry.empty() == false && m_conExpiry.top().first <= Simulator::Now())
     {
-        for(int j = i + 1; j < jnum; j++)
+        std::map<RoadSegment, Time>::const_iterator itr = m_contable.find(m_conExpiry.top().second);
+        if(itr != m_contable.end() && itr->second == m_conExpiry.top().first)
         {
-            CityRoadCostGraph[i][j] = CityRoadCostGraph[j][i] = INF;
-
-            RoadSegment pseg(i, j);
-            RoadSegment nseg(j, i);
-
-            std::map<RoadSegment, Time>::iterator pitr = m_contable.find(pseg);
-            std::map<RoadSegment, Time>::iterator nitr = m_contable.find(nseg);
-            if
-            (
-                pitr != m_contable.end() && pitr->second > Simulator::Now() &&
-                nitr != m_contable.end() && nitr->second > Simulator::Now()
-            )
-            {
-                CityRoadCostGraph[i][j] = CityRoadCostGraph[j][i] = 0;
-            }
-            else
-            {
-                CityRoadCostGraph[i][j] = CityRoadCostGraph[j][i] = CalculateRoadCost(pseg, nseg);
-            }
+            SetSegmentDirty(itr->first.sjid, itr->first.ejid);
         }
+        m_conExpiry.pop();
     }
-}
 
-int
-RoutingProtocol::DijkstraAlgorithm(int srcjid)
-{
-    bool visited[jnum];
-    double distance[jnum];
-    int parent[jnum];
-
-    for(int i = 0; i<jnum; i++)
+    for(std::set<RoadSegment>::const_iterator itr = m_dirtySegments.begin(); itr != m_dirtySegments.end(); itr++)
     {
-        visited[i] = false;
-        distance[i] = INF;
-        parent[i] = -1;
-    }
-
-    visited[srcjid] = true;
-    distance[srcjid] = 0;
+        int i = itr->sjid;
+        int j = itr->ejid;
+        int pedge = m_network->FindEdge(i, j);
+        int nedge = m_network->FindEdge(j, i);
+        if(pedge < 0 && nedge < 0)
+            continue;
 
-    int curr = srcjid;
-    int next = -1;
-    for(int count = 1; curr >= 0 && count <= jnum; count++)
-    {
-        for(int n = 0; n < jnum; n++)
+        RoadSegment pseg(i, j);
+        RoadSegment nseg(j, i);
+        double cost = INF;
+        std::map<RoadSegment, Time>::const_iterator pitr = m_contable.find(pseg);
+        std::map<RoadSegment, Time>::const_iterator nitr = m_contable.find(nseg);
+        if
+        (
+            pitr != m_contable.end() && pitr->second > Simulator::Now() &&
+            nitr != m_contable.end() && nitr->second > Simulator::Now()
+        )
         {
-            if(visited[n] == false && distance[curr] + CityRoadCostGraph[curr][n] < distance[n])
-            {
-                distance[n] = distance[curr] + CityRoadCostGraph[curr][n];
-                parent[n] = curr;
-                next = n;
-            }
+            cost = 0;
         }
-        curr = next;
-        visited[curr] = true;
-    }
-
-    double mincost = INF;
-    int minid = -1;
-    for(std::vector<int>::iterator itr = RSUSet.begin(); itr != RSUSet.end(); itr ++)
-    {
-        if(distance[*itr] < mincost)
+        else
         {
-            mincost = distance[*itr];
-            minid = *itr;
+            cost = CalculateRoadCost(pseg, nseg);
         }
-    }
 
-    while(minid > 0)
-    {
-        if(parent[minid] == srcjid)
-            break;
-        minid = parent[minid];
+        //代价为INF的路段不可用
+        double weight = cost >= INF ? -1 : cost;
+        if(pedge >= 0)
+            m_costTable->SetEdgeWeight(pedge, weight);
+        if(nedge >= 0)
+            m_costTable->SetEdgeWeight(nedge, weight);
     }
-
-    return minid; 
+    m_dirtySegments.clear();
 }
 
 int
 RoutingProtocol::GetNextJunInPath(int src)
 {
-    GetRoadCostGraph();
-    return DijkstraAlgorithm(src);
+    if(m_costTable == 0)
+        return -1;
+    UpdateRoadCostGraph();
+    int next = m_costTable->GetNextJunction(src, RSUSet);
+    //src本身就是RSU路口时没有下一路口
+    if(next == src)
+        return -1;
+    return next;
 }
 
 
 void RoutingProtocol::DoInitialize() 
 {
-  CityRoadCostGraph = new double *[jnum];
-  for(int i = 0;i < jnum; ++i)
-  {
-    CityRoadCostGraph[i] = new double[jnum];
-    for(int j = 0; j<jnum; j++)
-    {
-      CityRoadCostGraph[i][j] = INF;
-    }
-  }
   PrintRoadConInfo();
   AddRSU();
 }
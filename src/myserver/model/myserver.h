@@ -17,9 +17,12 @@
 #include <vector>
 #include <map>
 #include <queue>
-#include <stack>
 #include "ns3/ip-l4-protocol.h"
-#include "ns3/digitalMap.h"
+#include "ns3/road-network.h"
+#include "ns3/junction-route-table.h"
+#include "block-tracker.h"
+#include <set>
+#include <functional>
 
 #define INF 1000000
 #define PI 3.14159265358979323846
@@ -66,6 +69,7 @@ struct RoadSegment
 
 struct BlockMemberInfo
 {
+    //与BlockTracker::MemberType取值相同
     enum VehType
     {
       HEADER = 0,
@@ -88,19 +92,7 @@ struct BlockMemberInfo
 
 };
 
-struct BlockInfo
-{
-    double hloc;
-    double tloc;
-
-    BlockInfo()
-    {
-        
-    }
-};
-
-typedef std::map<RoadSegment, std::vector<BlockMemberInfo>> BlockNodeTable;
-typedef std::map<RoadSegment, std::vector<BlockInfo>> BlockList;
+typedef std::map<RoadSegment, BlockTracker> BlockTrackerTable;
 
 namespace myserver {
 class RoutingProtocol;
@@ -116,7 +108,7 @@ public:
     void SetDownTarget (IpL4Protocol::DownTargetCallback callback);
     void AddHeader(Ptr<Packet> p, Ipv4Address source, Ipv4Address destination, uint8_t protocol, Ptr<Ipv4Route> route);
 
-    void SetDigitalMap(std::vector<DigitalMapEntry> map);
+    void SetDigitalMap(Ptr<const RoadNetwork> network);
     void AddRSU();
     
     void SendRoadConInfoViaLTE(RoadSegment info, Time time);
@@ -127,14 +119,14 @@ public:
     
     int GetRoadDirection(int i, int j);
     int GetNextJunInPath(int src);
-    void UpdateAvailableBlock(RoadSegment seg);
+    //删除路段上过期的车辆块信息
     void PurgeBlockInfo(RoadSegment seg);
-    void GetRoadCostGraph();
+    //只重新计算状态发生变化的路段的代价, 并增量更新到RSU的最短路径
+    void UpdateRoadCostGraph();
     double CalculateRoadCost(RoadSegment pseg, RoadSegment nseg);
-    int DijkstraAlgorithm(int srcjid);
-    double GetMaxBlankLen(std::vector<BlockInfo> block, RoadSegment seg);
-    double GetMaxBlockLen(std::vector<BlockInfo> block, RoadSegment seg);
-    double GetCoverRate(std::vector<BlockInfo> block, RoadSegment seg);
+    double GetMaxBlankLen(RoadSegment seg);
+    double GetMaxBlockLen(RoadSegment seg);
+    double GetCoverRate(RoadSegment seg);
     void PrintRoadConInfo();
 
 protected:
@@ -162,17 +154,29 @@ private:
     virtual void SetIpv4 (Ptr<Ipv4> ipv4);
     virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
     void DoDispose ();
+    //路段(双向)的代价需要重新计算
+    void SetSegmentDirty(int sjid, int ejid);
+    BlockTracker& GetBlockTracker(RoadSegment seg);
+    //删除所有到期的车辆块信息, 代替每次上报都调度一次PurgeBlockInfo
+    void PurgeExpiredBlocks();
 
-    int jnum = 9;
     double insightTransRange = 500;
     int junSinkList[9] = {0};
     double BlockUpdateTime = 1;
 
-    double ** CityRoadCostGraph;
-    BlockList blocklist;
+    //路网各条边的代价, 代价为INF的边不可用
+    Ptr<JunctionRouteTable> m_costTable;
+    //代价待更新的路段, sjid < ejid
+    std::set<RoadSegment> m_dirtySegments;
+    //连通信息的过期时间, 过期后路段代价需要重新计算
+    std::priority_queue<std::pair<Time, RoadSegment>, std::vector<std::pair<Time, RoadSegment> >,
+                        std::greater<std::pair<Time, RoadSegment> > > m_conExpiry;
     std::vector<int> RSUSet;
-    BlockNodeTable m_bnodeTable;
-    std::vector<DigitalMapEntry> m_map;
+    BlockTrackerTable m_blockTrackers;
+    //车辆块信息的过期时间
+    std::priority_queue<std::pair<Time, RoadSegment>, std::vector<std::pair<Time, RoadSegment> >,
+                        std::greater<std::pair<Time, RoadSegment> > > m_blockExpiry;
+    Ptr<const RoadNetwork> m_network;
     std::map<RoadSegment, Time> m_contable;
 
 };
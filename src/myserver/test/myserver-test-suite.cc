@@ -2,6 +2,9 @@
 
 // Include a header file from your module to test.
 #include "ns3/myserver.h"
+#include "ns3/simulator.h"
+#include "ns3/block-tracker.h"
+#include <algorithm>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +49,264 @@ MyserverTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Check that the controller follows the connectivity reports of the road
+// segments when it answers next junction queries
+class MyserverNextJunctionTestCase : public TestCase
+{
+public:
+  MyserverNextJunctionTestCase ();
+  virtual ~MyserverNextJunctionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void AddEdge (std::vector<DigitalMapEntry> &map, int a, int b);
+  void ReportConnected (int a, int b, Time expiry);
+  void CheckNextJunction (int src, int expected);
+
+  Ptr<myserver::RoutingProtocol> m_server;
+};
+
+MyserverNextJunctionTestCase::MyserverNextJunctionTestCase ()
+  : TestCase ("Next junction towards the RSU follows the segment reports")
+{
+}
+
+MyserverNextJunctionTestCase::~MyserverNextJunctionTestCase ()
+{
+}
+
+void
+MyserverNextJunctionTestCase::AddEdge (std::vector<DigitalMapEntry> &map, int a, int b)
+{
+  std::vector<float> edge (3, 0);
+  map[a].outedge[b] = edge;
+  map[a].edgeNum++;
+  map[b].outedge[a] = edge;
+  map[b].edgeNum++;
+}
+
+void
+MyserverNextJunctionTestCase::ReportConnected (int a, int b, Time expiry)
+{
+  m_server->SendRoadConInfoViaLTE (RoadSegment (a, b), expiry);
+  m_server->SendRoadConInfoViaLTE (RoadSegment (b, a), expiry);
+}
+
+void
+MyserverNextJunctionTestCase::CheckNextJunction (int src, int expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_server->GetNextJunInPath (src), expected,
+                         "Wrong next junction of " << src << " at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+MyserverNextJunctionTestCase::DoRun (void)
+{
+  // 0 1 2
+  // 3 4 5, the RSU is at junction 3
+  std::vector<DigitalMapEntry> map (6);
+  for (int i = 0; i < 6; i++)
+    {
+      map[i].x = (i % 3) * 100;
+      map[i].y = (i / 3) * 100;
+      map[i].edgeNum = 0;
+    }
+  AddEdge (map, 0, 1);
+  AddEdge (map, 1, 2);
+  AddEdge (map, 3, 4);
+  AddEdge (map, 4, 5);
+  AddEdge (map, 0, 3);
+  AddEdge (map, 1, 4);
+  AddEdge (map, 2, 5);
+
+  m_server = CreateObject<myserver::RoutingProtocol> ();
+  m_server->SetDigitalMap (Create<RoadNetwork> (map, std::vector<VTrace> ()));
+  m_server->AddRSU ();
+
+  // 2 -> 1 -> 0 -> 3 is connected until 5s
+  ReportConnected (2, 1, Seconds (5));
+  ReportConnected (1, 0, Seconds (5));
+  ReportConnected (0, 3, Seconds (5));
+  Simulator::Schedule (Seconds (1), &MyserverNextJunctionTestCase::CheckNextJunction, this, 2, 1);
+  Simulator::Schedule (Seconds (1), &MyserverNextJunctionTestCase::CheckNextJunction, this, 4, -1);
+  Simulator::Schedule (Seconds (1), &MyserverNextJunctionTestCase::CheckNextJunction, this, 3, -1);
+  // 2 -> 5 -> 4 -> 3 is connected until 10s
+  Simulator::Schedule (Seconds (2), &MyserverNextJunctionTestCase::ReportConnected, this, 2, 5, Seconds (10));
+  Simulator::Schedule (Seconds (2), &MyserverNextJunctionTestCase::ReportConnected, this, 5, 4, Seconds (10));
+  Simulator::Schedule (Seconds (2), &MyserverNextJunctionTestCase::ReportConnected, this, 4, 3, Seconds (10));
+  Simulator::Schedule (Seconds (3), &MyserverNextJunctionTestCase::CheckNextJunction, this, 4, 3);
+  Simulator::Schedule (Seconds (6), &MyserverNextJunctionTestCase::CheckNextJunction, this, 2, 5);
+  Simulator::Schedule (Seconds (6), &MyserverNextJunctionTestCase::CheckNextJunction, this, 0, -1);
+  // the first path is reported again
+  Simulator::Schedule (Seconds (7), &MyserverNextJunctionTestCase::ReportConnected, this, 0, 3, Seconds (20));
+  Simulator::Schedule (Seconds (8), &MyserverNextJunctionTestCase::CheckNextJunction, this, 0, 3);
+  Simulator::Schedule (Seconds (11), &MyserverNextJunctionTestCase::CheckNextJunction, this, 2, -1);
+  Simulator::Schedule (Seconds (11), &MyserverNextJunctionTestCase::CheckNextJunction, this, 0, 3);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_server->Dispose ();
+  m_server = 0;
+}
+
+// Check the incremental block aggregates against a scan of the members
+class BlockTrackerTestCase : public TestCase
+{
+public:
+  BlockTrackerTestCase ();
+  virtual ~BlockTrackerTestCase ();
+
+private:
+  struct Member
+  {
+    double offset;
+    int id;
+    BlockTracker::MemberType type;
+    bool operator< (const Member &o) const
+    {
+      return offset < o.offset || (offset == o.offset && id < o.id);
+    }
+  };
+
+  virtual void DoRun (void);
+  void Check (const BlockTracker &tracker, std::map<int, Member> members);
+};
+
+BlockTrackerTestCase::BlockTrackerTestCase ()
+  : TestCase ("Incremental block tracking of a road segment")
+{
+}
+
+BlockTrackerTestCase::~BlockTrackerTestCase ()
+{
+}
+
+void
+BlockTrackerTestCase::Check (const BlockTracker &tracker, std::map<int, Member> members)
+{
+  std::vector<Member> sorted;
+  for (std::map<int, Member>::const_iterator itr = members.begin (); itr != members.end (); itr++)
+    {
+      sorted.push_back (itr->second);
+    }
+  std::sort (sorted.begin (), sorted.end ());
+
+  std::vector<std::pair<double, double> > blocks;
+  bool open = false;
+  double start = 0;
+  for (std::vector<Member>::const_iterator itr = sorted.begin (); itr != sorted.end (); itr++)
+    {
+      if (itr->type != BlockTracker::ISOLATED)
+        {
+          open = (itr->type == BlockTracker::HEADER);
+          break;
+        }
+    }
+  for (std::vector<Member>::const_iterator itr = sorted.begin (); itr != sorted.end (); itr++)
+    {
+      if (itr->type == BlockTracker::ISOLATED && !open)
+        {
+          blocks.push_back (std::make_pair (itr->offset, itr->offset));
+        }
+      else if (itr->type == BlockTracker::TAILER && !open)
+        {
+          open = true;
+          start = itr->offset;
+        }
+      else if (itr->type == BlockTracker::HEADER && open)
+        {
+          blocks.push_back (std::make_pair (start, itr->offset));
+          open = false;
+        }
+    }
+  if (open)
+    {
+      blocks.push_back (std::make_pair (start, tracker.GetLength ()));
+    }
+
+  double maxBlank = 0, maxBlock = -1, covered = 0, end = 0;
+  for (std::vector<std::pair<double, double> >::const_iterator itr = blocks.begin (); itr != blocks.end (); itr++)
+    {
+      maxBlank = std::max (maxBlank, itr->first - end);
+      maxBlock = std::max (maxBlock, itr->second - itr->first);
+      covered += itr->second - itr->first;
+      end = itr->second;
+    }
+  maxBlank = std::max (maxBlank, tracker.GetLength () - end);
+
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNMembers (), sorted.size (), "Wrong number of members");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNBlocks (), blocks.size (), "Wrong number of blocks");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetMaxBlankLen (), maxBlank, 1e-6, "Wrong max blank length");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetMaxBlockLen (), maxBlock, 1e-6, "Wrong max block length");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetCoveredLen (), covered, 1e-6, "Wrong covered length");
+}
+
+void
+BlockTrackerTestCase::DoRun (void)
+{
+  BlockTracker tracker;
+  tracker.SetLength (100);
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetMaxBlankLen (), 100, 1e-6, "An empty segment is blank");
+
+  tracker.Update (1, BlockTracker::TAILER, 10, Seconds (1));
+  tracker.Update (2, BlockTracker::HEADER, 30, Seconds (1));
+  tracker.Update (3, BlockTracker::ISOLATED, 50, Seconds (2));
+  tracker.Update (4, BlockTracker::TAILER, 70, Seconds (2));
+  // [10,30] [50,50] [70,100]
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNBlocks (), 3, "Wrong number of blocks");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetMaxBlankLen (), 20, 1e-6, "Wrong max blank length");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetMaxBlockLen (), 30, 1e-6, "Wrong max block length");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetCoveredLen (), 50, 1e-6, "Wrong covered length");
+
+  // [0,5] [10,30] [50,50] [70,100]
+  tracker.Update (5, BlockTracker::HEADER, 5, Seconds (3));
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNBlocks (), 4, "Wrong number of blocks");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetCoveredLen (), 55, 1e-6, "Wrong covered length");
+
+  // the vehicle 2 moves on, [0,5] [10,80]
+  tracker.Update (2, BlockTracker::HEADER, 80, Seconds (3));
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNBlocks (), 2, "Wrong number of blocks");
+  NS_TEST_ASSERT_MSG_EQ_TOL (tracker.GetMaxBlockLen (), 70, 1e-6, "Wrong max block length");
+
+  NS_TEST_ASSERT_MSG_EQ (tracker.Expire (Seconds (1.5)), true, "Vehicle 1 should expire");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNMembers (), 4, "Wrong number of members");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Expire (Seconds (1.5)), false, "Nothing else expires");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNextExpiry (), Seconds (2), "Wrong next expiry");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Remove (1), false, "Vehicle 1 already expired");
+
+  // random updates and removals
+  BlockTracker random;
+  random.SetLength (300);
+  std::map<int, Member> members;
+  uint32_t seed = 4321;
+  for (int step = 0; step < 2000; step++)
+    {
+      seed = seed * 1103515245 + 12345;
+      int id = (seed >> 8) % 40;
+      seed = seed * 1103515245 + 12345;
+      uint32_t r = (seed >> 8) % 1000;
+      if (r < 250)
+        {
+          random.Remove (id);
+          members.erase (id);
+        }
+      else
+        {
+          Member member;
+          member.id = id;
+          // few distinct offsets so that members share positions
+          member.offset = (r % 31) * 10;
+          member.type = (BlockTracker::MemberType) (r % 3);
+          if (member.offset > 300)
+            {
+              member.offset = 300;
+            }
+          random.Update (id, member.type, member.offset, Seconds (step));
+          members[id] = member;
+        }
+      Check (random, members);
+    }
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +322,8 @@ MyserverTestSuite::MyserverTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new MyserverTestCase1, TestCase::QUICK);
+  AddTestCase (new MyserverNextJunctionTestCase, TestCase::QUICK);
+  AddTestCase (new BlockTrackerTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
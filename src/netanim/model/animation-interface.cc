@@ -59,6 +59,9 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/energy-source-container.h"
 #include "animation-interface.h"
+#ifdef NS3_NETANIM_ZLIB
+#include <zlib.h>
+#endif
 
 namespace ns3 {
 
@@ -83,6 +86,13 @@ AnimationInterface::AnimationInterface (const std::string fn)
     m_startTime (Seconds (0)), 
     m_stopTime (Seconds (3600 * 1000)),
     m_maxPktsPerFile (MAX_PKTS_PER_TRACE_FILE), 
+    m_mobilityUpdateThreshold (0),
+    m_packetSamplingInterval (1),
+    m_sampledPktCount (0),
+    m_outputBufferSize (1 << 20),
+    m_outputWritten (false),
+    m_compress (false),
+    m_zstream (0),
     m_originalFileName (fn),
     m_routingStopTime (Seconds (0)), 
     m_routingFileName (""),
@@ -291,6 +301,45 @@ AnimationInterface::SetMobilityPollInterval (Time t)
   m_mobilityPollInterval = t;
 }
 
+void 
+AnimationInterface::SetMobilityUpdateThreshold (double distance)
+{
+  m_mobilityUpdateThreshold = distance;
+}
+
+void 
+AnimationInterface::SetPacketSamplingInterval (uint32_t interval)
+{
+  NS_ASSERT (interval > 0);
+  m_packetSamplingInterval = interval;
+}
+
+void 
+AnimationInterface::SetOutputBufferSize (uint32_t size)
+{
+  m_outputBufferSize = size;
+  if (m_outputBuffer.size () >= m_outputBufferSize)
+    {
+      FlushOutput ();
+    }
+}
+
+void 
+AnimationInterface::EnableCompression (bool enable)
+{
+#ifndef NS3_NETANIM_ZLIB
+  if (enable)
+    {
+      NS_FATAL_ERROR ("Compression of the trace file needs ns-3 to be configured with zlib");
+    }
+#endif
+  if (m_outputWritten && enable != m_compress)
+    {
+      NS_FATAL_ERROR ("Compression must be set before the trace file is written");
+    }
+  m_compress = enable;
+}
+
 
 void 
 AnimationInterface::SetConstantPosition (Ptr <Node> n, double x, double y, double z)
@@ -426,6 +475,17 @@ AnimationInterface::MobilityCourseChangeTrace (Ptr <const MobilityModel> mobilit
 bool 
 AnimationInterface::NodeHasMoved (Ptr <Node> n, Vector newLocation)
 {
+  if (m_mobilityUpdateThreshold > 0)
+    {
+      std::map <uint32_t, Vector>::const_iterator written = m_nodeWrittenLocation.find (n->GetId ());
+      if (written == m_nodeWrittenLocation.end ())
+        {
+          return true;
+        }
+      double dx = newLocation.x - written->second.x;
+      double dy = newLocation.y - written->second.y;
+      return dx * dx + dy * dy > m_mobilityUpdateThreshold * m_mobilityUpdateThreshold;
+    }
   Vector oldLocation = GetPosition (n);
   bool moved = true;
   if ((ceil (oldLocation.x) == ceil (newLocation.x)) &&
@@ -516,6 +576,16 @@ AnimationInterface::WriteN (const char* data, uint32_t count, FILE * f)
     {
       return 0;
     }
+  if (f == m_f)
+    {
+      // The trace is written by blocks
+      m_outputBuffer.append (data, count);
+      if (m_outputBuffer.size () >= m_outputBufferSize)
+        {
+          FlushOutput ();
+        }
+      return count;
+    }
   // Write count bytes to h from data
   uint32_t    nLeft   = count;
   const char* p       = data;
@@ -534,6 +604,72 @@ AnimationInterface::WriteN (const char* data, uint32_t count, FILE * f)
   return written;
 }
 
+void 
+AnimationInterface::FlushOutput (bool finish)
+{
+  if (!m_f || (m_outputBuffer.empty () && !finish))
+    {
+      return;
+    }
+  m_outputWritten = true;
+  if (!m_compress)
+    {
+      if (std::fwrite (m_outputBuffer.data (), 1, m_outputBuffer.size (), m_f) != m_outputBuffer.size ())
+        {
+          NS_LOG_WARN ("Unable to write to the trace file " << m_outputFileName);
+        }
+      m_outputBuffer.clear ();
+      return;
+    }
+#ifdef NS3_NETANIM_ZLIB
+  if (!m_zstream)
+    {
+      m_zstream = new z_stream ();
+      // 15 + 16: the largest window, with a gzip header
+      if (deflateInit2 (m_zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+          NS_FATAL_ERROR ("Unable to initialize the compression of " << m_outputFileName);
+        }
+    }
+  m_zstream->next_in = reinterpret_cast<Bytef *> (const_cast<char *> (m_outputBuffer.data ()));
+  m_zstream->avail_in = m_outputBuffer.size ();
+  int ret;
+  do
+    {
+      Bytef out[65536];
+      m_zstream->next_out = out;
+      m_zstream->avail_out = sizeof (out);
+      ret = deflate (m_zstream, finish ? Z_FINISH : Z_NO_FLUSH);
+      NS_ASSERT (ret != Z_STREAM_ERROR);
+      uint32_t n = sizeof (out) - m_zstream->avail_out;
+      if (std::fwrite (out, 1, n, m_f) != n)
+        {
+          NS_LOG_WARN ("Unable to write to the trace file " << m_outputFileName);
+        }
+    }
+  while (m_zstream->avail_out == 0 || (finish && ret != Z_STREAM_END));
+  m_outputBuffer.clear ();
+  if (finish)
+    {
+      deflateEnd (m_zstream);
+      delete m_zstream;
+      m_zstream = 0;
+    }
+#endif
+}
+
+bool
+AnimationInterface::IsPacketSampled (uint64_t animUid) const
+{
+  return animUid % m_packetSamplingInterval == 0;
+}
+
+bool
+AnimationInterface::SamplePacket ()
+{
+  return m_sampledPktCount++ % m_packetSamplingInterval == 0;
+}
+
 void 
 AnimationInterface::WriteRoutePath (uint32_t nodeId, std::string destination, Ipv4RoutePathElements rpElements)
 {
@@ -791,6 +927,10 @@ AnimationInterface::DevTxTrace (std::string context,
   double lbTx = (now + txTime).GetSeconds ();
   double fbRx = (now + rxTime - txTime).GetSeconds ();
   double lbRx = (now + rxTime).GetSeconds ();
+  if (!SamplePacket ())
+    {
+      return;
+    }
   CheckMaxPktsPerTraceFile ();
   WriteXmlP ("p", 
              tx->GetNode ()->GetId (), 
@@ -1217,6 +1357,10 @@ AnimationInterface::CsmaMacRxTrace (std::string context,
 void
 AnimationInterface::OutputWirelessPacketTxInfo (Ptr<const Packet> p, AnimPacketInfo &pktInfo, uint64_t animUid)
 {
+  if (!IsPacketSampled (animUid))
+    {
+      return;
+    }
   CheckMaxPktsPerTraceFile ();
   uint32_t nodeId = 0;
   if (pktInfo.m_txnd)
@@ -1233,6 +1377,10 @@ AnimationInterface::OutputWirelessPacketTxInfo (Ptr<const Packet> p, AnimPacketI
 void 
 AnimationInterface::OutputWirelessPacketRxInfo (Ptr<const Packet> p, AnimPacketInfo & pktInfo, uint64_t animUid)
 {
+  if (!IsPacketSampled (animUid))
+    {
+      return;
+    }
   CheckMaxPktsPerTraceFile ();
   uint32_t rxId = pktInfo.m_rxnd->GetNode ()->GetId ();
   WriteXmlP (animUid, "wpr", rxId, pktInfo.m_fbRx, pktInfo.m_lbRx);
@@ -1241,6 +1389,10 @@ AnimationInterface::OutputWirelessPacketRxInfo (Ptr<const Packet> p, AnimPacketI
 void 
 AnimationInterface::OutputCsmaPacket (Ptr<const Packet> p, AnimPacketInfo &pktInfo)
 {
+  if (!SamplePacket ())
+    {
+      return;
+    }
   CheckMaxPktsPerTraceFile ();
   NS_ASSERT (pktInfo.m_txnd);
   uint32_t nodeId = pktInfo.m_txnd->GetNode ()->GetId ();
@@ -1441,6 +1593,7 @@ AnimationInterface::StopAnimation (bool onlyAnimation)
     {
       // Terminate the anim element
       WriteXmlClose ("anim");
+      FlushOutput (true);
       std::fclose (m_f);
       m_f = 0;
     }
@@ -2426,6 +2579,7 @@ AnimationInterface::WriteXmlNode (uint32_t id, uint32_t sysId, double locX, doub
   element.AddAttribute ("locX", locX);
   element.AddAttribute ("locY", locY);
   WriteN (element.ToString (), m_f);
+  m_nodeWrittenLocation[id] = Vector (locX, locY, 0);
 }
 
 void 
@@ -2628,6 +2782,7 @@ AnimationInterface::WriteXmlUpdateNodePosition (uint32_t nodeId, double x, doubl
   element.AddAttribute ("x", x);
   element.AddAttribute ("y", y);
   WriteN (element.ToString (), m_f);
+  m_nodeWrittenLocation[nodeId] = Vector (x, y, 0);
 }
 
 void 
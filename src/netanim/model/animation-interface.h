@@ -45,6 +45,8 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-l3-protocol.h"
 
+struct z_stream_s;
+
 namespace ns3 {
 
 #define MAX_PKTS_PER_TRACE_FILE 10000000
@@ -222,6 +224,57 @@ public:
    */
   void SetMobilityPollInterval (Time t);
 
+  /**
+   * \brief Set the distance a node must move before its polled position
+   * is written again
+   *
+   * \param distance The positions fetched every mobility poll interval
+   * are written only for the nodes that moved by more than this distance
+   * (in meters) since their last written position. Course changes are
+   * always written.
+   * Default: 0, a position is written as soon as it changes by one meter
+   *
+   * \returns none
+   */
+  void SetMobilityUpdateThreshold (double distance);
+
+  /**
+   * \brief Trace only a sample of the packets
+   *
+   * \param interval One packet out of interval is written to the trace
+   * file, the others are neither written nor counted in the packets per
+   * trace file.
+   * Default: 1, all the packets are traced
+   *
+   * \returns none
+   */
+  void SetPacketSamplingInterval (uint32_t interval);
+
+  /**
+   * \brief Set the size of the output buffer
+   *
+   * \param size The trace is accumulated in memory and written to the
+   * trace file (and compressed, if enabled) by blocks of size bytes.
+   * 0 writes every element as soon as it is generated.
+   * Default: 1 MiB
+   *
+   * \returns none
+   */
+  void SetOutputBufferSize (uint32_t size);
+
+  /**
+   * \brief Compress the trace file with gzip
+   *
+   * \param enable if true, the trace file is written in the gzip format,
+   * which must be decompressed (e.g. with gunzip) before being loaded in
+   * NetAnim. It must be called before the first block of the trace is
+   * written, that is right after the construction of the
+   * AnimationInterface, and needs ns-3 to be configured with zlib.
+   *
+   * \returns none
+   */
+  void EnableCompression (bool enable = true);
+
   /**
    * \brief Set a callback function to listen to AnimationInterface write events
    *
@@ -619,6 +672,14 @@ private:
   Time m_startTime; ///< start time
   Time m_stopTime; ///< stop time
   uint64_t m_maxPktsPerFile; ///< maximum pakets per file
+  double m_mobilityUpdateThreshold; ///< distance to move before a polled position is written
+  uint32_t m_packetSamplingInterval; ///< one packet out of this number is traced
+  uint64_t m_sampledPktCount; ///< number of wired packets seen by the sampling
+  std::string m_outputBuffer; ///< output not written to the trace file yet
+  uint32_t m_outputBufferSize; ///< size of the output buffer
+  bool m_outputWritten; ///< whether a block was written to the trace file
+  bool m_compress; ///< compress the trace file
+  z_stream_s * m_zstream; ///< compression state (0 if none)
   std::string m_originalFileName; ///< original file name
   Time m_routingStopTime; ///< routing stop time
   std::string m_routingFileName; ///< routing file name
@@ -663,6 +724,7 @@ private:
   AnimUidPacketInfoMap m_pendingWavePackets; ///< pending WAVE packets
 
   std::map <uint32_t, Vector> m_nodeLocation; ///< node location
+  std::map <uint32_t, Vector> m_nodeWrittenLocation; ///< node location last written
   std::map <std::string, uint32_t> m_macToNodeIdMap; ///< MAC to node ID map
   std::map <std::string, uint32_t> m_ipv4ToNodeIdMap; ///< IPv4 to node ID map
   std::map <std::string, uint32_t> m_ipv6ToNodeIdMap; ///< IPv6 to node ID map
@@ -769,6 +831,22 @@ private:
    * \returns the number of bytes written
    */
   int WriteN (const std::string& st, FILE * f);
+  /**
+   * Write the output buffer to the trace file
+   * \param finish if true, also terminate the compressed stream
+   */
+  void FlushOutput (bool finish = false);
+  /**
+   * Sampling of the wireless packets
+   * \param animUid the UID of the packet
+   * \returns true if the packet is traced
+   */
+  bool IsPacketSampled (uint64_t animUid) const;
+  /**
+   * Sampling of the wired packets
+   * \returns true if the packet is traced
+   */
+  bool SamplePacket ();
   /**
    * Get MAC address function
    * \param nd the device
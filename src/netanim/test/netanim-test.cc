@@ -18,6 +18,7 @@
  */
 
 #include <iostream>
+#include <fstream>
 #include "unistd.h"
 
 #include "ns3/core-module.h"
@@ -29,6 +30,11 @@
 #include "ns3/point-to-point-layout-module.h"
 #include "ns3/basic-energy-source.h"
 #include "ns3/simple-device-energy-model.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#ifdef NS3_NETANIM_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace ns3;
 
@@ -68,19 +74,21 @@ protected:
 
   NodeContainer m_nodes; ///< the nodes
   AnimationInterface* m_anim; ///< animation
+  const char* m_traceFileName; ///< trace file name
 
 private:
 
   /// Prepare network function
   virtual void PrepareNetwork () = 0;
 
+  /// Configure the animation, once created
+  virtual void ConfigureAnimation ();
+
   /// Check logic function
   virtual void CheckLogic () = 0;
 
   /// Check file existence
   virtual void CheckFileExistence ();
-
-  const char* m_traceFileName; ///< trace file name
 };
 
 AbstractAnimationInterfaceTestCase::AbstractAnimationInterfaceTestCase (std::string name) :
@@ -99,6 +107,7 @@ AbstractAnimationInterfaceTestCase::DoRun (void)
   PrepareNetwork ();
 
   m_anim = new AnimationInterface (m_traceFileName);
+  ConfigureAnimation ();
 
   Simulator::Run ();
   CheckLogic ();
@@ -106,6 +115,11 @@ AbstractAnimationInterfaceTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+void
+AbstractAnimationInterfaceTestCase::ConfigureAnimation ()
+{
+}
+
 void
 AbstractAnimationInterfaceTestCase::CheckFileExistence ()
 {
@@ -253,6 +267,214 @@ AnimationRemainingEnergyTestCase::CheckLogic (void)
                             "Wrong remaining energy value was traced");
 }
 
+/**
+ * \ingroup netanim-test
+ * \ingroup tests
+ *
+ * \brief Animation Sampling Test Case
+ *
+ * Checks the sampling of the packets and the threshold on the position
+ * updates.
+ */
+class AnimationSamplingTestCase : public AbstractAnimationInterfaceTestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  AnimationSamplingTestCase ();
+
+private:
+
+  virtual void
+  PrepareNetwork ();
+
+  virtual void
+  ConfigureAnimation ();
+
+  virtual void
+  CheckLogic ();
+
+};
+
+AnimationSamplingTestCase::AnimationSamplingTestCase () :
+  AbstractAnimationInterfaceTestCase ("Verify packet sampling and position update threshold")
+{
+}
+
+void
+AnimationSamplingTestCase::PrepareNetwork (void)
+{
+  m_nodes.Create (2);
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (m_nodes);
+  m_nodes.Get (0)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (1, 0, 0));
+  m_nodes.Get (1)->GetObject<MobilityModel> ()->SetPosition (Vector (1, 10, 0));
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  NetDeviceContainer devices;
+  devices = pointToPoint.Install (m_nodes);
+
+  InternetStackHelper stack;
+  stack.Install (m_nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  UdpEchoServerHelper echoServer (9);
+
+  ApplicationContainer serverApps = echoServer.Install (m_nodes.Get (1));
+  serverApps.Start (Seconds (1.0));
+  serverApps.Stop (Seconds (10.0));
+
+  UdpEchoClientHelper echoClient (interfaces.GetAddress (1), 9);
+  echoClient.SetAttribute ("MaxPackets", UintegerValue (100));
+  echoClient.SetAttribute ("Interval", TimeValue (Seconds (1.0)));
+  echoClient.SetAttribute ("PacketSize", UintegerValue (1024));
+
+  ApplicationContainer clientApps = echoClient.Install (m_nodes.Get (0));
+  clientApps.Start (Seconds (2.0));
+  clientApps.Stop (Seconds (10.0));
+  Simulator::Stop (Seconds (10.1));
+}
+
+void
+AnimationSamplingTestCase::ConfigureAnimation (void)
+{
+  m_anim->SetPacketSamplingInterval (4);
+  m_anim->SetMobilityUpdateThreshold (2);
+}
+
+void
+AnimationSamplingTestCase::CheckLogic (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_anim->GetTracePktCount (), 4, "Expected 4 packets out of 16 traced");
+  // the trace is complete once the animation is stopped
+  delete m_anim;
+  m_anim = 0;
+  std::ifstream trace (m_traceFileName);
+  std::string line;
+  std::string lastLine;
+  uint32_t nUpdates = 0;
+  while (std::getline (trace, line))
+    {
+      lastLine = line;
+      if (line.find ("<nu p=\"p\"") != std::string::npos)
+        {
+          nUpdates++;
+        }
+    }
+  // node 0 moves by 1 m/s, polled every 0.25 s: updated at 2.25, 4.5, 6.75 and 9 s
+  NS_TEST_ASSERT_MSG_EQ (nUpdates, 4, "Expected 4 position updates");
+  NS_TEST_ASSERT_MSG_EQ (lastLine, "</anim>", "Trace file is not terminated");
+}
+
+#ifdef NS3_NETANIM_ZLIB
+/**
+ * \ingroup netanim-test
+ * \ingroup tests
+ *
+ * \brief Animation Compression Test Case
+ */
+class AnimationCompressionTestCase : public AbstractAnimationInterfaceTestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  AnimationCompressionTestCase ();
+
+private:
+
+  virtual void
+  PrepareNetwork ();
+
+  virtual void
+  ConfigureAnimation ();
+
+  virtual void
+  CheckLogic ();
+
+};
+
+AnimationCompressionTestCase::AnimationCompressionTestCase () :
+  AbstractAnimationInterfaceTestCase ("Verify compressed trace file")
+{
+}
+
+void
+AnimationCompressionTestCase::PrepareNetwork (void)
+{
+  m_nodes.Create (2);
+  AnimationInterface::SetConstantPosition (m_nodes.Get (0), 0 , 10);
+  AnimationInterface::SetConstantPosition (m_nodes.Get (1), 1 , 10);
+
+  PointToPointHelper pointToPoint;
+  NetDeviceContainer devices = pointToPoint.Install (m_nodes);
+
+  InternetStackHelper stack;
+  stack.Install (m_nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  UdpEchoServerHelper echoServer (9);
+  ApplicationContainer serverApps = echoServer.Install (m_nodes.Get (1));
+  serverApps.Start (Seconds (1.0));
+  serverApps.Stop (Seconds (10.0));
+
+  UdpEchoClientHelper echoClient (interfaces.GetAddress (1), 9);
+  echoClient.SetAttribute ("MaxPackets", UintegerValue (100));
+  echoClient.SetAttribute ("Interval", TimeValue (Seconds (1.0)));
+  ApplicationContainer clientApps = echoClient.Install (m_nodes.Get (0));
+  clientApps.Start (Seconds (2.0));
+  clientApps.Stop (Seconds (10.0));
+}
+
+void
+AnimationCompressionTestCase::ConfigureAnimation (void)
+{
+  m_anim->EnableCompression ();
+  // several blocks
+  m_anim->SetOutputBufferSize (512);
+}
+
+void
+AnimationCompressionTestCase::CheckLogic (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_anim->GetTracePktCount (), 16, "Expected 16 packets traced");
+  delete m_anim;
+  m_anim = 0;
+  gzFile trace = gzopen (m_traceFileName, "rb");
+  NS_TEST_ASSERT_MSG_NE (trace, 0, "Unable to open the trace file");
+  NS_TEST_EXPECT_MSG_EQ (gzdirect (trace), 0, "Trace file is not compressed");
+  std::string content;
+  char buffer[4096];
+  int n;
+  while ((n = gzread (trace, buffer, sizeof (buffer))) > 0)
+    {
+      content.append (buffer, n);
+    }
+  gzclose (trace);
+  NS_TEST_ASSERT_MSG_EQ (content.compare (0, 5, "<anim"), 0, "Wrong start of the trace");
+  NS_TEST_ASSERT_MSG_GT (content.size (), 8, "Trace file too short");
+  NS_TEST_ASSERT_MSG_EQ (content.substr (content.size () - 8), "</anim>\n", "Trace file is not terminated");
+  uint32_t nPackets = 0;
+  for (std::string::size_type i = content.find ("<p "); i != std::string::npos; i = content.find ("<p ", i + 1))
+    {
+      nPackets++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (nPackets, 16, "Expected 16 packets in the decompressed trace");
+}
+#endif
+
 /**
  * \ingroup netanim-test
  * \ingroup tests
@@ -267,5 +489,9 @@ public:
   {
     AddTestCase (new AnimationInterfaceTestCase (), TestCase::QUICK);
     AddTestCase (new AnimationRemainingEnergyTestCase (), TestCase::QUICK);
+    AddTestCase (new AnimationSamplingTestCase (), TestCase::QUICK);
+#ifdef NS3_NETANIM_ZLIB
+    AddTestCase (new AnimationCompressionTestCase (), TestCase::QUICK);
+#endif
   }
 } g_animationInterfaceTestSuite; ///< the test suite
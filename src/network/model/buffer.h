@@ -25,8 +25,6 @@
 #include <ostream>
 #include "ns3/assert.h"
 
-#define BUFFER_FREE_LIST 1
-
 namespace ns3 {
 
 /**
@@ -789,19 +787,6 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
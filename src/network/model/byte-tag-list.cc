@@ -18,13 +18,12 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "slab-allocator.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
 #include <limits>
 
-#define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
 namespace ns3 {
@@ -45,33 +44,6 @@ struct ByteTagListData {
   uint8_t data[4]; //!< data
 };
 
-#ifdef USE_FREE_LIST
-/**
- * \ingroup packet
- *
- * \brief Container class for struct ByteTagListData
- *
- * Internal use only.
- */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
-}
-#endif /* USE_FREE_LIST */
-
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
   : buf (buf_)
 {
@@ -339,30 +311,15 @@ ByteTagList::AddAtStart (int32_t prependOffset)
   *this = list;
 }
 
-#ifdef USE_FREE_LIST
-
 struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
-    {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
-      if (data->size >= size)
-        {
-          data->count = 1;
-          data->dirty = 0;
-          return data;
-        }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
-    }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
+  // the data take all the room of the size class of the block
+  std::size_t capacity = SlabAllocator::GetCapacity (size + sizeof (struct ByteTagListData) - 4);
+  struct ByteTagListData *data = static_cast<struct ByteTagListData *> (SlabAllocator::Allocate (capacity));
   data->count = 1;
-  data->size = size;
+  data->size = capacity + 4 - sizeof (struct ByteTagListData);
   data->dirty = 0;
   return data;
 }
@@ -375,54 +332,11 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  g_maxSize = std::max (g_maxSize, data->size);
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
-        {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
-        }
-      else
-        {
-          g_freeList.push_back (data);
-        }
+      SlabAllocator::Deallocate (data, data->size + sizeof (struct ByteTagListData) - 4);
     }
 }
 
-#else /* USE_FREE_LIST */
-
-struct ByteTagListData *
-ByteTagList::Allocate (uint32_t size)
-{
-  NS_LOG_FUNCTION (this << size);
-  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
-  data->count = 1;
-  data->size = size;
-  data->dirty = 0;
-  return data;
-}
-
-void 
-ByteTagList::Deallocate (struct ByteTagListData *data)
-{
-  NS_LOG_FUNCTION (this << data);
-  if (data == 0)
-    {
-      return;
-    }
-  data->count--;
-  if (data->count == 0)
-    {
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
-    }
-}
-
-#endif /* USE_FREE_LIST */
-
-
 } // namespace ns3
@@ -19,6 +19,7 @@
  */
 #include <utility>
 #include <list>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -33,6 +34,7 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_headerStack = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
@@ -70,6 +72,21 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableHeaderStack (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_headerStack = true;
+}
+
+void
+PacketMetadata::DisableHeaderStack (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_headerStack = false;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +150,10 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (IsHeaderStack ())
+    {
+      return m_stack.headers + m_stack.trailers <= PACKET_METADATA_STACK_SIZE;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -639,6 +660,245 @@ PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
   delete [] buf;
 }
 
+uint32_t
+PacketMetadata::GetStackItemCount (void) const
+{
+  return m_stack.headers + (m_stack.payload > 0 ? 1 : 0) + m_stack.trailers;
+}
+void
+PacketMetadata::ReadStackItem (uint32_t index,
+                               struct PacketMetadata::SmallItem *item,
+                               struct PacketMetadata::ExtraItem *extraItem) const
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT (index < GetStackItemCount ());
+  item->next = 0xffff;
+  item->prev = 0xffff;
+  item->chunkUid = 0;
+  if (index < m_stack.headers)
+    {
+      const struct StackItem &header = m_stack.items[m_stack.headers - 1 - index];
+      item->typeUid = header.typeUid << 1;
+      item->size = header.size;
+    }
+  else if (index == m_stack.headers && m_stack.payload > 0)
+    {
+      item->typeUid = 0;
+      item->size = m_stack.payload;
+    }
+  else
+    {
+      index = GetStackItemCount () - 1 - index;
+      const struct StackItem &trailer = m_stack.items[PACKET_METADATA_STACK_SIZE - m_stack.trailers + index];
+      item->typeUid = trailer.typeUid << 1;
+      item->size = trailer.size;
+    }
+  extraItem->fragmentStart = 0;
+  extraItem->fragmentEnd = item->size;
+  extraItem->packetUid = m_packetUid;
+}
+PacketMetadata
+PacketMetadata::GetItemList (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketMetadata list (m_packetUid, 0, false);
+  for (uint32_t i = 0; i < GetStackItemCount (); i++)
+    {
+      struct PacketMetadata::SmallItem item;
+      struct PacketMetadata::ExtraItem extraItem;
+      ReadStackItem (i, &item, &extraItem);
+      uint16_t written = list.AddBig (0xffff, list.m_tail, &item, &extraItem);
+      list.UpdateTail (written);
+    }
+  return list;
+}
+void
+PacketMetadata::StackDropInnermost (bool header)
+{
+  NS_LOG_FUNCTION (this << header);
+  struct StackItem *items = m_stack.items;
+  if (header ? m_stack.headers > 0 : m_stack.trailers == 0)
+    {
+      m_stack.payload += items[0].size;
+      std::copy (items + 1, items + m_stack.headers, items);
+      m_stack.headers--;
+    }
+  else
+    {
+      m_stack.payload += items[PACKET_METADATA_STACK_SIZE - 1].size;
+      std::copy_backward (items + PACKET_METADATA_STACK_SIZE - m_stack.trailers,
+                          items + PACKET_METADATA_STACK_SIZE - 1,
+                          items + PACKET_METADATA_STACK_SIZE);
+      m_stack.trailers--;
+    }
+}
+void
+PacketMetadata::StackAddHeader (uint16_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
+  if (size > 0xffff)
+    {
+      // too large to record: the headers behind become payload too
+      for (uint32_t i = 0; i < m_stack.headers; i++)
+        {
+          m_stack.payload += m_stack.items[i].size;
+        }
+      m_stack.payload += size;
+      m_stack.headers = 0;
+      return;
+    }
+  if (m_stack.headers + m_stack.trailers == PACKET_METADATA_STACK_SIZE)
+    {
+      StackDropInnermost (true);
+    }
+  struct StackItem &item = m_stack.items[m_stack.headers];
+  item.typeUid = uid;
+  item.size = size;
+  m_stack.headers++;
+}
+void
+PacketMetadata::StackAddTrailer (uint16_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
+  if (size > 0xffff)
+    {
+      // too large to record: the trailers before become payload too
+      for (uint32_t i = 0; i < m_stack.trailers; i++)
+        {
+          m_stack.payload += m_stack.items[PACKET_METADATA_STACK_SIZE - 1 - i].size;
+        }
+      m_stack.payload += size;
+      m_stack.trailers = 0;
+      return;
+    }
+  if (m_stack.headers + m_stack.trailers == PACKET_METADATA_STACK_SIZE)
+    {
+      StackDropInnermost (false);
+    }
+  m_stack.trailers++;
+  struct StackItem &item = m_stack.items[PACKET_METADATA_STACK_SIZE - m_stack.trailers];
+  item.typeUid = uid;
+  item.size = size;
+}
+void
+PacketMetadata::StackAppend (const PacketMetadata::SmallItem *item,
+                             const PacketMetadata::ExtraItem *extraItem)
+{
+  NS_LOG_FUNCTION (this << item->typeUid << item->size <<
+                   extraItem->fragmentStart << extraItem->fragmentEnd);
+  uint32_t uid = (item->typeUid & 0xfffffffe) >> 1;
+  uint32_t size = extraItem->fragmentEnd - extraItem->fragmentStart;
+  bool whole = extraItem->fragmentStart == 0 && extraItem->fragmentEnd == item->size;
+  if (uid != 0 && whole && size <= 0xffff)
+    {
+      TypeId tid;
+      tid.SetUid (uid);
+      if (tid.IsChildOf (Trailer::GetTypeId ()))
+        {
+          StackAddTrailer (uid, size);
+          return;
+        }
+      if (m_stack.payload == 0 && m_stack.trailers == 0
+          && m_stack.headers < PACKET_METADATA_STACK_SIZE)
+        {
+          // a new innermost header
+          struct StackItem *items = m_stack.items;
+          std::copy_backward (items, items + m_stack.headers, items + m_stack.headers + 1);
+          items[0].typeUid = uid;
+          items[0].size = size;
+          m_stack.headers++;
+          return;
+        }
+    }
+  // the trailers are now in the middle of the packet
+  for (uint32_t i = 0; i < m_stack.trailers; i++)
+    {
+      m_stack.payload += m_stack.items[PACKET_METADATA_STACK_SIZE - 1 - i].size;
+    }
+  m_stack.payload += size;
+  m_stack.trailers = 0;
+}
+void
+PacketMetadata::StackRemoveAtStart (uint32_t start)
+{
+  NS_LOG_FUNCTION (this << start);
+  struct StackItem *items = m_stack.items;
+  while (start > 0 && m_stack.headers > 0)
+    {
+      m_stack.headers--;
+      uint32_t size = items[m_stack.headers].size;
+      if (size > start)
+        {
+          // the rest of the header, and the headers behind, become payload
+          m_stack.payload += size - start;
+          for (uint32_t i = 0; i < m_stack.headers; i++)
+            {
+              m_stack.payload += items[i].size;
+            }
+          m_stack.headers = 0;
+          return;
+        }
+      start -= size;
+    }
+  uint32_t fromPayload = std::min (start, m_stack.payload);
+  m_stack.payload -= fromPayload;
+  start -= fromPayload;
+  while (start > 0 && m_stack.trailers > 0)
+    {
+      uint32_t size = items[PACKET_METADATA_STACK_SIZE - 1].size;
+      std::copy_backward (items + PACKET_METADATA_STACK_SIZE - m_stack.trailers,
+                          items + PACKET_METADATA_STACK_SIZE - 1,
+                          items + PACKET_METADATA_STACK_SIZE);
+      m_stack.trailers--;
+      if (size > start)
+        {
+          // the rest of the trailer becomes payload
+          m_stack.payload += size - start;
+          return;
+        }
+      start -= size;
+    }
+}
+void
+PacketMetadata::StackRemoveAtEnd (uint32_t end)
+{
+  NS_LOG_FUNCTION (this << end);
+  struct StackItem *items = m_stack.items;
+  while (end > 0 && m_stack.trailers > 0)
+    {
+      uint32_t size = items[PACKET_METADATA_STACK_SIZE - m_stack.trailers].size;
+      m_stack.trailers--;
+      if (size > end)
+        {
+          // the rest of the trailer, and the trailers before, become payload
+          m_stack.payload += size - end;
+          for (uint32_t i = 0; i < m_stack.trailers; i++)
+            {
+              m_stack.payload += items[PACKET_METADATA_STACK_SIZE - 1 - i].size;
+            }
+          m_stack.trailers = 0;
+          return;
+        }
+      end -= size;
+    }
+  uint32_t fromPayload = std::min (end, m_stack.payload);
+  m_stack.payload -= fromPayload;
+  end -= fromPayload;
+  while (end > 0 && m_stack.headers > 0)
+    {
+      uint32_t size = items[0].size;
+      std::copy (items + 1, items + m_stack.headers, items);
+      m_stack.headers--;
+      if (size > end)
+        {
+          // the rest of the header becomes payload
+          m_stack.payload += size - end;
+          return;
+        }
+      end -= size;
+    }
+}
+
 
 PacketMetadata 
 PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
@@ -655,6 +915,11 @@ PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
+  if (IsHeaderStack ())
+    {
+      StackAddHeader (header.GetInstanceTypeId ().GetUid (), size);
+      return;
+    }
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   DoAddHeader (uid, size);
   NS_ASSERT (IsStateOk ());
@@ -690,6 +955,24 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (IsHeaderStack ())
+    {
+      if (m_stack.headers > 0)
+        {
+          const struct StackItem &top = m_stack.items[m_stack.headers - 1];
+          if (top.typeUid << 1 == uid && top.size == size)
+            {
+              m_stack.headers--;
+              return;
+            }
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected header.");
+            }
+        }
+      StackRemoveAtStart (size);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -738,6 +1021,11 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (IsHeaderStack ())
+    {
+      StackAddTrailer (uid >> 1, size);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -760,6 +1048,24 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (IsHeaderStack ())
+    {
+      if (m_stack.trailers > 0)
+        {
+          const struct StackItem &top = m_stack.items[PACKET_METADATA_STACK_SIZE - m_stack.trailers];
+          if (top.typeUid << 1 == uid && top.size == size)
+            {
+              m_stack.trailers--;
+              return;
+            }
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected trailer.");
+            }
+        }
+      StackRemoveAtEnd (size);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -807,6 +1113,38 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (IsHeaderStack ())
+    {
+      if (GetStackItemCount () == 0 && o.IsHeaderStack ())
+        {
+          *this = o;
+          return;
+        }
+      // o may be this packet
+      PacketMetadata other = o;
+      uint32_t n = other.IsHeaderStack () ? other.GetStackItemCount () : 0;
+      uint16_t current = other.IsHeaderStack () ? 0xffff : other.m_head;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          struct PacketMetadata::SmallItem item;
+          struct PacketMetadata::ExtraItem extraItem;
+          other.ReadStackItem (i, &item, &extraItem);
+          StackAppend (&item, &extraItem);
+        }
+      while (current != 0xffff)
+        {
+          struct PacketMetadata::SmallItem item;
+          struct PacketMetadata::ExtraItem extraItem;
+          other.ReadItems (current, &item, &extraItem);
+          StackAppend (&item, &extraItem);
+          if (current == other.m_tail)
+            {
+              break;
+            }
+          current = item.next;
+        }
+      return;
+    }
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -822,6 +1160,11 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       return;
     }
   NS_ASSERT (m_head != 0xffff && m_tail != 0xffff);
+  if (o.IsHeaderStack ())
+    {
+      AddAtEnd (o.GetItemList ());
+      return;
+    }
 
   // We read the current tail because we are going to append
   // after this item.
@@ -895,6 +1238,11 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (IsHeaderStack ())
+    {
+      StackRemoveAtStart (start);
+      return;
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -921,7 +1269,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment (m_packetUid, 0, false);
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -958,6 +1306,11 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (IsHeaderStack ())
+    {
+      StackRemoveAtEnd (end);
+      return;
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -985,7 +1338,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment (m_packetUid, 0, false);
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1051,7 +1404,7 @@ PacketMetadata::BeginItem (Buffer buffer) const
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
   : m_metadata (metadata),
     m_buffer (buffer),
-    m_current (metadata->m_head),
+    m_current (metadata->IsHeaderStack () ? 0 : metadata->m_head),
     m_offset (0),
     m_hasReadTail (false)
 {
@@ -1061,6 +1414,10 @@ bool
 PacketMetadata::ItemIterator::HasNext (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_metadata->IsHeaderStack ())
+    {
+      return m_current < m_metadata->GetStackItemCount ();
+    }
   if (m_current == 0xffff)
     {
       return false;
@@ -1078,12 +1435,20 @@ PacketMetadata::ItemIterator::Next (void)
   struct PacketMetadata::Item item;
   struct PacketMetadata::SmallItem smallItem;
   struct PacketMetadata::ExtraItem extraItem;
-  m_metadata->ReadItems (m_current, &smallItem, &extraItem);
-  if (m_current == m_metadata->m_tail)
+  if (m_metadata->IsHeaderStack ())
+    {
+      m_metadata->ReadStackItem (m_current, &smallItem, &extraItem);
+      m_current++;
+    }
+  else
     {
-      m_hasReadTail = true;
+      m_metadata->ReadItems (m_current, &smallItem, &extraItem);
+      if (m_current == m_metadata->m_tail)
+        {
+          m_hasReadTail = true;
+        }
+      m_current = smallItem.next;
     }
-  m_current = smallItem.next;
   uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
   item.tid.SetUid (uid);
   item.currentTrimedFromStart = extraItem.fragmentStart;
@@ -1145,6 +1510,10 @@ PacketMetadata::GetSerializedSize (void) const
     {
       return totalSize;
     }
+  if (IsHeaderStack ())
+    {
+      return GetItemList ().GetSerializedSize ();
+    }
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
@@ -1178,6 +1547,10 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (IsHeaderStack ())
+    {
+      return GetItemList ().Serialize (buffer, maxSize);
+    }
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1279,6 +1652,14 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (IsHeaderStack ())
+    {
+      PacketMetadata list (0, 0, false);
+      uint32_t ok = list.Deserialize (buffer, size);
+      m_packetUid = list.m_packetUid;
+      AddAtEnd (list);
+      return ok;
+    }
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
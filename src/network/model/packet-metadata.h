@@ -74,6 +74,16 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When the header stack is enabled, the packets created afterwards
+ * record instead a fixed-size stack of the types and sizes of their
+ * headers and trailers, stored in the PacketMetadata itself: adding or
+ * removing a header needs no allocation and no copy of shared metadata.
+ * The stack holds up to PACKET_METADATA_STACK_SIZE whole headers and
+ * trailers; everything else, the payload, the fragments of headers and
+ * the headers which do not fit, is recorded as a single payload item
+ * between the headers and the trailers.  This is enough for Packet::Print
+ * and the trace sinks, which look at the headers of whole packets.
  */
 class PacketMetadata 
 {
@@ -160,6 +170,17 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata, recording only a stack of the
+   * headers and trailers of the packets created afterwards
+   *
+   * Later calls to Enable() keep the header stack.
+   */
+  static void EnableHeaderStack (void);
+  /**
+   * \brief Record the full metadata of the packets created afterwards
+   */
+  static void DisableHeaderStack (void);
 
   /**
    * \brief Constructor
@@ -503,11 +524,106 @@ public:
     ~DataFreeList ();
   };
 
+  /**
+   * the number of headers and trailers recorded by the header stack
+   */
+#define PACKET_METADATA_STACK_SIZE 8
+
+  /**
+   * \brief A whole header or trailer of the header stack
+   */
+  struct StackItem {
+    uint16_t typeUid; //!< the uid of the TypeId of the header or trailer
+    uint16_t size;    //!< the size of the header or trailer
+  };
+
+  /**
+   * \brief The header stack
+   *
+   * The headers fill the items from the start, the innermost header
+   * first; the trailers fill them from the end, the innermost trailer
+   * last.
+   */
+  struct HeaderStack {
+    StackItem items[PACKET_METADATA_STACK_SIZE]; //!< the headers and the trailers
+    uint32_t payload;   //!< the size of the payload between the headers and the trailers
+    uint8_t headers;    //!< the number of headers
+    uint8_t trailers;   //!< the number of trailers
+  };
+
   friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
 
   PacketMetadata ();
+  /**
+   * \brief Constructor
+   * \param uid packet uid
+   * \param size size of the payload
+   * \param headerStack whether to record a header stack instead of a
+   * linked list of items
+   */
+  inline PacketMetadata (uint64_t uid, uint32_t size, bool headerStack);
+
+  /**
+   * \returns true if this metadata is a header stack
+   */
+  inline bool IsHeaderStack (void) const;
+  /**
+   * \returns the number of items of the header stack, payload included
+   */
+  uint32_t GetStackItemCount (void) const;
+  /**
+   * \brief Read an item of the header stack
+   * \param index the index of the item, from the first header to the
+   *        last trailer
+   * \param item pointer to where we should store the data to return to the caller
+   * \param extraItem pointer to where we should store the data to return to the caller
+   */
+  void ReadStackItem (uint32_t index,
+                      struct PacketMetadata::SmallItem *item,
+                      struct PacketMetadata::ExtraItem *extraItem) const;
+  /**
+   * \brief Add a header in front of the header stack
+   * \param uid the uid of the TypeId of the header
+   * \param size header serialized size
+   */
+  void StackAddHeader (uint16_t uid, uint32_t size);
+  /**
+   * \brief Add a trailer at the end of the header stack
+   * \param uid the uid of the TypeId of the trailer
+   * \param size trailer serialized size
+   */
+  void StackAddTrailer (uint16_t uid, uint32_t size);
+  /**
+   * \brief Append an item of a linked list or of another header stack
+   * at the end of the header stack
+   * \param item the SmallItem to append
+   * \param extraItem the ExtraItem to append
+   */
+  void StackAppend (const PacketMetadata::SmallItem *item,
+                    const PacketMetadata::ExtraItem *extraItem);
+  /**
+   * \brief Move the innermost header or trailer to the payload, to make
+   * room in the header stack
+   * \param header true to move a header rather than a trailer, if any
+   */
+  void StackDropInnermost (bool header);
+  /**
+   * \brief Remove a chunk at the start of the header stack
+   * \param start the size to remove
+   */
+  void StackRemoveAtStart (uint32_t start);
+  /**
+   * \brief Remove a chunk at the end of the header stack
+   * \param end the size to remove
+   */
+  void StackRemoveAtEnd (uint32_t end);
+  /**
+   * \brief Convert the header stack to a linked list of items
+   * \returns the metadata with the same items as the header stack
+   */
+  PacketMetadata GetItemList (void) const;
 
   /**
    * \brief Add a SmallItem
@@ -664,6 +780,7 @@ public:
   static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_headerStack; //!< Record a header stack in the new packets
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -685,6 +802,7 @@ public:
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
+  struct HeaderStack m_stack; //!< header stack, if there is no metadata storage
 };
 
 } // namespace ns3
@@ -692,12 +810,22 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : PacketMetadata (uid, size, m_headerStack)
+{
+}
+PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size, bool headerStack)
+  : m_data (headerStack ? 0 : PacketMetadata::Create (10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
-    m_packetUid (uid)
+    m_packetUid (uid),
+    m_stack ()
 {
+  if (headerStack)
+    {
+      m_stack.payload = size;
+      return;
+    }
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
@@ -709,11 +837,14 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
-    m_packetUid (o.m_packetUid)
+    m_packetUid (o.m_packetUid),
+    m_stack (o.m_stack)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -721,31 +852,45 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
   m_packetUid = o.m_packetUid;
+  m_stack = o.m_stack;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
 }
+bool
+PacketMetadata::IsHeaderStack (void) const
+{
+  // a header stack has no metadata storage
+  return m_data == 0;
+}
 
 } // namespace ns3
 
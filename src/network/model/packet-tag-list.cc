@@ -26,6 +26,7 @@
 #include "packet-tag-list.h"
 #include "tag-buffer.h"
 #include "tag.h"
+#include "slab-allocator.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <cstring>
@@ -43,14 +44,22 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p = SlabAllocator::Allocate (sizeof (TagData) + dataSize - 1);
+  // The matching frees are in RemoveAll and RemoveWriter, by DeleteTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
   return tag;
 }
 
+void
+PacketTagList::DeleteTagData (TagData * tag)
+{
+  std::size_t size = sizeof (TagData) + tag->size - 1;
+  tag->~TagData ();
+  SlabAllocator::Deallocate (tag, size);
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -194,8 +203,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      DeleteTagData (cur);
     }
   else
     {
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "slab-allocator.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -168,6 +169,18 @@ Packet::operator = (const Packet &o)
   return *this;
 }
 
+void *
+Packet::operator new (std::size_t size)
+{
+  return SlabAllocator::Allocate (size);
+}
+
+void
+Packet::operator delete (void *p, std::size_t size)
+{
+  SlabAllocator::Deallocate (p, size);
+}
+
 Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
@@ -582,6 +595,13 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableHeaderStack (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableHeaderStack ();
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -199,7 +199,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. Packet::EnableHeaderStack records only a small
+ * fixed-size stack of the headers and trailers of each packet, which is
+ * cheaper still and enough to print whole packets.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -248,6 +250,18 @@ public:
    * \return the copied object
    */
   Packet &operator = (const Packet &o);
+  /**
+   * \brief Allocate a packet from the SlabAllocator
+   * \param size the size of the packet
+   * \returns the memory of the packet
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * \brief Release a packet to the SlabAllocator
+   * \param p the memory of the packet
+   * \param size the size of the packet
+   */
+  static void operator delete (void *p, std::size_t size);
   /**
    * \brief Create a packet with a zero-filled payload.
    *
@@ -530,6 +544,21 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing packets from a lightweight header stack.
+   *
+   * Instead of the full history of the headers, trailers and fragments
+   * of a packet, the metadata then records only the types and sizes of
+   * its outermost headers and trailers, in a fixed-size stack, with no
+   * allocation per header.  The headers of whole packets can be printed;
+   * fragments and the headers past the capacity of the stack are printed
+   * as payload.
+   *
+   * Call this method during the simulation setup, before any packet is
+   * sent.  The helpers which call EnablePrinting () for their traces then
+   * keep the header stack.
+   */
+  static void EnableHeaderStack (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "slab-allocator.h"
+#include "ns3/log.h"
+
+#include <iomanip>
+#include <new>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SlabAllocator");
+
+namespace {
+
+/** Granularity of the small size classes, and alignment of the blocks. */
+const std::size_t SLAB_GRANULARITY = 16;
+/** Number of small size classes, SLAB_GRANULARITY bytes apart. */
+const std::size_t SLAB_SMALL_CLASSES = 16;
+/** Largest size of the small size classes. */
+const std::size_t SLAB_SMALL_MAX = SLAB_GRANULARITY * SLAB_SMALL_CLASSES;
+/** Number of size classes; the classes past the small ones double. */
+const std::size_t SLAB_CLASSES = SLAB_SMALL_CLASSES + 5;
+/** Size of the chunks carved into blocks. */
+const std::size_t SLAB_CHUNK_SIZE = 64 * 1024;
+
+/** A released block, in a free list. */
+struct FreeBlock
+{
+  FreeBlock *next;  //!< next released block of the same size class
+};
+
+/**
+ * The free lists of a thread.
+ *
+ * It is a POD, zero-initialized, so that accessing the thread-local
+ * instance needs no initialization guard.
+ */
+struct SlabPool
+{
+  FreeBlock *freeLists[SLAB_CLASSES];   //!< released blocks, by size class
+  FreeBlock *chunks;                    //!< chunks allocated, kept reachable
+  uint64_t allocations[SLAB_CLASSES];   //!< blocks allocated, by size class
+  uint64_t hits[SLAB_CLASSES];          //!< blocks taken from a free list, by size class
+  SlabAllocator::Stats stats;           //!< allocation statistics
+};
+
+/** The free lists of the current thread. */
+thread_local SlabPool g_slabPool;
+
+/**
+ * \param size the size of a block
+ * \returns the size class of the block, SLAB_CLASSES if too large
+ */
+inline std::size_t
+GetSizeClass (std::size_t size)
+{
+  if (size <= SLAB_SMALL_MAX)
+    {
+      return size == 0 ? 0 : (size - 1) / SLAB_GRANULARITY;
+    }
+  std::size_t sizeClass = SLAB_SMALL_CLASSES;
+  std::size_t classSize = 2 * SLAB_SMALL_MAX;
+  while (classSize < size && sizeClass < SLAB_CLASSES)
+    {
+      classSize *= 2;
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+/**
+ * \param sizeClass a size class
+ * \returns the size of the blocks of the class
+ */
+inline std::size_t
+GetClassSize (std::size_t sizeClass)
+{
+  if (sizeClass < SLAB_SMALL_CLASSES)
+    {
+      return (sizeClass + 1) * SLAB_GRANULARITY;
+    }
+  return SLAB_SMALL_MAX << (sizeClass - SLAB_SMALL_CLASSES + 1);
+}
+
+/**
+ * Refill a free list with a new chunk.
+ * \param pool the free lists
+ * \param sizeClass the size class of the free list
+ */
+void
+RefillSlabPool (SlabPool &pool, std::size_t sizeClass)
+{
+  std::size_t blockSize = GetClassSize (sizeClass);
+  char *chunk = static_cast<char *> (::operator new (SLAB_CHUNK_SIZE));
+  // the first granule links the chunks of the thread
+  FreeBlock *header = reinterpret_cast<FreeBlock *> (chunk);
+  header->next = pool.chunks;
+  pool.chunks = header;
+  // the blocks are linked so that they are allocated in address order
+  FreeBlock *head = pool.freeLists[sizeClass];
+  std::size_t nBlocks = (SLAB_CHUNK_SIZE - SLAB_GRANULARITY) / blockSize;
+  for (std::size_t i = nBlocks; i > 0; i--)
+    {
+      FreeBlock *block = reinterpret_cast<FreeBlock *> (chunk + SLAB_GRANULARITY + (i - 1) * blockSize);
+      block->next = head;
+      head = block;
+    }
+  pool.freeLists[sizeClass] = head;
+  pool.stats.chunks++;
+  pool.stats.chunkBytes += SLAB_CHUNK_SIZE;
+}
+
+} // unnamed namespace
+
+void *
+SlabAllocator::Allocate (std::size_t size)
+{
+  SlabPool &pool = g_slabPool;
+  pool.stats.allocations++;
+  std::size_t sizeClass = GetSizeClass (size);
+  if (sizeClass >= SLAB_CLASSES)
+    {
+      pool.stats.large++;
+      return ::operator new (size);
+    }
+  pool.allocations[sizeClass]++;
+  FreeBlock *block = pool.freeLists[sizeClass];
+  if (block == 0)
+    {
+      RefillSlabPool (pool, sizeClass);
+      block = pool.freeLists[sizeClass];
+    }
+  else
+    {
+      pool.hits[sizeClass]++;
+      pool.stats.hits++;
+    }
+  pool.freeLists[sizeClass] = block->next;
+  return block;
+}
+
+void
+SlabAllocator::Deallocate (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  SlabPool &pool = g_slabPool;
+  pool.stats.releases++;
+  std::size_t sizeClass = GetSizeClass (size);
+  if (sizeClass >= SLAB_CLASSES)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = pool.freeLists[sizeClass];
+  pool.freeLists[sizeClass] = block;
+}
+
+std::size_t
+SlabAllocator::GetCapacity (std::size_t size)
+{
+  std::size_t sizeClass = GetSizeClass (size);
+  if (sizeClass >= SLAB_CLASSES)
+    {
+      return size;
+    }
+  return GetClassSize (sizeClass);
+}
+
+SlabAllocator::Stats
+SlabAllocator::GetStats (void)
+{
+  return g_slabPool.stats;
+}
+
+void
+SlabAllocator::PrintStats (std::ostream &os)
+{
+  const SlabPool &pool = g_slabPool;
+  os << std::setw (8) << "size"
+     << std::setw (14) << "allocations"
+     << std::setw (10) << "hits (%)" << std::endl;
+  for (std::size_t i = 0; i < SLAB_CLASSES; i++)
+    {
+      if (pool.allocations[i] == 0)
+        {
+          continue;
+        }
+      os << std::setw (8) << GetClassSize (i)
+         << std::setw (14) << pool.allocations[i]
+         << std::setw (10) << std::fixed << std::setprecision (2)
+         << 100.0 * pool.hits[i] / pool.allocations[i] << std::endl;
+    }
+  os << std::setw (8) << "larger"
+     << std::setw (14) << pool.stats.large << std::endl;
+  os << pool.stats.chunks << " chunks, " << pool.stats.chunkBytes << " bytes" << std::endl;
+  os.unsetf (std::ios::floatfield);
+}
+
+} // namespace ns3
@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Size-classed allocator of the memory of the packets.
+ *
+ * The Packet objects, the data of their Buffer, and the blocks of their
+ * ByteTagList and PacketTagList are allocated from free lists, one per
+ * size class: 16 classes 16 bytes apart up to 256 bytes, for the
+ * packets and the tags, then 5 classes doubling up to 8 KiB, for the
+ * buffers.  Larger blocks are allocated with new.  The free lists are
+ * refilled by carving 64 KiB chunks, which are never returned to the
+ * system.
+ *
+ * The free lists and the statistics are thread-local, so that the
+ * realtime and distributed simulators need no lock: a block goes to the
+ * free list of the thread which releases it.
+ *
+ * The caller gives the size of the block when it is released, as with
+ * a sized operator delete, so that the blocks carry no header.
+ */
+class SlabAllocator
+{
+public:
+  /** Allocation statistics of the calling thread. */
+  struct Stats
+  {
+    uint64_t allocations;   //!< number of blocks allocated
+    uint64_t hits;          //!< number of blocks allocated from a free list
+    uint64_t releases;      //!< number of blocks released
+    uint64_t large;         //!< number of blocks too large for the size classes
+    uint64_t chunks;        //!< number of chunks allocated to refill the free lists
+    uint64_t chunkBytes;    //!< total size of these chunks
+  };
+
+  /**
+   * Allocate a block.
+   * \param size the size of the block
+   * \returns the block, aligned on 16 bytes
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Release a block to the free lists of the calling thread.
+   * \param p the block
+   * \param size the size given to Allocate(), or another size of the
+   * same class, like the GetCapacity() of that size
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * \param size the size of a block
+   * \returns the size actually available in a block allocated with
+   * this size: the size of its class
+   */
+  static std::size_t GetCapacity (std::size_t size);
+  /**
+   * \returns the allocation statistics of the calling thread
+   */
+  static Stats GetStats (void);
+  /**
+   * Print the number of allocations and the hit rate of the free lists
+   * of each size class used by the calling thread.
+   * \param os the output stream
+   */
+  static void PrintStats (std::ostream &os);
+};
+
+} // namespace ns3
+
+#endif /* SLAB_ALLOCATOR_H */
@@ -318,7 +318,11 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
  */
 class PacketMetadataTest : public TestCase {
 public:
-  PacketMetadataTest ();
+  /**
+   * Constructor
+   * \param name The name of the test case
+   */
+  PacketMetadataTest (std::string name = "Packet metadata");
   virtual ~PacketMetadataTest ();
   /**
    * Checks the packet header and trailer history
@@ -339,8 +343,8 @@ private:
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
 };
 
-PacketMetadataTest::PacketMetadataTest ()
-  : TestCase ("Packet metadata")
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
 {
 }
 
@@ -903,6 +907,94 @@ PacketMetadataTest::DoRun (void)
 }
 
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet metadata header stack unit tests.
+ */
+class PacketMetadataHeaderStackTest : public PacketMetadataTest
+{
+public:
+  PacketMetadataHeaderStackTest ();
+  virtual void DoRun (void);
+};
+
+PacketMetadataHeaderStackTest::PacketMetadataHeaderStackTest ()
+  : PacketMetadataTest ("Packet metadata header stack")
+{
+}
+
+void
+PacketMetadataHeaderStackTest::DoRun (void)
+{
+  // a packet created before, with the full metadata
+  PacketMetadata::Enable ();
+  Ptr<Packet> full = Create<Packet> (10);
+  ADD_HEADER (full, 5);
+
+  PacketMetadata::EnableHeaderStack ();
+  Ptr<Packet> p = Create<Packet> (10);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 2);
+  ADD_TRAILER (p, 4);
+  CHECK_HISTORY (p, 4, 2, 3, 10, 4);
+  Ptr<Packet> p1 = p->Copy ();
+  REM_HEADER (p1, 2);
+  ADD_HEADER (p1, 5);
+  CHECK_HISTORY (p1, 4, 5, 3, 10, 4);
+  CHECK_HISTORY (p, 4, 2, 3, 10, 4);
+  REM_TRAILER (p1, 4);
+  CHECK_HISTORY (p1, 3, 5, 3, 10);
+
+  // the fragments of headers and trailers are payload
+  p1 = p->CreateFragment (1, 0);
+  CHECK_HISTORY (p1, 2, 14, 4);
+  p1 = p->CreateFragment (2, 6);
+  CHECK_HISTORY (p1, 2, 3, 8);
+  p1 = p->CreateFragment (0, 16);
+  CHECK_HISTORY (p1, 2, 2, 1);
+
+  p1 = Create<Packet> (10);
+  ADD_HEADER (p1, 5);
+  Ptr<Packet> p2 = Create<Packet> (7);
+  ADD_HEADER (p2, 3);
+  ADD_TRAILER (p2, 4);
+  p1->AddAtEnd (p2);
+  CHECK_HISTORY (p1, 3, 5, 20, 4);
+  Ptr<Packet> p3 = Create<Packet> (0);
+  p3->AddAtEnd (p2);
+  CHECK_HISTORY (p3, 3, 3, 7, 4);
+  p3 = Create<Packet> (0);
+  ADD_HEADER (p3, 8);
+  p3->AddAtEnd (p2);
+  CHECK_HISTORY (p3, 4, 8, 3, 7, 4);
+
+  // the headers past the capacity of the stack are payload
+  p = Create<Packet> (10);
+  for (uint32_t i = 0; i < PACKET_METADATA_STACK_SIZE + 1; i++)
+    {
+      ADD_HEADER (p, 2);
+    }
+  CHECK_HISTORY (p, 9, 2, 2, 2, 2, 2, 2, 2, 2, 12);
+  for (uint32_t i = 0; i < PACKET_METADATA_STACK_SIZE + 1; i++)
+    {
+      REM_HEADER (p, 2);
+    }
+  CHECK_HISTORY (p, 1, 10);
+
+  // packets with the full metadata
+  p1 = Create<Packet> (20);
+  ADD_HEADER (p1, 3);
+  p1->AddAtEnd (full);
+  CHECK_HISTORY (p1, 2, 3, 35);
+  full->AddAtEnd (p2);
+  CheckHistory (full, __FILE__, __LINE__, 5, 5, 10, 3, 7, 4);
+
+  PacketMetadata::DisableHeaderStack ();
+}
+
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -919,6 +1011,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataHeaderStackTest, TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
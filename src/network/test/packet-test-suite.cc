@@ -19,6 +19,7 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/slab-allocator.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -1035,6 +1036,73 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Slab allocator of the packets unit tests.
+ */
+class SlabAllocatorTest : public TestCase
+{
+public:
+  SlabAllocatorTest ();
+private:
+  void DoRun (void);
+};
+
+SlabAllocatorTest::SlabAllocatorTest ()
+  : TestCase ("SlabAllocator")
+{
+}
+
+void
+SlabAllocatorTest::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (SlabAllocator::GetCapacity (1), 16u, "Wrong small class");
+  NS_TEST_EXPECT_MSG_EQ (SlabAllocator::GetCapacity (100), 112u, "Wrong small class");
+  NS_TEST_EXPECT_MSG_EQ (SlabAllocator::GetCapacity (256), 256u, "Wrong small class");
+  NS_TEST_EXPECT_MSG_EQ (SlabAllocator::GetCapacity (257), 512u, "Wrong large class");
+  NS_TEST_EXPECT_MSG_EQ (SlabAllocator::GetCapacity (2100), 4096u, "Wrong large class");
+  NS_TEST_EXPECT_MSG_EQ (SlabAllocator::GetCapacity (10000), 10000u, "Wrong size out of the classes");
+
+  // a block released is the next one allocated in its class
+  void *a = SlabAllocator::Allocate (100);
+  void *b = SlabAllocator::Allocate (100);
+  NS_TEST_EXPECT_MSG_NE (a, b, "Same block allocated twice");
+  NS_TEST_EXPECT_MSG_EQ (reinterpret_cast<uintptr_t> (a) % 16, 0, "Block not aligned");
+  SlabAllocator::Deallocate (a, 100);
+  SlabAllocator::Stats before = SlabAllocator::GetStats ();
+  void *c = SlabAllocator::Allocate (112);
+  SlabAllocator::Stats after = SlabAllocator::GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (c, a, "Released block not reused");
+  NS_TEST_EXPECT_MSG_EQ (after.hits - before.hits, 1u, "Hit not counted");
+  SlabAllocator::Deallocate (b, 100);
+  SlabAllocator::Deallocate (c, 112);
+  void *large = SlabAllocator::Allocate (10000);
+  SlabAllocator::Deallocate (large, 10000);
+  NS_TEST_EXPECT_MSG_EQ (SlabAllocator::GetStats ().large - after.large, 1u, "Large block not counted");
+
+  // packets, their buffers and their tags are recycled
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      before = SlabAllocator::GetStats ();
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (ATestHeader<10> ());
+      p->AddPacketTag (ATestTag<20> ());
+      p->AddByteTag (ATestTag<30> ());
+      Ptr<Packet> copy = p->Copy ();
+      ATestHeader<10> header;
+      copy->RemoveHeader (header);
+      p = 0;
+      copy = 0;
+      after = SlabAllocator::GetStats ();
+      NS_TEST_EXPECT_MSG_EQ (after.releases - before.releases, after.allocations - before.allocations,
+                             "Blocks not released");
+    }
+  NS_TEST_EXPECT_MSG_EQ (after.hits - before.hits, after.allocations - before.allocations,
+                         "Blocks not reused");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1120,7 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new SlabAllocatorTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
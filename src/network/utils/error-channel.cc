@@ -84,6 +84,8 @@ ErrorChannel::Send (Ptr<Packet> p, uint16_t protocol,
                           Ptr<SimpleNetDevice> sender)
 {
   NS_LOG_FUNCTION (p << protocol << to << from << sender);
+  // all the receivers share one copy, which is not modified any more
+  Ptr<const Packet> shared = p->Copy ();
   for (std::vector<Ptr<SimpleNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); ++i)
     {
       Ptr<SimpleNetDevice> tmp = *i;
@@ -96,12 +98,12 @@ ErrorChannel::Send (Ptr<Packet> p, uint16_t protocol,
           if (m_jumpingState % 2)
             {
               Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), Seconds (0),
-                                              &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                              &SimpleNetDevice::Receive, tmp, shared, protocol, to, from);
             }
           else
             {
               Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_jumpingTime,
-                                              &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                              &SimpleNetDevice::Receive, tmp, shared, protocol, to, from);
             }
           m_jumpingState++;
         }
@@ -110,21 +112,21 @@ ErrorChannel::Send (Ptr<Packet> p, uint16_t protocol,
           if (m_duplicateState % 2)
             {
               Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), Seconds (0),
-                                              &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                              &SimpleNetDevice::Receive, tmp, shared, protocol, to, from);
             }
           else
             {
               Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), Seconds (0),
-                                              &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                              &SimpleNetDevice::Receive, tmp, shared, protocol, to, from);
               Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_duplicateTime,
-                                              &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                              &SimpleNetDevice::Receive, tmp, shared, protocol, to, from);
             }
           m_duplicateState++;
         }
       else
         {
           Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), Seconds (0),
-                                          &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                          &SimpleNetDevice::Receive, tmp, shared, protocol, to, from);
         }
     }
 }
@@ -230,13 +230,13 @@ SimpleNetDevice::SimpleNetDevice ()
 }
 
 void
-SimpleNetDevice::Receive (Ptr<Packet> packet, uint16_t protocol,
+SimpleNetDevice::Receive (Ptr<const Packet> packet, uint16_t protocol,
                           Mac48Address to, Mac48Address from)
 {
   NS_LOG_FUNCTION (this << packet << protocol << to << from);
   NetDevice::PacketType packetType;
 
-  if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
+  if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet->Copy ()))
     {
       m_phyRxDropTrace (packet);
       return;
@@ -66,12 +66,15 @@ public:
    * SimpleNetDevice receives packets from its connected channel
    * and then forwards them by calling its rx callback method
    *
+   * The packet is shared with the other receivers of the channel and is
+   * passed up as is; the layers above copy it before modifying it.
+   *
    * \param packet Packet received on the channel
    * \param protocol protocol number
    * \param to address packet should be sent to
    * \param from address packet was sent from
    */
-  void Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from);
+  void Receive (Ptr<const Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from);
   
   /**
    * Attach a channel to this net device.  This will be the 
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "cached-propagation-loss-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+
+TypeId
+CachedPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("Propagation")
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("Model", "The loss model whose gains are cached.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationLossModel::SetModel,
+                                        &CachedPropagationLossModel::GetModel),
+                   MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("Tolerance",
+                   "The distance (m) a node may move before the gains to it are computed again, "
+                   "0 to compute them again as soon as it moves.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&CachedPropagationLossModel::m_tolerance),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+  : m_tolerance (0),
+    m_nHits (0),
+    m_nMisses (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CachedPropagationLossModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::unordered_map<const MobilityModel *, Endpoint>::iterator i = m_endpoints.begin ();
+       i != m_endpoints.end (); i++)
+    {
+      // the callback must be the one connected by the const GetEndpoint
+      const CachedPropagationLossModel *self = this;
+      i->second.mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                         MakeCallback (&CachedPropagationLossModel::CourseChanged, self));
+    }
+  m_endpoints.clear ();
+  m_entries.clear ();
+  m_model = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+void
+CachedPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  m_entries.clear ();
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+CachedPropagationLossModel::SetTolerance (double tolerance)
+{
+  NS_LOG_FUNCTION (this << tolerance);
+  m_tolerance = tolerance;
+}
+
+uint64_t
+CachedPropagationLossModel::GetNHits (void) const
+{
+  return m_nHits;
+}
+
+uint64_t
+CachedPropagationLossModel::GetNMisses (void) const
+{
+  return m_nMisses;
+}
+
+CachedPropagationLossModel::Endpoint &
+CachedPropagationLossModel::GetEndpoint (Ptr<MobilityModel> mobility) const
+{
+  std::unordered_map<const MobilityModel *, Endpoint>::iterator i = m_endpoints.find (PeekPointer (mobility));
+  if (i != m_endpoints.end ())
+    {
+      return i->second;
+    }
+  Endpoint &endpoint = m_endpoints[PeekPointer (mobility)];
+  endpoint.mobility = mobility;
+  endpoint.id = m_endpoints.size () - 1;
+  endpoint.generation = 0;
+  endpoint.moving = mobility->GetVelocity ().GetLength () > 0;
+  mobility->TraceConnectWithoutContext ("CourseChange",
+                                        MakeCallback (&CachedPropagationLossModel::CourseChanged, this));
+  return endpoint;
+}
+
+void
+CachedPropagationLossModel::CourseChanged (Ptr<const MobilityModel> mobility) const
+{
+  std::unordered_map<const MobilityModel *, Endpoint>::iterator i = m_endpoints.find (PeekPointer (mobility));
+  if (i != m_endpoints.end ())
+    {
+      i->second.generation++;
+      i->second.moving = mobility->GetVelocity ().GetLength () > 0;
+    }
+}
+
+bool
+CachedPropagationLossModel::Lookup (Ptr<MobilityModel> a, Ptr<MobilityModel> b, uint64_t &key, double &gainDb) const
+{
+  const Endpoint *endpoints[2] = { &GetEndpoint (a), &GetEndpoint (b) };
+  if (endpoints[0]->id > endpoints[1]->id)
+    {
+      std::swap (endpoints[0], endpoints[1]);
+    }
+  key = ((uint64_t) endpoints[0]->id << 32) | endpoints[1]->id;
+  std::unordered_map<uint64_t, Entry>::const_iterator i = m_entries.find (key);
+  if (i == m_entries.end ())
+    {
+      return false;
+    }
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      // a node that did not move since the gain was computed is where it was
+      if (endpoints[k]->moving || endpoints[k]->generation != i->second.generation[k])
+        {
+          Vector position = endpoints[k]->mobility->GetPosition ();
+          if (CalculateDistance (position, i->second.position[k]) > m_tolerance)
+            {
+              return false;
+            }
+        }
+    }
+  gainDb = i->second.gainDb;
+  return true;
+}
+
+void
+CachedPropagationLossModel::Store (Ptr<MobilityModel> a, Ptr<MobilityModel> b, uint64_t key, double gainDb) const
+{
+  const Endpoint *endpoints[2] = { &GetEndpoint (a), &GetEndpoint (b) };
+  if (endpoints[0]->id > endpoints[1]->id)
+    {
+      std::swap (endpoints[0], endpoints[1]);
+    }
+  Entry &entry = m_entries[key];
+  entry.gainDb = gainDb;
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      entry.position[k] = endpoints[k]->mobility->GetPosition ();
+      entry.generation[k] = endpoints[k]->generation;
+    }
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                           Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model != 0, "No loss model to cache");
+  uint64_t key;
+  double gainDb;
+  if (Lookup (a, b, key, gainDb))
+    {
+      m_nHits++;
+      return txPowerDbm + gainDb;
+    }
+  m_nMisses++;
+  gainDb = m_model->CalcRxPower (0, a, b);
+  NS_LOG_DEBUG ("computed gain=" << gainDb << "dB");
+  Store (a, b, key, gainDb);
+  return txPowerDbm + gainDb;
+}
+
+void
+CachedPropagationLossModel::DoCalcRxPowers (Ptr<MobilityModel> a,
+                                            const Vector *positions,
+                                            const Ptr<MobilityModel> *b,
+                                            uint32_t n,
+                                            double *rxPowerDbm) const
+{
+  NS_ASSERT_MSG (m_model != 0, "No loss model to cache");
+  m_misses.clear ();
+  m_keys.clear ();
+  m_missPositions.clear ();
+  m_missMobility.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint64_t key;
+      double gainDb;
+      if (Lookup (a, b[i], key, gainDb))
+        {
+          m_nHits++;
+          rxPowerDbm[i] += gainDb;
+          continue;
+        }
+      m_misses.push_back (i);
+      m_keys.push_back (key);
+      m_missPositions.push_back (positions[i]);
+      m_missMobility.push_back (b[i]);
+    }
+  uint32_t nMisses = m_misses.size ();
+  if (nMisses == 0)
+    {
+      return;
+    }
+  // the gains not cached are computed in one batch
+  m_nMisses += nMisses;
+  m_missGainsDb.resize (nMisses);
+  m_model->CalcRxPowers (0, a, &m_missPositions[0], &m_missMobility[0], nMisses, &m_missGainsDb[0]);
+  for (uint32_t k = 0; k < nMisses; k++)
+    {
+      Store (a, m_missMobility[k], m_keys[k], m_missGainsDb[k]);
+      rxPowerDbm[m_misses[k]] += m_missGainsDb[k];
+    }
+  m_missMobility.clear ();
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  if (m_model == 0)
+    {
+      return 0;
+    }
+  return m_model->AssignStreams (stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/propagation-loss-model.h"
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup propagation
+ *
+ * \brief Reuses the gain computed by another loss model as long as the
+ * nodes do not move.
+ *
+ * The gain of the wrapped model (the rx power for a 0 dBm tx power,
+ * including the models chained to it) is stored for every unordered pair
+ * of mobility models, with the positions it was computed at.  It is
+ * reused as long as neither node moved by more than the Tolerance from
+ * these positions.  The mobility models notify their course changes, so
+ * the positions of the nodes that stood still since the gain was computed
+ * are not even read, which makes the gains between static nodes, such as
+ * road side units, free.
+ *
+ * With the default Tolerance of 0 the gain is reused only if both nodes
+ * are exactly where it was computed, and the results are those of the
+ * wrapped model.  A positive Tolerance trades accuracy for speed with
+ * slowly moving nodes.
+ *
+ * The wrapped model must be deterministic, symmetric, and its loss must
+ * not depend on the tx power, which holds for the Friis, TwoRayGround,
+ * LogDistance, ThreeLogDistance and ITU-R 1411 models, but not for the
+ * random fading models, which are to be chained after this one.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  CachedPropagationLossModel ();
+  virtual ~CachedPropagationLossModel ();
+
+  /**
+   * \param model the loss model whose gains are cached
+   */
+  void SetModel (Ptr<PropagationLossModel> model);
+  /**
+   * \return the loss model whose gains are cached
+   */
+  Ptr<PropagationLossModel> GetModel (void) const;
+  /**
+   * \param tolerance the distance (m) a node may move before the gains
+   *        to it are computed again
+   */
+  void SetTolerance (double tolerance);
+
+  /**
+   * \return the number of gains reused since the creation of the model
+   */
+  uint64_t GetNHits (void) const;
+  /**
+   * \return the number of gains computed since the creation of the model
+   */
+  uint64_t GetNMisses (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  CachedPropagationLossModel (const CachedPropagationLossModel &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  CachedPropagationLossModel & operator = (const CachedPropagationLossModel &);
+
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowers (Ptr<MobilityModel> a,
+                               const Vector *positions,
+                               const Ptr<MobilityModel> *b,
+                               uint32_t n,
+                               double *rxPowerDbm) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  /// A mobility model seen by the cache.
+  struct Endpoint
+  {
+    Ptr<MobilityModel> mobility; //!< the mobility model
+    uint32_t id;                 //!< dense id, used in the keys of the gains
+    uint32_t generation;         //!< incremented at every course change
+    bool moving;                 //!< whether its velocity was not null at the last course change
+  };
+  /// A cached gain.
+  struct Entry
+  {
+    double gainDb;          //!< the gain
+    Vector position[2];     //!< positions of the endpoints, lowest id first
+    uint32_t generation[2]; //!< generations of the endpoints, lowest id first
+  };
+
+  /**
+   * \param mobility a mobility model
+   * \return its endpoint, created and connected to its course changes if needed
+   */
+  Endpoint & GetEndpoint (Ptr<MobilityModel> mobility) const;
+  /**
+   * \param mobility the mobility model whose course changed
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+  /**
+   * Look for a valid cached gain.
+   *
+   * \param a the mobility model of the source
+   * \param b the mobility model of the destination
+   * \param [out] key the key of the pair
+   * \param [out] gainDb the gain, if found
+   * \return true if the cached gain is valid
+   */
+  bool Lookup (Ptr<MobilityModel> a, Ptr<MobilityModel> b, uint64_t &key, double &gainDb) const;
+  /**
+   * Store a gain.
+   *
+   * \param a the mobility model of the source
+   * \param b the mobility model of the destination
+   * \param key the key of the pair
+   * \param gainDb the gain
+   */
+  void Store (Ptr<MobilityModel> a, Ptr<MobilityModel> b, uint64_t key, double gainDb) const;
+
+  Ptr<PropagationLossModel> m_model;  //!< the cached model
+  double m_tolerance;                 //!< distance a node may move without invalidating its gains
+  mutable std::unordered_map<const MobilityModel *, Endpoint> m_endpoints; //!< the mobility models seen
+  mutable std::unordered_map<uint64_t, Entry> m_entries; //!< the gains, by pair of endpoint ids
+  mutable uint64_t m_nHits;           //!< number of gains reused
+  mutable uint64_t m_nMisses;         //!< number of gains computed
+  mutable std::vector<uint32_t> m_misses;          //!< scratch indices of the batch misses
+  mutable std::vector<uint64_t> m_keys;            //!< scratch keys of the batch misses
+  mutable std::vector<Vector> m_missPositions;     //!< scratch positions of the batch misses
+  mutable std::vector<Ptr<MobilityModel> > m_missMobility; //!< scratch mobility models of the batch misses
+  mutable std::vector<double> m_missGainsDb;       //!< scratch gains of the batch misses
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H */
@@ -62,12 +62,18 @@ double
 ItuR1411LosPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
 {
   NS_LOG_FUNCTION (this);
-  double dist = a->GetDistanceFrom (b);
+  return GetLoss (a->GetPosition (), b->GetPosition ());
+}
+
+double
+ItuR1411LosPropagationLossModel::GetLoss (const Vector &a, const Vector &b) const
+{
+  double dist = CalculateDistance (a, b);
   double lossLow = 0.0;
   double lossUp = 0.0;
-  NS_ASSERT_MSG (a->GetPosition ().z > 0 && b->GetPosition ().z > 0, "nodes' height must be greater than 0");
-  double Lbp = std::fabs (20 * std::log10 ((m_lambda * m_lambda) / (8 * M_PI * a->GetPosition ().z * b->GetPosition ().z)));
-  double Rbp = (4 * a->GetPosition ().z * b->GetPosition ().z) / m_lambda;
+  NS_ASSERT_MSG (a.z > 0 && b.z > 0, "nodes' height must be greater than 0");
+  double Lbp = std::fabs (20 * std::log10 ((m_lambda * m_lambda) / (8 * M_PI * a.z * b.z)));
+  double Rbp = (4 * a.z * b.z) / m_lambda;
   NS_LOG_LOGIC (this << " Lbp " << Lbp << " Rbp " << Rbp << " lambda " << m_lambda);
   if (dist <= Rbp)
     {
@@ -102,6 +108,20 @@ ItuR1411LosPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return (txPowerDbm - GetLoss (a, b));
 }
 
+void
+ItuR1411LosPropagationLossModel::DoCalcRxPowers (Ptr<MobilityModel> a,
+                                                 const Vector *positions,
+                                                 const Ptr<MobilityModel> *b,
+                                                 uint32_t n,
+                                                 double *rxPowerDbm) const
+{
+  Vector position = a->GetPosition ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      rxPowerDbm[i] -= GetLoss (position, positions[i]);
+    }
+}
+
 int64_t
 ItuR1411LosPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -71,6 +71,15 @@ public:
    */
   double GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
+  /**
+   * \param a the position of the first node
+   * \param b the position of the second node
+   *
+   * \return the loss in dBm for the propagation between
+   * the two given positions
+   */
+  double GetLoss (const Vector &a, const Vector &b) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -89,6 +98,11 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowers (Ptr<MobilityModel> a,
+                               const Vector *positions,
+                               const Ptr<MobilityModel> *b,
+                               uint32_t n,
+                               double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
   
   double m_lambda; //!< wavelength
@@ -29,6 +29,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -82,6 +83,34 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+void
+PropagationLossModel::CalcRxPowers (double txPowerDbm,
+                                    Ptr<MobilityModel> a,
+                                    const Vector *positions,
+                                    const Ptr<MobilityModel> *b,
+                                    uint32_t n,
+                                    double *rxPowerDbm) const
+{
+  std::fill (rxPowerDbm, rxPowerDbm + n, txPowerDbm);
+  for (const PropagationLossModel *model = this; model != 0; model = PeekPointer (model->m_next))
+    {
+      model->DoCalcRxPowers (a, positions, b, n, rxPowerDbm);
+    }
+}
+
+void
+PropagationLossModel::DoCalcRxPowers (Ptr<MobilityModel> a,
+                                      const Vector *positions,
+                                      const Ptr<MobilityModel> *b,
+                                      uint32_t n,
+                                      double *rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      rxPowerDbm[i] = DoCalcRxPower (rxPowerDbm[i], a, b[i]);
+    }
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -271,6 +300,26 @@ FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm - std::max (lossDb, m_minLoss);
 }
 
+void
+FriisPropagationLossModel::DoCalcRxPowers (Ptr<MobilityModel> a,
+                                           const Vector *positions,
+                                           const Ptr<MobilityModel> *b,
+                                           uint32_t n,
+                                           double *rxPowerDbm) const
+{
+  // same computation as DoCalcRxPower, without branches: at a null
+  // distance the loss is -inf and m_minLoss is applied
+  Vector position = a->GetPosition ();
+  double numerator = m_lambda * m_lambda;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = CalculateDistance (position, positions[i]);
+      double denominator = 16 * M_PI * M_PI * distance * distance * m_systemLoss;
+      double lossDb = -10 * log10 (numerator / denominator);
+      rxPowerDbm[i] -= std::max (lossDb, m_minLoss);
+    }
+}
+
 int64_t
 FriisPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -445,6 +494,34 @@ TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+void
+TwoRayGroundPropagationLossModel::DoCalcRxPowers (Ptr<MobilityModel> a,
+                                                  const Vector *positions,
+                                                  const Ptr<MobilityModel> *b,
+                                                  uint32_t n,
+                                                  double *rxPowerDbm) const
+{
+  // same computation as DoCalcRxPower, with both formulas evaluated and
+  // the result selected without branches
+  Vector position = a->GetPosition ();
+  double txAntHeight = position.z + m_heightAboveZ;
+  double numerator = m_lambda * m_lambda;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = CalculateDistance (position, positions[i]);
+      double rxAntHeight = positions[i].z + m_heightAboveZ;
+      double dCross = (4 * M_PI * txAntHeight * rxAntHeight) / m_lambda;
+      double tmp = M_PI * distance;
+      double pr = 10 * std::log10 (numerator / (16 * tmp * tmp * m_systemLoss));
+      tmp = txAntHeight * rxAntHeight;
+      double rayNumerator = tmp * tmp;
+      tmp = distance * distance;
+      double rayPr = 10 * std::log10 (rayNumerator / (tmp * tmp * m_systemLoss));
+      double gain = distance <= dCross ? pr : rayPr;
+      rxPowerDbm[i] += distance <= m_minDistance ? 0 : gain;
+    }
+}
+
 int64_t
 TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -534,6 +611,23 @@ LogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm + rxc;
 }
 
+void
+LogDistancePropagationLossModel::DoCalcRxPowers (Ptr<MobilityModel> a,
+                                                 const Vector *positions,
+                                                 const Ptr<MobilityModel> *b,
+                                                 uint32_t n,
+                                                 double *rxPowerDbm) const
+{
+  Vector position = a->GetPosition ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = CalculateDistance (position, positions[i]);
+      double pathLossDb = 10 * m_exponent * std::log10 (distance / m_referenceDistance);
+      double rxc = -m_referenceLoss - pathLossDb;
+      rxPowerDbm[i] += distance <= m_referenceDistance ? -m_referenceLoss : rxc;
+    }
+}
+
 int64_t
 LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -27,6 +27,7 @@
 
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
 #include <map>
 
 namespace ns3 {
@@ -93,6 +94,29 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * Returns the Rx Power from one source to several destinations, taking
+   * into account all the PropagationLossModel(s) chained to the current
+   * one.  The result is the one of CalcRxPower called for every
+   * destination in order, but every model of the chain evaluates all the
+   * destinations in one call, which the models that only depend on the
+   * positions do in a single loop over a contiguous array.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param positions the positions of the destinations
+   * \param b the mobility models of the destinations
+   * \param n the number of destinations
+   * \param [out] rxPowerDbm the reception powers (in dBm), in the order of
+   *        the destinations
+   */
+  void CalcRxPowers (double txPowerDbm,
+                     Ptr<MobilityModel> a,
+                     const Vector *positions,
+                     const Ptr<MobilityModel> *b,
+                     uint32_t n,
+                     double *rxPowerDbm) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -134,6 +158,24 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const = 0;
 
+  /**
+   * Applies only the particular PropagationLossModel to several
+   * destinations.  The default implementation calls DoCalcRxPower for
+   * every destination.
+   *
+   * \param a the mobility model of the source
+   * \param positions the positions of the destinations
+   * \param b the mobility models of the destinations
+   * \param n the number of destinations
+   * \param [in,out] rxPowerDbm the transmission powers (in dBm), replaced
+   *        by the reception powers
+   */
+  virtual void DoCalcRxPowers (Ptr<MobilityModel> a,
+                               const Vector *positions,
+                               const Ptr<MobilityModel> *b,
+                               uint32_t n,
+                               double *rxPowerDbm) const;
+
   /**
    * Subclasses must implement this; those not using random variables
    * can return zero
@@ -321,6 +363,11 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowers (Ptr<MobilityModel> a,
+                               const Vector *positions,
+                               const Ptr<MobilityModel> *b,
+                               uint32_t n,
+                               double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   /**
@@ -441,6 +488,11 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowers (Ptr<MobilityModel> a,
+                               const Vector *positions,
+                               const Ptr<MobilityModel> *b,
+                               uint32_t n,
+                               double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   /**
@@ -529,6 +581,11 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowers (Ptr<MobilityModel> a,
+                               const Vector *positions,
+                               const Ptr<MobilityModel> *b,
+                               uint32_t n,
+                               double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   /**
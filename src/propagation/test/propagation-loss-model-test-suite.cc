@@ -22,8 +22,12 @@
 #include "ns3/config.h"
 #include "ns3/double.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/itu-r-1411-los-propagation-loss-model.h"
+#include "ns3/cached-propagation-loss-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/simulator.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -436,6 +440,184 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class BatchPropagationLossModelTestCase : public TestCase
+{
+public:
+  BatchPropagationLossModelTestCase ();
+  virtual ~BatchPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that CalcRxPowers gives the results of CalcRxPower.
+   * \param loss the loss model to check
+   * \param name the name of the loss model
+   */
+  void Check (Ptr<PropagationLossModel> loss, std::string name);
+
+  Ptr<MobilityModel> m_tx;                     //!< the transmitter
+  std::vector<Ptr<MobilityModel> > m_rx;       //!< the receivers
+};
+
+BatchPropagationLossModelTestCase::BatchPropagationLossModelTestCase ()
+  : TestCase ("Check the batch evaluation of the propagation loss models")
+{
+}
+
+BatchPropagationLossModelTestCase::~BatchPropagationLossModelTestCase ()
+{
+}
+
+void
+BatchPropagationLossModelTestCase::Check (Ptr<PropagationLossModel> loss, std::string name)
+{
+  std::vector<Vector> positions;
+  for (uint32_t i = 0; i < m_rx.size (); i++)
+    {
+      positions.push_back (m_rx[i]->GetPosition ());
+    }
+  std::vector<double> rxPowerDbm (m_rx.size ());
+  loss->CalcRxPowers (20, m_tx, &positions[0], &m_rx[0], m_rx.size (), &rxPowerDbm[0]);
+  for (uint32_t i = 0; i < m_rx.size (); i++)
+    {
+      // the batch computation must be exactly the same
+      NS_TEST_EXPECT_MSG_EQ (rxPowerDbm[i], loss->CalcRxPower (20, m_tx, m_rx[i]),
+                             name << ": got unexpected rcv power for receiver " << i);
+    }
+}
+
+void
+BatchPropagationLossModelTestCase::DoRun (void)
+{
+  m_tx = CreateObject<ConstantPositionMobilityModel> ();
+  m_tx->SetPosition (Vector (0, 0, 1.5));
+  // receivers from the same position to a few km, around the reference
+  // and crossover distances of the models
+  double distances[] = { 0, 0.5, 1, 2.5, 10, 40, 86.4, 100, 250, 1000, 5000 };
+  for (uint32_t i = 0; i < sizeof (distances) / sizeof (distances[0]); i++)
+    {
+      Ptr<MobilityModel> rx = CreateObject<ConstantPositionMobilityModel> ();
+      rx->SetPosition (Vector (distances[i] * 0.6, distances[i] * 0.8, 1.5 + i % 3));
+      m_rx.push_back (rx);
+    }
+
+  Check (CreateObject<FriisPropagationLossModel> (), "Friis");
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  friis->SetMinLoss (40);
+  Check (friis, "Friis with minimum loss");
+  Ptr<TwoRayGroundPropagationLossModel> twoRay = CreateObject<TwoRayGroundPropagationLossModel> ();
+  twoRay->SetMinDistance (1);
+  Check (twoRay, "TwoRayGround");
+  Check (CreateObject<LogDistancePropagationLossModel> (), "LogDistance");
+
+  // the receiver at the position of the transmitter is out of the ITU-R
+  // 1411 model
+  m_rx.erase (m_rx.begin ());
+  Check (CreateObject<ItuR1411LosPropagationLossModel> (), "ItuR1411Los");
+
+  // a model without batch implementation in a chain
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<MatrixPropagationLossModel> matrix = CreateObject<MatrixPropagationLossModel> ();
+  matrix->SetDefaultLoss (3);
+  matrix->SetLoss (m_tx, m_rx[4], 30, false);
+  logDistance->SetNext (matrix);
+  Check (logDistance, "LogDistance then Matrix");
+
+  m_tx = 0;
+  m_rx.clear ();
+  Simulator::Destroy ();
+}
+
+class CachedPropagationLossModelTestCase : public TestCase
+{
+public:
+  CachedPropagationLossModelTestCase ();
+  virtual ~CachedPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Compare the cached and the exact rx powers of the receivers.
+   * \param hits the expected number of gains reused so far
+   * \param misses the expected number of gains computed so far
+   */
+  void Check (uint64_t hits, uint64_t misses);
+
+  Ptr<CachedPropagationLossModel> m_cache;     //!< the cache
+  Ptr<PropagationLossModel> m_exact;           //!< the cached model
+  Ptr<MobilityModel> m_tx;                     //!< the transmitter
+  Ptr<MobilityModel> m_static;                 //!< a receiver that does not move
+  Ptr<ConstantVelocityMobilityModel> m_moving; //!< a receiver that moves
+};
+
+CachedPropagationLossModelTestCase::CachedPropagationLossModelTestCase ()
+  : TestCase ("Check the cache of propagation gains")
+{
+}
+
+CachedPropagationLossModelTestCase::~CachedPropagationLossModelTestCase ()
+{
+}
+
+void
+CachedPropagationLossModelTestCase::Check (uint64_t hits, uint64_t misses)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_cache->CalcRxPower (16, m_tx, m_static), m_exact->CalcRxPower (16, m_tx, m_static),
+                         "Wrong rx power for the static receiver at " << Simulator::Now ().GetSeconds () << " s");
+  NS_TEST_EXPECT_MSG_EQ (m_cache->CalcRxPower (16, m_moving, m_tx), m_exact->CalcRxPower (16, m_moving, m_tx),
+                         "Wrong rx power for the moving receiver at " << Simulator::Now ().GetSeconds () << " s");
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNHits (), hits, "Wrong number of hits at " << Simulator::Now ().GetSeconds () << " s");
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNMisses (), misses, "Wrong number of misses at " << Simulator::Now ().GetSeconds () << " s");
+}
+
+void
+CachedPropagationLossModelTestCase::DoRun (void)
+{
+  m_exact = CreateObject<LogDistancePropagationLossModel> ();
+  m_cache = CreateObject<CachedPropagationLossModel> ();
+  m_cache->SetModel (m_exact);
+  m_tx = CreateObject<ConstantPositionMobilityModel> ();
+  m_tx->SetPosition (Vector (0, 0, 0));
+  m_static = CreateObject<ConstantPositionMobilityModel> ();
+  m_static->SetPosition (Vector (100, 0, 0));
+  m_moving = CreateObject<ConstantVelocityMobilityModel> ();
+  m_moving->SetPosition (Vector (0, 200, 0));
+
+  // exact mode: the gain to the moving receiver is computed again once
+  // it moves, the other one is reused
+  Simulator::Schedule (Seconds (0), &CachedPropagationLossModelTestCase::Check, this, 0, 2);
+  Simulator::Schedule (Seconds (1), &CachedPropagationLossModelTestCase::Check, this, 2, 2);
+  Simulator::Schedule (Seconds (2), &ConstantVelocityMobilityModel::SetVelocity, m_moving, Vector (1, 0, 0));
+  Simulator::Schedule (Seconds (2), &CachedPropagationLossModelTestCase::Check, this, 4, 2);
+  Simulator::Schedule (Seconds (3), &CachedPropagationLossModelTestCase::Check, this, 5, 3);
+  // a static receiver moved by SetPosition
+  Simulator::Schedule (Seconds (4), &MobilityModel::SetPosition, m_static, Vector (50, 0, 0));
+  Simulator::Schedule (Seconds (4), &CachedPropagationLossModelTestCase::Check, this, 5, 5);
+  Simulator::Run ();
+
+  // with a tolerance, the gain is reused until the receiver moved by more
+  // than the tolerance since it was computed, 4 s ago at 2 m from here
+  m_cache->SetTolerance (2.5);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  double exact = m_exact->CalcRxPower (16, m_moving, m_tx);
+  NS_TEST_EXPECT_MSG_NE (m_cache->CalcRxPower (16, m_moving, m_tx), exact, "The gain was not reused");
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNHits (), 6, "The gain was not reused");
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  exact = m_exact->CalcRxPower (16, m_moving, m_tx);
+  NS_TEST_EXPECT_MSG_EQ (m_cache->CalcRxPower (16, m_moving, m_tx), exact, "The gain was reused beyond the tolerance");
+  NS_TEST_EXPECT_MSG_EQ (m_cache->GetNMisses (), 6, "The gain was reused beyond the tolerance");
+
+  m_cache->Dispose ();
+  m_cache = 0;
+  m_exact = 0;
+  m_tx = 0;
+  m_static = 0;
+  m_moving = 0;
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +632,8 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new BatchPropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new CachedPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
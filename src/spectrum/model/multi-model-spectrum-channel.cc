@@ -90,6 +90,8 @@ MultiModelSpectrumChannel::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_rxCandidates.clear ();
+  m_rxCandidateSet.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -134,6 +136,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
     }
 
   ++m_numDevices;
+  IndexRx (phy);
 
   RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.find (rxSpectrumModelUid);
 
@@ -235,6 +238,15 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  // the receivers are grouped by spectrum model, so the cutoff is applied
+  // by skipping the receivers out of range before any copy or computation
+  bool cutoff = GetRxCandidates (txMobility, m_rxCandidates);
+  m_rxCandidateSet.clear ();
+  for (std::vector<Ptr<SpectrumPhy> >::const_iterator it = m_rxCandidates.begin (); it != m_rxCandidates.end (); ++it)
+    {
+      m_rxCandidateSet.insert (PeekPointer (*it));
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -260,6 +272,23 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
         }
 
+      // the propagation gains are computed in one batch, for the receivers
+      // with a mobility model in the order of the loop below
+      m_rxMobility.clear ();
+      for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin ();
+           txMobility && rxPhyIterator != rxInfoIterator->second.m_rxPhys.end ();
+           ++rxPhyIterator)
+        {
+          Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+          if ((*rxPhyIterator) != txParams->txPhy && receiverMobility
+              && (!cutoff || m_rxCandidateSet.count (PeekPointer (*rxPhyIterator)) > 0))
+            {
+              m_rxMobility.push_back (receiverMobility);
+            }
+        }
+      const std::vector<double> &propagationGainsDb = CalcPropagationGains (txMobility, m_rxMobility);
+      uint32_t nextGain = 0;
+
       for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhys.end ();
            ++rxPhyIterator)
@@ -267,11 +296,14 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
                          "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
 
+          if (cutoff && m_rxCandidateSet.count (PeekPointer (*rxPhyIterator)) == 0)
+            {
+              continue;
+            }
+
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC ("copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+              Ptr<SpectrumSignalParameters> rxParams;
               Time delay = MicroSeconds (0);
 
               Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
@@ -280,12 +312,12 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                 {
                   double txAntennaGain = 0;
                   double rxAntennaGain = 0;
-                  double propagationGainDb = 0;
+                  double propagationGainDb = propagationGainsDb[nextGain++];
                   double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
+                  if (txParams->txAntenna != 0)
                     {
                       Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+                      txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
                       NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
                       pathLossDb -= txAntennaGain;
                     }
@@ -299,7 +331,6 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                     }
                   if (m_propagationLoss)
                     {
-                      propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
                       NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                       pathLossDb -= propagationGainDb;
                     }                    
@@ -313,6 +344,10 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                       // beyond range
                       continue;
                     }
+                  // the signal is copied only for the receivers in range
+                  NS_LOG_LOGIC ("copying signal parameters " << txParams);
+                  rxParams = txParams->Copy ();
+                  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
                   double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
                   *(rxParams->psd) *= pathGainLinear;              
 
@@ -326,6 +361,12 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                       delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
                     }
                 }
+              if (rxParams == 0)
+                {
+                  NS_LOG_LOGIC ("copying signal parameters " << txParams);
+                  rxParams = txParams->Copy ();
+                  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+                }
 
               Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
               if (netDev)
@@ -29,6 +29,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <map>
 #include <set>
+#include <unordered_set>
 
 namespace ns3 {
 
@@ -169,6 +170,22 @@ private:
    */
   std::size_t m_numDevices;
 
+  /**
+   * Receivers within MaxInterferenceDistance of the current transmitter.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_rxCandidates;
+
+  /**
+   * Mobility models of the receivers whose propagation gain is computed
+   * for the current transmission.
+   */
+  std::vector<Ptr<MobilityModel> > m_rxMobility;
+
+  /**
+   * The receivers of m_rxCandidates.
+   */
+  std::unordered_set<const SpectrumPhy *> m_rxCandidateSet;
+
 };
 
 
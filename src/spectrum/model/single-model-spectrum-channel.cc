@@ -54,6 +54,7 @@ SingleModelSpectrumChannel::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
   m_phyList.clear ();
+  m_rxCandidates.clear ();
   m_spectrumModel = 0;
   SpectrumChannel::DoDispose ();
 }
@@ -76,6 +77,7 @@ SingleModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  IndexRx (phy);
 }
 
 
@@ -105,9 +107,26 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
+  const PhyList &rxPhys = GetRxCandidates (senderMobility, m_rxCandidates) ? m_rxCandidates : m_phyList;
 
-  for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
-       rxPhyIterator != m_phyList.end ();
+  // the propagation gains are computed in one batch, for the receivers
+  // with a mobility model in the order of the loop below
+  m_rxMobility.clear ();
+  for (PhyList::const_iterator rxPhyIterator = rxPhys.begin ();
+       senderMobility && rxPhyIterator != rxPhys.end ();
+       ++rxPhyIterator)
+    {
+      Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+      if ((*rxPhyIterator) != txParams->txPhy && receiverMobility)
+        {
+          m_rxMobility.push_back (receiverMobility);
+        }
+    }
+  const std::vector<double> &propagationGainsDb = CalcPropagationGains (senderMobility, m_rxMobility);
+  uint32_t nextGain = 0;
+
+  for (PhyList::const_iterator rxPhyIterator = rxPhys.begin ();
+       rxPhyIterator != rxPhys.end ();
        ++rxPhyIterator)
     {
       if ((*rxPhyIterator) != txParams->txPhy)
@@ -115,19 +134,18 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           Time delay  = MicroSeconds (0);
 
           Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-          NS_LOG_LOGIC ("copying signal parameters " << txParams);
-          Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+          Ptr<SpectrumSignalParameters> rxParams;
 
           if (senderMobility && receiverMobility)
             {
               double txAntennaGain = 0;
               double rxAntennaGain = 0;
-              double propagationGainDb = 0;
+              double propagationGainDb = propagationGainsDb[nextGain++];
               double pathLossDb = 0;
-              if (rxParams->txAntenna != 0)
+              if (txParams->txAntenna != 0)
                 {
                   Angles txAngles (receiverMobility->GetPosition (), senderMobility->GetPosition ());
-                  txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+                  txAntennaGain = txParams->txAntenna->GetGainDb (txAngles);
                   NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
                   pathLossDb -= txAntennaGain;
                 }
@@ -141,7 +159,6 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                 }
               if (m_propagationLoss)
                 {
-                  propagationGainDb = m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
                   NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                   pathLossDb -= propagationGainDb;
                 }                    
@@ -155,6 +172,9 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   // beyond range
                   continue;
                 }
+              // the signal is copied only for the receivers in range
+              NS_LOG_LOGIC ("copying signal parameters " << txParams);
+              rxParams = txParams->Copy ();
               double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
               *(rxParams->psd) *= pathGainLinear;              
 
@@ -169,6 +189,11 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                 }
             }
 
+          if (rxParams == 0)
+            {
+              NS_LOG_LOGIC ("copying signal parameters " << txParams);
+              rxParams = txParams->Copy ();
+            }
 
           Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
           if (netDev)
@@ -77,6 +77,17 @@ private:
    */
   PhyList m_phyList;
 
+  /**
+   * Receivers within MaxInterferenceDistance of the current transmitter.
+   */
+  PhyList m_rxCandidates;
+
+  /**
+   * Mobility models of the receivers whose propagation gain is computed
+   * for the current transmission.
+   */
+  std::vector<Ptr<MobilityModel> > m_rxMobility;
+
   /**
    * SpectrumModel that this channel instance is supporting.
    */
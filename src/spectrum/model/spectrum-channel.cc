@@ -32,6 +32,7 @@ NS_LOG_COMPONENT_DEFINE ("SpectrumChannel");
 NS_OBJECT_ENSURE_REGISTERED (SpectrumChannel);
 
 SpectrumChannel::SpectrumChannel ()
+  : m_maxInterferenceDistance (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -47,6 +48,13 @@ SpectrumChannel::DoDispose ()
   m_propagationLoss = 0;
   m_propagationDelay = 0;
   m_spectrumPropagationLoss = 0;
+  if (m_spatialIndex)
+    {
+      m_spatialIndex->Dispose ();
+      m_spatialIndex = 0;
+    }
+  m_indexedRx.clear ();
+  m_indexedRxSet.clear ();
 }
 
 TypeId
@@ -70,6 +78,16 @@ SpectrumChannel::GetTypeId (void)
                    MakeDoubleAccessor (&SpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
 
+    .AddAttribute ("MaxInterferenceDistance",
+                   "The distance in meters beyond which transmissions are not "
+                   "passed to the receiving PHY. When set, the receivers are "
+                   "indexed by position and a transmission only evaluates the "
+                   "receivers around the transmitter, instead of all of them. "
+                   "The default value 0 disables the cutoff.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&SpectrumChannel::m_maxInterferenceDistance),
+                   MakeDoubleChecker<double> (0))
+
     .AddAttribute ("PropagationLossModel",
                    "A pointer to the propagation loss model attached to this channel.",
                    PointerValue (0),
@@ -149,5 +167,66 @@ SpectrumChannel::GetSpectrumPropagationLossModel (void)
   return m_spectrumPropagationLoss;
 }
 
+void
+SpectrumChannel::IndexRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  if (m_indexedRxSet.insert (PeekPointer (phy)).second)
+    {
+      m_indexedRx.push_back (phy);
+    }
+}
+
+bool
+SpectrumChannel::GetRxCandidates (Ptr<MobilityModel> txMobility, std::vector<Ptr<SpectrumPhy> > &rxPhys)
+{
+  NS_LOG_FUNCTION (this << txMobility);
+  rxPhys.clear ();
+  if (m_maxInterferenceDistance <= 0 || txMobility == 0)
+    {
+      return false;
+    }
+  if (m_spatialIndex == 0)
+    {
+      m_spatialIndex = CreateObject<SpatialIndex> ();
+      m_spatialIndex->SetCellSize (m_maxInterferenceDistance);
+    }
+  // the mobility of a receiver is usually set after it joined the
+  // channel, so the receivers are indexed on the first transmission
+  for (uint32_t id = m_spatialIndex->GetN (); id < m_indexedRx.size (); id++)
+    {
+      m_spatialIndex->Add (m_indexedRx[id]->GetMobility ());
+    }
+  m_spatialIndex->GetCandidates (txMobility->GetPosition (), m_maxInterferenceDistance, m_candidates);
+  for (std::vector<uint32_t>::const_iterator id = m_candidates.begin (); id != m_candidates.end (); id++)
+    {
+      Ptr<MobilityModel> rxMobility = m_indexedRx[*id]->GetMobility ();
+      if (rxMobility == 0 || txMobility->GetDistanceFrom (rxMobility) <= m_maxInterferenceDistance)
+        {
+          rxPhys.push_back (m_indexedRx[*id]);
+        }
+    }
+  return true;
+}
+
+const std::vector<double> &
+SpectrumChannel::CalcPropagationGains (Ptr<MobilityModel> txMobility,
+                                       const std::vector<Ptr<MobilityModel> > &rxMobility)
+{
+  uint32_t n = rxMobility.size ();
+  m_propagationGainsDb.assign (n, 0);
+  if (m_propagationLoss == 0 || n == 0)
+    {
+      return m_propagationGainsDb;
+    }
+  m_rxPositions.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_rxPositions[i] = rxMobility[i]->GetPosition ();
+    }
+  m_propagationLoss->CalcRxPowers (0, txMobility, &m_rxPositions[0], &rxMobility[0], n, &m_propagationGainsDb[0]);
+  return m_propagationGainsDb;
+}
+
 
 } // namespace
@@ -32,6 +32,9 @@
 #include <ns3/spectrum-phy.h>
 #include <ns3/traced-callback.h>
 #include <ns3/mobility-model.h>
+#include <ns3/spatial-index.h>
+#include <unordered_set>
+#include <vector>
 
 namespace ns3 {
 
@@ -154,6 +157,39 @@ public:
 
 protected:
 
+  /**
+   * Register a receiver with the spatial index used by the
+   * MaxInterferenceDistance cutoff.  Subclasses call it from AddRx; a
+   * receiver registered again is ignored.
+   *
+   * \param phy the receiver
+   */
+  void IndexRx (Ptr<SpectrumPhy> phy);
+
+  /**
+   * Find the receivers that may be within MaxInterferenceDistance of a
+   * transmitter.  The receivers without mobility model are always
+   * returned, and so is the transmitter if it is a receiver too.
+   *
+   * \param txMobility the mobility model of the transmitter
+   * \param [out] rxPhys the receivers, in the order they were registered
+   * \return false if the cutoff is disabled or the transmitter has no
+   *         mobility model, in which case every receiver must be evaluated
+   */
+  bool GetRxCandidates (Ptr<MobilityModel> txMobility, std::vector<Ptr<SpectrumPhy> > &rxPhys);
+
+  /**
+   * Compute with m_propagationLoss, in one batch, the propagation gain
+   * from a transmitter to several receivers.
+   *
+   * \param txMobility the mobility model of the transmitter
+   * \param rxMobility the mobility models of the receivers
+   * \return the gains in dB, in the order of rxMobility, 0 if there is
+   *         no propagation loss model; valid until the next call
+   */
+  const std::vector<double> & CalcPropagationGains (Ptr<MobilityModel> txMobility,
+                                                    const std::vector<Ptr<MobilityModel> > &rxMobility);
+
   /**
    * The `PathLoss` trace source. Exporting the pointers to the Tx and Rx
    * SpectrumPhy and a pathloss value, in dB.
@@ -194,6 +230,18 @@ protected:
    */
   Ptr<SpectrumPropagationLossModel> m_spectrumPropagationLoss;
 
+  /**
+   * Distance [m] beyond which receivers are not evaluated, 0 to disable.
+   */
+  double m_maxInterferenceDistance;
+
+private:
+  Ptr<SpatialIndex> m_spatialIndex;                 //!< the receivers by position
+  std::vector<Ptr<SpectrumPhy> > m_indexedRx;       //!< the receivers, by id in m_spatialIndex
+  std::unordered_set<const SpectrumPhy *> m_indexedRxSet; //!< the receivers of m_indexedRx
+  std::vector<uint32_t> m_candidates;               //!< scratch ids of GetRxCandidates
+  std::vector<Vector> m_rxPositions;                //!< scratch positions of CalcPropagationGains
+  std::vector<double> m_propagationGainsDb;         //!< result of CalcPropagationGains
 
 };
 
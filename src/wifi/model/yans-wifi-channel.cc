@@ -22,11 +22,13 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/mobility-model.h"
+#include "ns3/spatial-index.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "wifi-utils.h"
@@ -52,11 +54,28 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxInterferenceDistance",
+                   "The distance (m) beyond which the PHYs are not evaluated for reception "
+                   "nor interference. The PHYs are then indexed by position so that a "
+                   "transmission only visits the PHYs around the transmitter. "
+                   "0 disables the cutoff and every PHY is evaluated.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxInterferenceDistance),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("RxPowerFloor",
+                   "The received power (dBm, including the rx gain of the receiver) below "
+                   "which no reception event is scheduled. Signals that are too weak for the "
+                   "receiver are dropped anyway, this saves the copy of the packet and the event.",
+                   DoubleValue (-1.0e9),
+                   MakeDoubleAccessor (&YansWifiChannel::m_rxPowerFloorDbm),
+                   MakeDoubleChecker<double> ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxInterferenceDistance (0),
+    m_rxPowerFloorDbm (-1.0e9)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -87,42 +106,116 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  m_receivers.clear ();
+  if (m_maxInterferenceDistance <= 0)
     {
-      if (sender != (*i))
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (sender != (*i))
             {
-              continue;
+              AddReceiver (sender, *i);
             }
+        }
+      SendToReceivers (senderMobility, packet, txPowerDbm, duration);
+      return;
+    }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
-            {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
-            }
+  if (m_spatialIndex == 0)
+    {
+      m_spatialIndex = CreateObject<SpatialIndex> ();
+      m_spatialIndex->SetCellSize (m_maxInterferenceDistance);
+    }
+  // index the PHYs added since the last transmission, their mobility
+  // model is usually aggregated after they joined the channel
+  for (uint32_t id = m_spatialIndex->GetN (); id < m_phyList.size (); id++)
+    {
+      m_spatialIndex->Add (m_phyList[id]->GetMobility ());
+    }
+  // the candidates are sorted, so the receptions are scheduled in the
+  // order of m_phyList as without the cutoff
+  m_spatialIndex->GetCandidates (senderMobility->GetPosition (), m_maxInterferenceDistance, m_candidates);
+  for (std::vector<uint32_t>::const_iterator id = m_candidates.begin (); id != m_candidates.end (); id++)
+    {
+      Ptr<YansWifiPhy> receiver = m_phyList[*id];
+      if (sender == receiver)
+        {
+          continue;
+        }
+      Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+      if (receiverMobility != 0
+          && senderMobility->GetDistanceFrom (receiverMobility) > m_maxInterferenceDistance)
+        {
+          continue;
+        }
+      AddReceiver (sender, receiver);
+    }
+  SendToReceivers (senderMobility, packet, txPowerDbm, duration);
+}
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+void
+YansWifiChannel::AddReceiver (Ptr<YansWifiPhy> sender, Ptr<YansWifiPhy> receiver) const
+{
+  //For now don't account for inter channel interference nor channel bonding
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+  m_receivers.push_back (receiver);
+}
+
+void
+YansWifiChannel::SendToReceivers (Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet,
+                                  double txPowerDbm, Time duration) const
+{
+  uint32_t n = m_receivers.size ();
+  m_rxMobility.resize (n);
+  m_rxPositions.resize (n);
+  m_rxPowersDbm.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_rxMobility[i] = m_receivers[i]->GetMobility ()->GetObject<MobilityModel> ();
+      m_rxPositions[i] = m_rxMobility[i]->GetPosition ();
+    }
+  if (n > 0)
+    {
+      m_loss->CalcRxPowers (txPowerDbm, senderMobility, &m_rxPositions[0], &m_rxMobility[0], n, &m_rxPowersDbm[0]);
+    }
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<YansWifiPhy> receiver = m_receivers[i];
+      Ptr<MobilityModel> receiverMobility = m_rxMobility[i];
+      Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      double rxPowerDbm = m_rxPowersDbm[i];
+      NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                    "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+      if (rxPowerDbm + receiver->GetRxGain () < m_rxPowerFloorDbm)
+        {
+          NS_LOG_LOGIC ("Received signal below the floor: " << rxPowerDbm << " dBm");
+          continue;
         }
+      Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+      uint32_t dstNode;
+      if (dstNetDevice == 0)
+        {
+          dstNode = 0xffffffff;
+        }
+      else
+        {
+          dstNode = dstNetDevice->GetNode ()->GetId ();
+        }
+
+      Simulator::ScheduleWithContext (dstNode,
+                                      delay, &YansWifiChannel::Receive,
+                                      receiver, packet, rxPowerDbm, duration);
     }
+  // release the references until the next transmission
+  m_receivers.clear ();
+  m_rxMobility.clear ();
 }
 
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPowerDbm, Time duration)
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const Packet> packet, double rxPowerDbm, Time duration)
 {
   NS_LOG_FUNCTION (phy << packet << rxPowerDbm << duration.GetSeconds ());
   // Do no further processing if signal is too weak
@@ -132,7 +225,8 @@ YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPow
       NS_LOG_INFO ("Received signal too weak to process: " << rxPowerDbm << " dBm");
       return;
     }
-  phy->StartReceivePreamble (packet, DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
+  // the receivers share the packet sent until the PHY processes it
+  phy->StartReceivePreamble (packet->Copy (), DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
 }
 
 std::size_t
@@ -22,12 +22,16 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/vector.h"
+#include <vector>
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
+class SpatialIndex;
 class YansWifiPhy;
 class Packet;
 class Time;
@@ -40,6 +44,13 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * By default every transmission is evaluated for all the other PHYs of the
+ * channel.  When the MaxInterferenceDistance attribute is set, the PHYs are
+ * kept in a ns3::SpatialIndex and only those within that distance of the
+ * transmitter are evaluated; the RxPowerFloor attribute further drops the
+ * receivers whose received power is below the floor before a copy of the
+ * packet and a reception event are created for them.
  */
 class YansWifiChannel : public Channel
 {
@@ -107,18 +118,47 @@ private:
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
-   * bit of the packet has arrived.
+   * bit of the packet has arrived.  The packet is shared by all the
+   * receivers of the transmission, it is copied only for the receivers
+   * that hear it.
    *
    * \param receiver the device to which the packet is destined
    * \param packet the packet being sent
    * \param txPowerDbm the tx power associated to the packet being sent (dBm)
    * \param duration the transmission duration associated with the packet being sent
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet, double txPowerDbm, Time duration);
+  /**
+   * Add a PHY to the receivers of the current transmission, if it is
+   * tuned to the channel of the transmitter.
+   *
+   * \param sender the transmitting PHY
+   * \param receiver the receiving PHY
+   */
+  void AddReceiver (Ptr<YansWifiPhy> sender, Ptr<YansWifiPhy> receiver) const;
+  /**
+   * Evaluate the propagation to the receivers of the current transmission
+   * in one batch and schedule their receptions.
+   *
+   * \param senderMobility the mobility model of the transmitter
+   * \param packet the packet being sent
+   * \param txPowerDbm the tx power associated to the packet being sent (dBm)
+   * \param duration the transmission duration associated with the packet being sent
+   */
+  void SendToReceivers (Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet,
+                        double txPowerDbm, Time duration) const;
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxInterferenceDistance;    //!< Distance beyond which receivers are ignored (m), 0 to disable
+  double m_rxPowerFloorDbm;            //!< Received power below which receivers are ignored (dBm)
+  mutable Ptr<SpatialIndex> m_spatialIndex; //!< PHYs of m_phyList by position, created on the first Send
+  mutable std::vector<uint32_t> m_candidates; //!< PHYs possibly in range of the current transmission
+  mutable PhyList m_receivers;         //!< receivers of the current transmission
+  mutable std::vector<Ptr<MobilityModel> > m_rxMobility; //!< mobility models of m_receivers
+  mutable std::vector<Vector> m_rxPositions; //!< positions of m_receivers
+  mutable std::vector<double> m_rxPowersDbm; //!< reception powers of m_receivers
 };
 
 } //namespace ns3
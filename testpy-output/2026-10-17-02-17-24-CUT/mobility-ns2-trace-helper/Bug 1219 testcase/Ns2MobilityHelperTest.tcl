@@ -0,0 +1,4 @@
+$node_(0) set X_ 0.0
+$node_(0) set Y_ 0.0
+$ns_ at 1.0 "$node_(0) setdest 0  10       1"
+$ns_ at 6.0 "$node_(0) setdest 0  -10       1"
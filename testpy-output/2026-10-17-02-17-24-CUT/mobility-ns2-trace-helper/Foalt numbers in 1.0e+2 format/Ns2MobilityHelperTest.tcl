@@ -0,0 +1,6 @@
+$node_(0) set X_ 0.0
+$node_(0) set Y_ 0.0
+$ns_ at 1.0 "$node_(0) setdest 1.0e+2  0       1.0e+2"
+$ns_ at 2.0 "$node_(0) setdest 1.0e+2  1.0e+2  1.0e+2"
+$ns_ at 3.0 "$node_(0) setdest 0       1.0e+2  1.0e+2"
+$ns_ at 4.0 "$node_(0) setdest 0       0       1.0e+2"
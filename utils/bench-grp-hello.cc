@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program compares the channel load and the CPU cost of the grp
+// HELLO formats as the vehicle density grows.  Every vehicle of a cluster
+// hears all the others; during one HELLO interval (one simulated second
+// with the default HelloInterval) every vehicle builds and serializes its
+// beacon and every other vehicle deserializes it and checks whether the
+// link is symmetric, as grp::RoutingProtocol does.
+// Sample usage:  ./waf --run 'bench-grp-hello --densities=10,50,100,200,400'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/grp-header.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/// IPv4 and UDP headers of a beacon
+static const uint32_t IP_UDP_SIZE = 28;
+
+enum Format
+{
+  FULL,
+  BLOOM,
+  POSITION_ONLY,
+};
+
+static const char *
+FormatName (Format format)
+{
+  switch (format)
+    {
+    case FULL: return "Full";
+    case BLOOM: return "Bloom";
+    default: return "PositionOnly";
+    }
+}
+
+static Ipv4Address
+VehicleAddress (uint32_t i)
+{
+  return Ipv4Address ((10u << 24) | (1u << 16) | (i + 1));
+}
+
+/**
+ * Run the HELLO exchange of one interval in a cluster of vehicles.
+ *
+ * \param format the HELLO format
+ * \param n the number of vehicles
+ * \param [out] beaconSize the size of one beacon on top of UDP
+ * \param [out] falseSym the number of links wrongly found symmetric, out of n - 1
+ */
+static void
+RunInterval (Format format, uint32_t n, uint32_t &beaconSize, uint32_t &falseSym)
+{
+  falseSym = 0;
+  for (uint32_t s = 0; s < n; s++)
+    {
+      grp::MessageHeader msg;
+      msg.SetVTime (Seconds (3));
+      msg.SetOriginatorAddress (VehicleAddress (s));
+      msg.SetTimeToLive (1);
+      msg.SetHopCount (0);
+      msg.SetMessageSequenceNumber (1);
+      if (format != FULL)
+        {
+          msg.SetMessageType (grp::MessageHeader::COMPACT_HELLO_MESSAGE);
+        }
+      grp::MessageHeader::Hello &hello = msg.GetHello ();
+      hello.SetLocation (10.0 * s, 5.0);
+      hello.SetSpeedAndDirection (15, 0);
+      hello.SetTurn (0);
+      if (format == BLOOM)
+        {
+          hello.InitNeighborFilter (n - 2);
+        }
+      // the sender knows every other vehicle but the last one, so that
+      // one link of the cluster is asymmetric
+      for (uint32_t k = 0; k + 1 < n; k++)
+        {
+          if (k == s)
+            {
+              continue;
+            }
+          if (format == FULL)
+            {
+              hello.neighborInterfaceAddresses.push_back (VehicleAddress (k));
+            }
+          else if (format == BLOOM)
+            {
+              hello.AddNeighborToFilter (VehicleAddress (k));
+            }
+        }
+
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (msg);
+      grp::CtrPacketHeader ctr;
+      ctr.SetPacketLength (ctr.GetSerializedSize () + packet->GetSize ());
+      ctr.SetPacketSequenceNumber (1);
+      packet->AddHeader (ctr);
+      beaconSize = packet->GetSize ();
+
+      for (uint32_t r = 0; r < n; r++)
+        {
+          if (r == s)
+            {
+              continue;
+            }
+          Ptr<Packet> received = packet->Copy ();
+          grp::CtrPacketHeader rctr;
+          received->RemoveHeader (rctr);
+          grp::MessageHeader rmsg;
+          received->RemoveHeader (rmsg);
+          const grp::MessageHeader::Hello &rhello = rmsg.GetHello ();
+          Ipv4Address self = VehicleAddress (r);
+          bool sym = false;
+          if (rmsg.GetMessageType () == grp::MessageHeader::COMPACT_HELLO_MESSAGE)
+            {
+              sym = rhello.neighborFilter.empty () || rhello.IsInNeighborFilter (self);
+            }
+          for (std::vector<Ipv4Address>::const_iterator i = rhello.neighborInterfaceAddresses.begin ();
+               i != rhello.neighborInterfaceAddresses.end () && !sym; i++)
+            {
+              sym = (*i == self);
+            }
+          if (sym && r + 1 == n)
+            {
+              falseSym++;
+            }
+        }
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  std::string densities = "10,25,50,100,200,400";
+  uint32_t intervals = 5;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the channel load and CPU cost of the grp HELLO formats.");
+  cmd.AddValue ("densities", "comma separated numbers of vehicles in range of each other", densities);
+  cmd.AddValue ("intervals", "HELLO intervals simulated for every density", intervals);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (8) << "vehicles" << std::setw (14) << "format"
+            << std::setw (14) << "beacon(B)" << std::setw (16) << "load(kB/s)"
+            << std::setw (18) << "cpu(ms/sim-s)" << std::setw (14) << "falseSym(%)"
+            << std::endl;
+
+  std::istringstream iss (densities);
+  std::string token;
+  while (std::getline (iss, token, ','))
+    {
+      uint32_t n = std::stoul (token);
+      for (int f = FULL; f <= POSITION_ONLY; f++)
+        {
+          Format format = (Format)f;
+          uint32_t beaconSize = 0;
+          uint32_t falseSym = 0;
+          SystemWallClockMs time;
+          time.Start ();
+          for (uint32_t k = 0; k < intervals; k++)
+            {
+              RunInterval (format, n, beaconSize, falseSym);
+            }
+          double cpu = time.End () / (double)intervals;
+          // every vehicle sends one beacon per interval of one second
+          double load = n * (beaconSize + IP_UDP_SIZE) / 1000.0;
+          std::cout << std::setw (8) << n << std::setw (14) << FormatName (format)
+                    << std::setw (14) << beaconSize << std::setw (16) << load
+                    << std::setw (18) << cpu << std::setw (14) << 100.0 * falseSym / (n - 1)
+                    << std::endl;
+        }
+    }
+  return 0;
+}
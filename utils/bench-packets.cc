@@ -26,6 +26,7 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/slab-allocator.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -142,6 +143,84 @@ BenchHeader<N>::Deserialize (Buffer::Iterator start)
   return N;
 }
 
+/// BenchTrailer class used for benchmarking packet serialization/deserialization
+template <int N>
+class BenchTrailer : public Trailer
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+private:
+  /**
+   * Get type name function
+   * \returns the type name string
+   */
+  static std::string GetTypeName (void);
+};
+
+template <int N>
+std::string 
+BenchTrailer<N>::GetTypeName (void)
+{
+  std::ostringstream oss;
+  oss << "ns3::BenchTrailer<" << N << ">";
+  return oss.str ();
+}
+
+template <int N>
+TypeId 
+BenchTrailer<N>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (GetTypeName ().c_str ())
+    .SetParent<Trailer> ()
+    .SetGroupName ("Utils")
+    .HideFromDocumentation ()
+    .AddConstructor<BenchTrailer <N> > ()
+    ;
+  return tid;
+}
+template <int N>
+TypeId 
+BenchTrailer<N>::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+template <int N>
+void 
+BenchTrailer<N>::Print (std::ostream &os) const
+{
+  NS_ASSERT (false);
+}
+template <int N>
+uint32_t 
+BenchTrailer<N>::GetSerializedSize (void) const
+{
+  return N;
+}
+template <int N>
+void 
+BenchTrailer<N>::Serialize (Buffer::Iterator start) const
+{
+  start.Prev (N);
+  start.WriteU8 (N, N);
+}
+template <int N>
+uint32_t
+BenchTrailer<N>::Deserialize (Buffer::Iterator start)
+{
+  start.Prev (N);
+  return N;
+}
+
 /// BenchTag class used for benchmarking packet serialization/deserialization
 template <int N>
 class BenchTag : public Tag
@@ -328,6 +407,66 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchHeaders (uint32_t n)
+{
+  BenchHeader<14> ethernet;
+  BenchHeader<8> llc;
+  BenchHeader<20> ipv4;
+  BenchHeader<20> tcp;
+  BenchHeader<12> options;
+  BenchTag<16> tag1;
+  BenchTag<8> tag2;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // small packets going down and up a full stack, with a copy per hop
+      Ptr<Packet> p = Create<Packet> (100);
+      p->AddHeader (options);
+      p->AddHeader (tcp);
+      p->AddPacketTag (tag1);
+      p->AddHeader (ipv4);
+      p->AddHeader (llc);
+      p->AddByteTag (tag2);
+      p->AddHeader (ethernet);
+      Ptr<Packet> o = p->Copy ();
+      o->RemoveHeader (ethernet);
+      o->RemoveHeader (llc);
+      o->RemovePacketTag (tag1);
+      o->RemoveHeader (ipv4);
+      o->RemoveHeader (tcp);
+      o->RemoveHeader (options);
+    }
+}
+
+static void
+benchWifi (uint32_t n)
+{
+  BenchHeader<8> udp;
+  BenchHeader<20> ipv4;
+  BenchHeader<8> llc;
+  BenchHeader<26> mac;
+  BenchTrailer<4> fcs;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // a UDP datagram over wifi: the frame is copied to the receiver,
+      // which strips it back to the datagram
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (udp);
+      p->AddHeader (ipv4);
+      p->AddHeader (llc);
+      p->AddHeader (mac);
+      p->AddTrailer (fcs);
+      Ptr<Packet> o = p->Copy ();
+      o->RemoveTrailer (fcs);
+      o->RemoveHeader (mac);
+      o->RemoveHeader (llc);
+      o->RemoveHeader (ipv4);
+      o->RemoveHeader (udp);
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -362,12 +501,14 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool enableHeaderStack = false;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("enable-header-stack", "enable packet printing from a header stack only", enableHeaderStack);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -376,6 +517,14 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  if (enableHeaderStack)
+    {
+      Packet::EnableHeaderStack ();
+    }
+  if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -385,6 +534,11 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchHeaders, n, minIterations, "Many headers and tags on small packets");
+  runBench (&benchWifi, n, minIterations, "Wifi, IPv4 and UDP headers");
+
+  std::cout << std::endl << "Packet memory allocations:" << std::endl;
+  SlabAllocator::PrintStats (std::cout);
 
   return 0;
 }
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
 #include <string.h>
 
 #include "ns3/core-module.h"
@@ -51,6 +52,7 @@ public:
   Bench (const uint32_t population, const uint32_t total)
     : m_population (population),
       m_total (total),
+      m_cancel (0),
       m_count (0)
   {
   }
@@ -82,6 +84,15 @@ public:
     m_total = total;
   }
 
+  /**
+   * Set the number of events cancelled
+   * \param cancel the number of events cancelled
+   */
+  void SetCancel (const uint32_t cancel)
+  {
+    m_cancel = cancel;
+  }
+
   /// Run function
   void RunBench (void);
 private:
@@ -91,6 +102,7 @@ private:
   Ptr<RandomVariableStream> m_rand; ///< random variable
   uint32_t m_population; ///< population
   uint32_t m_total; ///< total
+  uint32_t m_cancel; ///< number of events cancelled
   uint32_t m_count; ///< count 
 };
 
@@ -98,7 +110,7 @@ void
 Bench::RunBench (void)
 {
   SystemWallClockMs time;
-  double init, simu;
+  double init, simu, cancel;
 
   DEB ("initializing");
   m_count = 0;
@@ -121,12 +133,36 @@ Bench::RunBench (void)
   simu /= 1000;
   DEB ("run took " << simu << "s");
 
+  // cancel some events of a new population, in the order they were
+  // scheduled, then drain the others: m_count is now past m_total
+  DEB ("cancelling");
+  std::vector<EventId> events;
+  events.reserve (m_population);
+  for (uint32_t i = 0; i < m_population; ++i)
+    {
+      Time at = NanoSeconds (m_rand->GetValue ());
+      events.push_back (Simulator::Schedule (at, &Bench::Cb, this));
+    }
+  uint32_t ncancel = std::min (m_cancel, m_population);
+  time.Start ();
+  for (uint32_t i = 0; i < ncancel; ++i)
+    {
+      Simulator::Remove (events[i]);
+    }
+  cancel = time.End ();
+  cancel /= 1000;
+  Simulator::Run ();
+  DEB ("cancelling took " << cancel << "s");
+
   LOG (std::setw (g_fwidth) << init <<
        std::setw (g_fwidth) << (m_population / init) <<
        std::setw (g_fwidth) << (init / m_population) <<
        std::setw (g_fwidth) << simu <<
        std::setw (g_fwidth) << (m_count / simu) <<
-       std::setw (g_fwidth) << (simu / m_count));
+       std::setw (g_fwidth) << (simu / m_count) <<
+       std::setw (g_fwidth) << cancel <<
+       std::setw (g_fwidth) << (ncancel / cancel) <<
+       std::setw (g_fwidth) << (cancel / ncancel));
 
 }
 
@@ -207,9 +243,12 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
+  uint32_t cancel =  10000;
   uint32_t runs  =       1;
   std::string filename = "";
 
@@ -221,14 +260,21 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "Each run measures the insertion of the initial population,\n"
+             "the simulation (remove next and insert), and the cancellation\n"
+             "of the first --cancel events of a new population.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "compare all the schedulers",    schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
+  cmd.AddValue ("cancel", "number of events cancelled (default 1E4)",   cancel);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
@@ -236,71 +282,108 @@ int main (int argc, char *argv[])
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)
+  std::vector<std::string> schedulers;
+  if (schedAll)
     {
-      factory.SetTypeId ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
     }
-  if (schedHeap)
+  else if (schedCal)
     {
-      factory.SetTypeId ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
     }
-  if (schedList)
+  else if (schedHeap)
     {
-      factory.SetTypeId ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+    }
+  else if (schedList)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+    }
+  else if (schedLadder)
+    {
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else
+    {
+      schedulers.push_back ("ns3::MapScheduler");
     }
-  Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
+  LOGME ("cancelled events: " << cancel);
   LOGME ("runs: " << runs);
 
   Bench *bench = new Bench (pop, total);
   bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetCancel (cancel);
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::size_t s = 0; s < schedulers.size (); s++)
     {
-      std::cout << std::setw (g_fwidth) << i;
-
+      ObjectFactory factory (schedulers[s]);
+      Simulator::SetScheduler (factory);
+
+      LOG ("");
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+
+      // table header
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:" <<
+           std::left << std::setw (3 * g_fwidth) << "Cancellation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
       bench->RunBench ();
-    }
 
-  LOG ("");
-  Simulator::Destroy ();
+      bench->SetPopulation (pop);
+      bench->SetTotal (total);
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+
+          bench->RunBench ();
+        }
+
+      LOG ("");
+      EventImpl::PoolStats stats = EventImpl::GetPoolStats ();
+      LOGME ("event allocations: " << stats.allocations <<
+             ", from free lists: " << stats.reuses <<
+             ", too large for the pool: " << stats.large);
+      LOGME ("event pool chunks: " << stats.chunks <<
+             " (" << stats.chunkBytes << " bytes)");
+      Simulator::Destroy ();
+    }
   delete bench;
   return 0;
 }
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+"""
+Run a parameter sweep of the scratch/MyVanet scenario.
+
+Every point of the parameter grid is simulated --runs times, each
+replication in its own process with its own RngRun, and up to --jobs
+processes run at the same time.  The parameters are passed on the
+command line of MyVanet, which sets the grp::RoutingProtocol attributes,
+so the replications do not share any configuration file.  Each process
+writes its trace and its result line to private files under the work
+directory; the results are then merged into one table with the mean and
+the confidence interval of the delivery ratio and of the delay.
+
+Example:
+
+    ./waf build
+    ./utils/vanet-sweep.py --vnum 100 200 --range 250 500 --runs 10
+
+Run it from the top of the tree, as the scenario files are looked up
+under TestScenaries/.
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import itertools
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+## The scenario parameters swept, in the order of the result table.
+PARAMETERS = ["vnum", "range", "seghop", "CarryTimeThreshold", "DistanceRange"]
+
+## Two-sided 95% quantiles of the Student t distribution, by degree of freedom.
+T_95 = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+
+
+def read_waf_config():
+    """! Find the build directory and the library path of the last waf configure.
+    @return the build directory and the list of library directories
+    """
+    for name in (".lock-waf_" + sys.platform + "_build", ".lock-waf_linux2_build"):
+        if os.path.exists(name):
+            break
+    else:
+        sys.exit("The .lock-waf ... file was not found, run this script from the top of a configured tree.")
+    out_dir = None
+    for line in open(name):
+        if line.startswith("out_dir ="):
+            out_dir = eval(line.split("=", 1)[1].strip())
+    module_path = []
+    for line in open(os.path.join(out_dir, "c4che", "_cache.py")):
+        if line.startswith("NS3_MODULE_PATH ="):
+            module_path = eval(line.split("=", 1)[1].strip())
+    return out_dir, module_path
+
+
+def confidence_interval(values):
+    """! Mean and half width of the 95% confidence interval.
+    @param values the samples, the NaN are ignored
+    @return (mean, half width, number of samples)
+    """
+    values = [v for v in values if not math.isnan(v)]
+    n = len(values)
+    if n == 0:
+        return float("nan"), float("nan"), 0
+    mean = sum(values) / n
+    if n == 1:
+        return mean, float("nan"), 1
+    variance = sum((v - mean) ** 2 for v in values) / (n - 1)
+    t = T_95[n - 2] if n - 1 <= len(T_95) else 1.960
+    return mean, t * math.sqrt(variance / n), n
+
+
+def run_replication(program, env, workdir, point, run):
+    """! Run one replication of a grid point.
+    @return (point, run, delivery ratio, delay in ms), or None if the run failed
+    """
+    tag = "-".join(str(v) for v in point) + "-run%d" % run
+    output = os.path.join(workdir, tag + ".csv")
+    argv = [program, "--RngRun=%d" % run,
+            "--output=" + output,
+            "--traceFile=" + os.path.join(workdir, tag + ".tr"),
+            "--anim=false"]
+    argv += ["--%s=%s" % (name, value) for name, value in zip(PARAMETERS, point)]
+    with open(os.path.join(workdir, tag + ".log"), "w") as log:
+        status = subprocess.call(argv, env=env, stdout=log, stderr=subprocess.STDOUT)
+    if status != 0 or not os.path.exists(output):
+        print("%s failed with status %d, see %s.log" % (tag, status, os.path.join(workdir, tag)),
+              file=sys.stderr)
+        return None
+    with open(output) as f:
+        fields = f.read().strip().splitlines()[-1].split(",")
+    return point, run, float(fields[-2]), float(fields[-1])
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Run independent replications of scratch/MyVanet "
+                                     "over a parameter grid and merge the results.")
+    parser.add_argument("--vnum", nargs="+", default=["100"], help="numbers of vehicles")
+    parser.add_argument("--range", nargs="+", default=["250"], help="transmission ranges (m)")
+    parser.add_argument("--seghop", nargs="+", default=["2"], help="segment hops")
+    parser.add_argument("--CarryTimeThreshold", nargs="+", default=["20"], help="carry time thresholds (s)")
+    parser.add_argument("--DistanceRange", nargs="+", default=["2000"], help="source to sink distances (m)")
+    parser.add_argument("--runs", type=int, default=10, help="replications of every grid point")
+    parser.add_argument("--first-run", type=int, default=1, help="RngRun of the first replication")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="simultaneous simulations")
+    parser.add_argument("--program", default=None, help="simulation program, scratch/MyVanet by default")
+    parser.add_argument("--output", default="scratch/sweep.csv", help="merged result table")
+    parser.add_argument("--workdir", default=None,
+                        help="keep the per-run traces and logs in this directory")
+    args = parser.parse_args(argv)
+
+    out_dir, module_path = read_waf_config()
+    program = args.program or os.path.join(out_dir, "scratch", "MyVanet")
+    env = dict(os.environ)
+    env["LD_LIBRARY_PATH"] = ":".join([env.get("LD_LIBRARY_PATH", "")] + module_path)
+
+    workdir = args.workdir or tempfile.mkdtemp(prefix="vanet-sweep-")
+    os.makedirs(workdir, exist_ok=True)
+
+    grid = list(itertools.product(*[getattr(args, name) for name in PARAMETERS]))
+    runs = range(args.first_run, args.first_run + args.runs)
+    print("%d grid points, %d replications each, %d jobs" % (len(grid), args.runs, args.jobs))
+
+    results = []
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = [pool.submit(run_replication, program, env, workdir, point, run)
+                   for point in grid for run in runs]
+        for done, future in enumerate(concurrent.futures.as_completed(futures), 1):
+            result = future.result()
+            if result is not None:
+                results.append(result)
+            print("\r%d/%d replications done" % (done, len(futures)), end="", flush=True)
+    print()
+
+    with open(args.output + ".runs", "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(PARAMETERS + ["RngRun", "pdr", "delay_ms"])
+        for point, run, pdr, delay in sorted(results, key=lambda r: (grid.index(r[0]), r[1])):
+            writer.writerow(list(point) + [run, pdr, delay])
+
+    with open(args.output, "w", newline="") as f:
+        writer = csv.writer(f)
+        header = PARAMETERS + ["runs", "pdr", "pdr_ci95", "delay_ms", "delay_ci95"]
+        writer.writerow(header)
+        print(" ".join(header))
+        for point in grid:
+            mine = [r for r in results if r[0] == point]
+            pdr, pdr_ci, n = confidence_interval([r[2] for r in mine])
+            delay, delay_ci, _ = confidence_interval([r[3] for r in mine])
+            row = list(point) + [n, "%.4f" % pdr, "%.4f" % pdr_ci, "%.2f" % delay, "%.2f" % delay_ci]
+            writer.writerow(row)
+            print(" ".join(str(v) for v in row))
+
+    if args.workdir is None:
+        shutil.rmtree(workdir)
+    return 0 if len(results) == len(grid) * args.runs else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))